@@ -4,13 +4,46 @@
 #include <cstring>
 #include <mutex>
 #include <fstream>
-#include <unordered_map>
-#include <list>
 #include <ctime>
-
+#include <new>
+#include <type_traits>
+#include <optional>
+#include <utility>
+#include <vector>
+#include <chrono>
+#include <cstdint>
+#include <algorithm>
+#include <thread>
+#include <atomic>
+#include <cerrno>
+#include <unistd.h>
+#include <sys/wait.h>
+#include "node_arena.h"
+#include "level_generator.h"
+#include "skiplist_stats.h"
+#include "skiplist_iterator.h"
+#include "write_batch.h"
+#include "snapshot_format.h"
+#include "write_ahead_log.h"
+#include "expiry_clock.h"
+#include "expiry_wheel.h"
+#include "memory_usage.h"
+#include "string_key.h"
+#include "tinylfu_cache.h"
+#include "clock_cache.h"
+
+#ifndef STORE_FILE
 #define STORE_FILE "store/dumpFile"
+#endif
+#define SCAN_CHUNK_SIZE 1024 // scan 每次持锁访问的节点数
+#define EXPIRY_REBUILD_MIN (1 << 16) // 过期索引中失效记录超过这个数且多于元素数时重建
+#ifndef SKIPLIST_NO_PREFETCH
+#define SKIPLIST_PREFETCH(p) __builtin_prefetch(p) // 查找时预取下一步要访问的节点，定义 SKIPLIST_NO_PREFETCH 关闭
+#else
+#define SKIPLIST_PREFETCH(p) ((void)0)
+#endif
+#define ACTIVE_EXPIRE_BATCH 128 // 主动过期每次持锁处理的到期键数
 
-std::mutex mtx; // 用于临界区的互斥锁
 std::string delimiter = ":"; // 用于解析键值对的分隔符
 
 // 节点类模板，包含键值对和指向下一级节点的指针
@@ -19,256 +52,524 @@ class Node {
 
 public:
 
-    Node() {}
+    Node() : lru_segment(0), lru_flags(0), lru_prev(nullptr), lru_next(nullptr) {}
 
     // 构造函数，初始化键值对和节点层数，以及过期时间
-    Node(K k, V v, int level, time_t expire_time = 0);
+    Node(K k, V v, int level, int64_t expire_time = 0);
 
-    ~Node();
+    const K& get_key() const; // 返回引用，查找时逐跳比较不复制键
 
-    K get_key() const;
+    const V& get_value() const;
 
-    V get_value() const;
+    size_t memory_bytes() const; // 节点和指针塔，加上键和值在堆上的部分（见 memory_usage.h）
 
-    time_t get_expire_time() const; // 获取过期时间
+    int64_t get_expire_time() const; // 获取过期时间
 
     void set_value(V);
 
-    void set_expire_time(time_t); // 设置过期时间
-
-    Node<K, V> **forward; // 指向下一级节点的指针数组
+    void set_expire_time(int64_t); // 设置过期时间
 
     int node_level; // 节点所在的层级
+    unsigned char lru_segment; // 节点在缓存策略中所在的段（TinyLFUCache 使用，见 tinylfu_cache.h）
+    std::atomic<unsigned char> lru_flags; // 缓存标志位，命中时并发置位（ClockCache 使用，见 clock_cache.h）
+
+    Node<K, V>* lru_prev; // LRU缓存链表中的前一个（更近使用的）节点，节点不在缓存中时为 nullptr
+    Node<K, V>* lru_next; // LRU缓存链表中的后一个节点，节点不在缓存中时为 nullptr
 
 private:
     K key;
     V value;
-    time_t expire_time; // 过期时间戳
+    int64_t expire_time; // 过期时间，Unix 毫秒（见 expiry_clock.h），0 表示永不过期
+
+public:
+    // 指向下一级节点的指针数组，必须是最后一个成员：节点分配时按 level + 1 个指针预留空间，
+    // 指针塔与节点位于同一块内存，不再单独分配
+    Node<K, V>* forward[1];
 };
 
 // Node类的构造函数实现
 template<typename K, typename V>
-Node<K, V>::Node(const K k, const V v, int level, time_t expire_time) {
+Node<K, V>::Node(const K k, const V v, int level, int64_t expire_time) {
     this->key = k;
     this->value = v;
     this->node_level = level;
     this->expire_time = expire_time;
-
-    // 创建指向下一级节点的指针数组
-    this->forward = new Node<K, V>*[level + 1];
+    this->lru_prev = nullptr;
+    this->lru_next = nullptr;
+    this->lru_segment = 0;
+    this->lru_flags.store(0, std::memory_order_relaxed);
 
     // 初始化指针数组为空（NULL）
     memset(this->forward, 0, sizeof(Node<K, V>*) * (level + 1));
 }
 
-// Node类的析构函数，实现对指针数组的释放
 template<typename K, typename V>
-Node<K, V>::~Node() {
-    delete[] forward;
-}
-
-template<typename K, typename V>
-K Node<K, V>::get_key() const {
+const K& Node<K, V>::get_key() const {
     return key;
 }
 
 template<typename K, typename V>
-V Node<K, V>::get_value() const {
+const V& Node<K, V>::get_value() const {
     return value;
 }
 
 template<typename K, typename V>
-time_t Node<K, V>::get_expire_time() const {
+int64_t Node<K, V>::get_expire_time() const {
     return expire_time;
 }
 
+template<typename K, typename V>
+size_t Node<K, V>::memory_bytes() const {
+    return sizeof(Node<K, V>) + sizeof(Node<K, V>*) * node_level + heap_bytes(key) + heap_bytes(value);
+}
+
 template<typename K, typename V>
 void Node<K, V>::set_value(V value) {
     this->value = value;
 }
 
 template<typename K, typename V>
-void Node<K, V>::set_expire_time(time_t expire_time) {
+void Node<K, V>::set_expire_time(int64_t expire_time) {
     this->expire_time = expire_time;
 }
 
-// LRU缓存类模板，使用哈希表和双向链表实现
+// LRU缓存类模板：侵入式双向链表，前后指针就在跳表节点里（Node::lru_prev/lru_next），
+// 缓存只记录已有节点的使用顺序，不复制键和值，也不额外分配内存，缓存中的值不会与跳表不一致。
+// 超出容量时把最久未使用的节点移出链表（降级，节点仍留在跳表中）；节点从跳表删除前必须先 remove。
+// 不加锁，由跳表持锁调用
 template<typename K, typename V>
 class LRUCache {
 public:
-    LRUCache(size_t capacity); // 构造函数，初始化缓存容量
+    static const bool concurrent = false; // get 会移动链表，只能在跳表的写锁下调用
 
-    ~LRUCache();
+    LRUCache(CacheCapacity capacity); // 构造函数，容量按节点数或字节数计（见 memory_usage.h）
 
-    bool get(const K& key, V& value); // 获取键对应的值
+    bool get(Node<K, V>* node); // 节点在缓存中时移到链表头部并返回 true（命中）
 
-    void put(const K& key, const V& value, time_t expire_time = 0); // 插入键值对并设置过期时间
+    void put(Node<K, V>* node); // 把节点加入或移到链表头部，放不下时从链表尾部开始淘汰；比整个容量还大的节点不放入
 
-    void remove(const K& key); // 移除指定键的元素
+    void remove(Node<K, V>* node, bool expired = false); // 把节点移出缓存，expired 表示节点因过期被删除
 
-    void evict_expired_items(); // 清理过期的元素
+    bool cached(const Node<K, V>* node) const { return node->lru_next != nullptr; } // 节点是否在缓存中
+    size_t size() const { return count; } // 缓存中的节点数
+    size_t used() const { return charged; } // 已用的容量，单位与容量相同
+    size_t overhead_bytes() const { return sizeof(*this); } // 缓存自身占用的内存
+    size_t eviction_count() const { return evictions; } // 因容量不足被淘汰的次数
+    size_t expired_count() const { return expired; } // 在缓存中时因过期被删除的次数
 
 private:
+    void link_front(Node<K, V>* node); // 插入到链表头部
+    void unlink(Node<K, V>* node); // 从链表中摘除
+    size_t charge(const Node<K, V>* node) const { return in_bytes ? node->memory_bytes() : 1; } // 节点占用的容量
+
     size_t capacity; // 缓存容量
-    std::list<std::pair<K, Node<K, V>*>> item_list; // 双向链表用于记录访问顺序
-    std::unordered_map<K, typename std::list<std::pair<K, Node<K, V>*>>::iterator> item_map; // 哈希表用于快速查找
+    bool in_bytes; // 容量是否按字节计
+    size_t count; // 缓存中的节点数
+    size_t charged; // 缓存中节点占用的容量之和
+    size_t evictions; // 容量淘汰计数
+    size_t expired; // 过期清理计数
+    Node<K, V> head; // 哨兵，head.lru_next 为最近使用的节点，head.lru_prev 为最久未使用的节点
 };
 
 template<typename K, typename V>
-LRUCache<K, V>::LRUCache(size_t capacity) : capacity(capacity) {}
+LRUCache<K, V>::LRUCache(CacheCapacity capacity)
+    : capacity(capacity.amount), in_bytes(capacity.in_bytes), count(0), charged(0), evictions(0), expired(0) {
+    head.lru_prev = &head;
+    head.lru_next = &head;
+}
 
 template<typename K, typename V>
-LRUCache<K, V>::~LRUCache() {
-    // 析构函数，清理缓存中的节点
-    for (auto& item : item_list) {
-        delete item.second;
-    }
+void LRUCache<K, V>::link_front(Node<K, V>* node) {
+    node->lru_prev = &head;
+    node->lru_next = head.lru_next;
+    head.lru_next->lru_prev = node;
+    head.lru_next = node;
+    count++;
+    charged += charge(node);
 }
 
-// 获取键对应的值，并将该键移动到链表头部（表示最近使用）
 template<typename K, typename V>
-bool LRUCache<K, V>::get(const K& key, V& value) {
-    auto it = item_map.find(key);
-    if (it == item_map.end()) {
-        return false; // 未找到该键
-    }
-
-    Node<K, V>* node = it->second->second;
-    time_t now = time(nullptr);
-
-    // 检查过期时间
-    if (node->get_expire_time() != 0 && node->get_expire_time() <= now) {
-        // 过期则删除缓存中的数据
-        item_list.erase(it->second);
-        delete node;
-        item_map.erase(it);
-        return false; // 返回未找到
-    }
-
-    value = node->get_value();
-    item_list.splice(item_list.begin(), item_list, it->second); // 将节点移动到链表头部
-    return true;
+void LRUCache<K, V>::unlink(Node<K, V>* node) {
+    node->lru_prev->lru_next = node->lru_next;
+    node->lru_next->lru_prev = node->lru_prev;
+    node->lru_prev = nullptr;
+    node->lru_next = nullptr;
+    count--;
+    charged -= charge(node);
 }
 
-// 插入键值对到缓存，如果缓存已满则移除最久未使用的节点
+// 节点在缓存中时将其移动到链表头部（表示最近使用）
 template<typename K, typename V>
-void LRUCache<K, V>::put(const K& key, const V& value, time_t expire_time) {
-    auto it = item_map.find(key);
-    if (it != item_map.end()) {
-        // 如果键已存在，更新值和过期时间，并将节点移动到链表头部
-        item_list.splice(item_list.begin(), item_list, it->second);
-        it->second->second->set_value(value);
-        it->second->second->set_expire_time(expire_time);
-    } else {
-        // 如果缓存已满，移除链表尾部（最久未使用）的节点
-        if (item_list.size() >= capacity) {
-            auto last = item_list.end();
-            last--;
-            item_map.erase(last->first);
-            delete last->second;
-            item_list.pop_back();
-        }
-        // 插入新节点到链表头部
-        Node<K, V>* node = new Node<K, V>(key, value, 0, expire_time);
-        item_list.push_front(std::make_pair(key, node));
-        item_map[key] = item_list.begin();
+bool LRUCache<K, V>::get(Node<K, V>* node) {
+    if (node->lru_next == nullptr) {
+        return false; // 不在缓存中
     }
+    unlink(node);
+    link_front(node);
+    return true;
 }
 
-// 移除指定键的节点
+// 把节点放到链表头部，放不下时依次把最久未使用的节点移出缓存
 template<typename K, typename V>
-void LRUCache<K, V>::remove(const K& key) {
-    auto it = item_map.find(key);
-    if (it != item_map.end()) {
-        item_list.erase(it->second); // 从链表中移除节点
-        delete it->second->second; // 删除节点
-        item_map.erase(it); // 从哈希表中移除键
+void LRUCache<K, V>::put(Node<K, V>* node) {
+    if (node->lru_next != nullptr) {
+        unlink(node);
+        link_front(node);
+        return;
+    }
+    size_t size = charge(node);
+    if (size > capacity) {
+        return;
+    }
+    while (charged + size > capacity) {
+        unlink(head.lru_prev);
+        evictions++;
     }
+    link_front(node);
 }
 
-// 清理已过期的键值对
+// 把节点移出缓存，不在缓存中时什么都不做
 template<typename K, typename V>
-void LRUCache<K, V>::evict_expired_items() {
-    time_t now = time(nullptr);
-    for (auto it = item_list.begin(); it != item_list.end();) {
-        if (it->second->get_expire_time() != 0 && it->second->get_expire_time() <= now) { // 检查是否过期
-            auto erase_it = it++;
-            item_map.erase(erase_it->first);
-            delete erase_it->second;
-            item_list.erase(erase_it);
-        } else {
-            ++it;
-        }
+void LRUCache<K, V>::remove(Node<K, V>* node, bool expired) {
+    if (node->lru_next == nullptr) {
+        return;
+    }
+    unlink(node);
+    if (expired) {
+        this->expired++;
     }
 }
 
-// 跳表类模板
-template<typename K, typename V>
+template<typename K, typename V, typename Hash>
+class ShardedSkipList; // 分片前端，需要访问各分片的头节点和锁
+
+// 跳表类模板，Cache 为缓存策略：LRUCache（默认）、TinyLFUCache（抗扫描，见 tinylfu_cache.h）
+// 或 ClockCache（命中不需要写锁，见 clock_cache.h）
+template<typename K, typename V, template<typename, typename> class Cache = LRUCache>
 class SkipList {
+    template<typename, typename, typename> friend class ShardedSkipList;
+    friend class SkipListIterator<SkipList<K, V, Cache>, K, V>;
 
 public:
-    SkipList(int, size_t lru_capacity); // 构造函数，初始化最大层数和LRU缓存容量
+    typedef SkipListIterator<SkipList<K, V, Cache>, K, V> Iterator; // 有序迭代器，见 skiplist_iterator.h
+
+    SkipList(int, CacheCapacity lru_capacity); // 构造函数，初始化最大层数和缓存容量（节点数，或 CacheCapacity::bytes 字节数）
 
     ~SkipList();
 
-    int insert_element(K, V, time_t expire_time = 0); // 插入元素
+    int insert_element(K, V, int64_t expire_time = 0); // 插入元素，expire_time 为 Unix 毫秒，0 表示永不过期
 
     void delete_element(K); // 删除元素
 
     bool search_element(K); // 查找元素
 
+    // 直接返回值的查找接口，不打印、不更新LRU缓存，只加共享锁，多个线程可以同时读；已过期的键视为不存在，遇到时顺便从跳表中删除
+    std::optional<V> get(const K&); // 返回值的拷贝，找不到时为空
+    bool get(const K&, V&); // 把值写入出参
+    template<typename Visitor>
+    bool get_with(const K&, Visitor); // 持锁期间对存储的值调用 visitor(const V&)，不拷贝
+    bool contains(const K&); // 判断键是否存在
+    std::optional<std::pair<V, int64_t>> get_with_ttl(const K&); // 同时返回值和过期时间
+    bool get_with_ttl(const K&, V&, int64_t&); // 把值和过期时间写入出参
+
+    // 批量接口：键先排好序，整批只加一次锁，每个键从上一个键留下的前驱处继续查找（finger search）
+    std::vector<std::optional<V>> multi_get(const std::vector<K>&); // 结果与传入的键一一对应，已过期的键为空
+    size_t write(const WriteBatch<K, V>&); // 原子地应用整批插入/覆盖和删除，见 write_batch.h；返回删掉的未过期键数
+
+    // 从按键有序的输入一次性构建：比现有最大键还大的键直接接在各层最后一个节点之后，不查找、不逐条打印，
+    // 也不放入LRU缓存。塔高默认按位置确定（1 + 位置末尾0的个数，得到完全平衡的跳表），random_levels 为 true 时随机。
+    // 乱序的键退回普通的查找插入，已存在的键保持不变（与 insert_element 一致）。
+    // next(K&, V&, int64_t& expire_time) 填入下一条数据，输入结束时返回 false；返回新增的键数
+    template<typename Source>
+    size_t bulk_load(Source next, bool random_levels = false);
+    size_t bulk_load(const std::vector<std::pair<K, V>>&, bool random_levels = false); // 不带过期时间的有序键值对
+
+    // 有序遍历，已过期的键会被跳过；迭代器分批拷贝数据，遍历期间其他线程可以继续写入
+    Iterator new_iterator(); // 未定位的迭代器，需先调用 seek 系列方法
+    Iterator lower_bound(const K&); // 定位到第一个 >= key 的元素
+    Iterator upper_bound(const K&); // 定位到第一个 > key 的元素
+    // 按键升序访问 [begin, end) 内的元素，最多 limit 个（0 表示不限），返回访问的个数；
+    // callback(const K&, const V&) 在持锁期间执行，每访问 SCAN_CHUNK_SIZE 个节点释放一次锁，callback 内不能再调用本跳表
+    template<typename Callback>
+    size_t scan(const K& begin, const K& end, size_t limit, Callback callback);
+
     void display_list(); // 显示跳表内容
 
     void dump_file(); // 保存跳表数据到文件
 
     void load_file(); // 从文件加载跳表数据
 
-    void evict_expired_items(); // 清理过期元素
+    // 清理过期元素：推进过期索引（见 expiry_wheel.h），把到期的节点从跳表和LRU缓存中删除，
+    // 只访问到期的键，不扫描整个跳表或缓存
+    void evict_expired_items();
+    // 主动过期：与 evict_expired_items 相同，但每处理 ACTIVE_EXPIRE_BATCH 个到期键放一次锁，
+    // 用时达到 budget_us 微秒就停止，剩下的留给下一次调用；返回删除的节点数。应由调用方周期性执行
+    size_t active_expire_cycle(long budget_us);
 
     int size(); // 获取跳表大小
 
+    // 不阻塞读写的保存：只在轮换日志和 fork 时持锁，子进程按写时复制得到的内存写快照后退出。
+    // 上一次后台保存还没结束或 fork 失败时返回 false；dump_file 会先等正在进行的后台保存结束
+    bool background_save();
+    bool saving() const { return _saving; } // 后台保存是否正在进行
+
+    // 预写日志，见 write_ahead_log.h。先把 path 中已有的记录重放到当前内容上，所以恢复流程是 load_file() 之后 open_wal()；
+    // 此后每次生效的 insert_element、delete_element 和 write() 都写日志，记录写出（WAL_SYNC_ALWAYS 时还要刷盘）后才返回，
+    // 并发的写线程合并成一次 write/fsync。dump_file 成功后清空日志。bulk_load 不写日志，导入后应 dump_file。
+    // 日志无法读取或打开时打印原因并返回 false
+    bool open_wal(const std::string& path = WAL_FILE, WalSyncPolicy policy = WAL_SYNC_INTERVAL, int interval_ms = 1000);
+    WriteAheadLog& wal() { return _wal; }
+
+    SkipListStats stats(); // 统计快照：各操作延迟直方图、锁等待/持有时间、层级分布、LRU命中与淘汰
+    // 内存占用：节点、指针塔、键和值在堆上的部分、缓存中的节点和缓存自身，见 memory_usage.h。遍历整个跳表
+    MemoryUsage memory_usage();
+
+    bool dump_stats(const std::string& path = STATS_FILE); // 以 Prometheus 文本格式写入文件
+
+    // 开启后 insert/delete/search/get 从本线程上次访问留下的各层前驱出发查找，而不是每次从头节点的最高层开始，
+    // 与上一个键相距 d 时只需 O(log d) 步，适合顺序或按时间递增的键。每个线程在同一类型的跳表上只记一个位置，
+    // 交替访问多个跳表时互相覆盖；删除节点会使其他线程的 finger 失效（下次从头查找）。默认关闭
+    void set_finger(bool enabled);
+
+    // 节点出现在上一层的概率 p：SKIPLIST_P_HALF（默认）、SKIPLIST_P_QUARTER、SKIPLIST_P_E 或 (0, 1) 内的其他值，
+    // 见 level_generator.h；只影响之后插入的节点。最大层级从构造时传入的值开始，元素数超过 (1/p)^最大层级 时加一，
+    // 不超过 SKIPLIST_LEVEL_LIMIT（构造时传入的值更大时以它为准），元素减少时不降低。
+    // 层级分布和每次查找的平均步数见 stats()：level_histogram、mean_hops()
+    void set_level_probability(double p);
+
 private:
+    void grow_max_level(); // 元素数超过 (1/p)^_max_level 时增加最大层级，调用方需持有 _mtx
     int get_random_level(); // 获取随机层级
 
-    Node<K, V>* create_node(K, V, int, time_t expire_time = 0); // 创建新节点
+    Node<K, V>* create_node(K, V, int, int64_t expire_time = 0); // 创建新节点
+
+    void destroy_node(Node<K, V>*); // 析构节点并把内存还给内存池
 
     void get_key_value_from_string(const std::string& str, std::string* key, std::string* value, std::string* expire_time_str); // 从字符串解析键值对和过期时间
 
     bool is_valid_string(const std::string& str); // 检查字符串是否有效
 
-    void clear(Node<K, V>*); // 递归删除节点
+    void clear(); // 释放所有节点（含头节点）
+
+    void load_text_file(); // 加载旧的 key:value 文本格式的 dumpFile
+
+    void commit_wal(uint64_t seq); // 等待序号为 seq 的日志记录写出，0 表示没有写日志
+
+    bool write_snapshot(std::string* error); // 写快照，不打印；调用方需持有 _mtx 或是 fork 出的子进程
+
+    Node<K, V>* find_live_node(const K&, int64_t now); // 查找未过期的节点，遇到已过期的节点时删除它，调用方需持有 _mtx
+    // 持共享锁查找未过期的节点，找到时在持锁期间调用 found(Node<K, V>*)；遇到已过期的节点时加写锁删除它
+    template<typename Found>
+    bool read_node(const K&, Found found);
+    void remove_node(Node<K, V>* node, Node<K, V>** update); // 摘除过期的节点（update[] 为各层前驱）并从LRU缓存中删除，调用方需持有 _mtx
+    size_t remove_expired(const K* keys, size_t count, int64_t now); // 删除有序键列表中已过期的节点，调用方需持有 _mtx
+    void track_expiry(const K&, int64_t expire_time); // 把带过期时间的键加入过期索引，调用方需持有 _mtx
+    // 处理过期索引中到期的键，最多 limit 个，返回删除的节点数，调用方需持有 _mtx
+    size_t reclaim_expired(int64_t now, size_t limit = SIZE_MAX);
+    void rebuild_expiry_index(); // 按现有节点重建过期索引，丢掉失效的记录
+    // 从 update[] 中上一个（不大于 key 的）键的各层前驱继续查找，只重走 key 越过了的那些层；
+    // update[] 全为 _header 时等价于从头查找。结束后 update[] 为 key 的各层前驱，返回第一个 >= key 的节点，调用方需持有 _mtx
+    Node<K, V>* finger_seek(const K&, Node<K, V>** update);
+    // 查找路径：walk 在一层上向后走并预取；locate 从头（或本线程的 finger）下降，update[] 为 key 在各层的前驱，
+    // 返回第一个 >= key 的节点，update[0..exact] 保证准确；修改跳表前用 exact_path 补齐到 level 层。调用方需持有 _mtx
+    Node<K, V>* walk(Node<K, V>* current, int level, const K& key, size_t& hops);
+    bool precedes(Node<K, V>* node, int level, const K& key);
+    Node<K, V>* locate(const K& key, Node<K, V>** update, int& exact);
+    void exact_path(const K& key, Node<K, V>** update, int exact, int level);
+    // 本线程在这个跳表上的 finger：上次访问时 key 在各层的前驱。有节点被释放（_finger_epoch 变化）后作废
+    struct SearchFinger {
+        uint64_t owner = 0;
+        uint64_t epoch = 0;
+        std::vector<Node<K, V>*> path;
+    };
+    static SearchFinger& thread_finger();
+    static uint64_t next_finger_owner();
+    void save_finger(Node<K, V>** update);
+    size_t apply_batch(const WriteBatch<K, V>&, const std::vector<size_t>& order); // 按给定的键序应用整批操作，返回删掉的未过期键数，调用方需持有 _mtx
+    int sequential_level(long position); // 平衡构建时第 position 个（从1开始）追加的键的层级
+    Node<K, V>* find_greater(const K&, bool inclusive); // 第一个 >= key（inclusive 为 false 时 > key）的节点，调用方需持有 _mtx
+    Node<K, V>* find_less(const K&, bool inclusive); // 最后一个 < key（inclusive 为 true 时 <= key）的节点，没有时返回 nullptr
+    Node<K, V>* find_last(); // 最后一个节点，跳表为空时返回 nullptr
+    // 迭代器使用的批量读取，from 为 nullptr 时从最小键/最大键开始
+    void read_forward(const K* from, bool inclusive, size_t max, std::vector<std::pair<K, V>>& out);
+    void read_backward(const K* from, bool inclusive, size_t max, std::vector<std::pair<K, V>>& out);
 
 private:
-    int _max_level; // 最大层级
+    int _max_level; // 最大层级，随元素数增长
+    int _level_limit; // 最大层级的上限，即头节点的层级
     int _skip_list_level; // 当前层级
     int _element_count; // 跳表中的元素数量
     Node<K, V>* _header; // 跳表头节点
-    LRUCache<K, V>* _lru_cache; // LRU缓存指针
-    std::ofstream _file_writer; // 文件写操作对象
-    std::ifstream _file_reader; // 文件读操作对象
+    Cache<K, V>* _lru_cache; // 缓存策略，只记录节点的使用顺序
+    NodeArena _arena; // 节点内存池
+    std::ifstream _file_reader; // 读取旧文本格式 dumpFile 的文件对象
+    StatsCollector _stats; // 按线程分片的延迟直方图和计数
+    StatsMutex _mtx; // 用于临界区的互斥锁，每个跳表实例独立一把；同时记录等待和持有时间
+    std::vector<long> _level_counts; // 每个层级的节点数，持锁维护
+    WriteAheadLog _wal; // 预写日志，记录在持有 _mtx 时追加，日志顺序即修改顺序
+    std::mutex _save_mtx; // 后台保存的启动与 dump_file 互斥
+    std::thread _save_thread; // 等待子进程退出的线程
+    std::atomic<bool> _saving; // 子进程还没退出时为 true
+    ExpiryWheel<K> _expiry; // 过期索引，持锁维护
+    std::vector<K> _expire_backlog; // 从过期索引取出、按键排好序的到期键
+    size_t _expire_next; // _expire_backlog 中下一个要处理的位置
+    size_t _reclaimed; // 因过期删除的节点数
+    std::atomic<bool> _finger_enabled; // set_finger
+    uint64_t _finger_owner; // 区分不同的跳表实例，线程的 finger 只对记录它的实例有效
+    uint64_t _finger_epoch; // 释放节点时加一，持写锁修改
+    LevelGenerator _levels; // 节点层级的随机分布
+    size_t _grow_at; // 元素数超过这个数时最大层级加一
 };
 
 // 创建新节点
-template<typename K, typename V>
-Node<K, V>* SkipList<K, V>::create_node(const K k, const V v, int level, time_t expire_time) {
-    Node<K, V>* n = new Node<K, V>(k, v, level, expire_time);
+template<typename K, typename V, template<typename, typename> class Cache>
+Node<K, V>* SkipList<K, V, Cache>::create_node(const K k, const V v, int level, int64_t expire_time) {
+    // 节点和 level + 1 个 forward 指针一次性从内存池分配
+    size_t bytes = sizeof(Node<K, V>) + sizeof(Node<K, V>*) * level;
+    Node<K, V>* n = new (_arena.allocate(bytes, level)) Node<K, V>(k, v, level, expire_time);
     return n;
 }
 
-// 获取随机层级，用于插入新节点时确定它在跳表中的层级
-template<typename K, typename V>
-int SkipList<K, V>::get_random_level() {
-    int k = 1;
-    while (rand() % 2) {
-        k++;
+// 析构节点并把内存还给内存池
+template<typename K, typename V, template<typename, typename> class Cache>
+void SkipList<K, V, Cache>::destroy_node(Node<K, V>* node) {
+    int level = node->node_level;
+    node->~Node<K, V>();
+    _arena.deallocate(node, level);
+    _finger_epoch++; // 各线程 finger 中可能有这个节点
+}
+
+// 在第 level 层从 current 向后走到最后一个键小于 key 的节点；每走一步先预取再下一个节点，
+// 比较当前后继的键时，下一步要读的节点已经在路上
+template<typename K, typename V, template<typename, typename> class Cache>
+Node<K, V>* SkipList<K, V, Cache>::walk(Node<K, V>* current, int level, const K& key, size_t& hops) {
+    Node<K, V>* next = current->forward[level];
+    while (next != nullptr) {
+        SKIPLIST_PREFETCH(next->forward[level]);
+        if (!(next->get_key() < key)) {
+            break;
+        }
+        current = next;
+        next = next->forward[level];
+        hops++;
+    }
+    return current;
+}
+
+// node 是否为 key 在第 level 层的前驱：键小于 key（头节点小于所有键），第 level 层的后继不小于 key
+template<typename K, typename V, template<typename, typename> class Cache>
+bool SkipList<K, V, Cache>::precedes(Node<K, V>* node, int level, const K& key) {
+    if (node != _header && !(node->get_key() < key)) {
+        return false;
+    }
+    Node<K, V>* next = node->forward[level];
+    return next == nullptr || !(next->get_key() < key);
+}
+
+// 开启 finger 时，上次的前驱在低层离 key 最近，越往上越远：从第0层往上找到第一层仍是 key 的前驱的，
+// 从那里往下重走，键相距 d 时只走 O(log d) 层。向前、向后移动都适用
+template<typename K, typename V, template<typename, typename> class Cache>
+Node<K, V>* SkipList<K, V, Cache>::locate(const K& key, Node<K, V>** update, int& exact) {
+    Node<K, V>* current = _header;
+    int level = _skip_list_level;
+    SearchFinger* finger = _finger_enabled.load(std::memory_order_relaxed) ? &thread_finger() : nullptr;
+    if (finger != nullptr && finger->owner == _finger_owner && finger->epoch == _finger_epoch) {
+        for (int i = 0; i <= _skip_list_level; i++) {
+            update[i] = i < static_cast<int>(finger->path.size()) ? finger->path[i] : _header;
+        }
+        level = 0;
+        while (level < _skip_list_level && !precedes(update[level], level, key)) {
+            level++;
+        }
+        if (update[level] == _header || update[level]->get_key() < key) {
+            current = update[level];
+        }
+    }
+    size_t hops = 0;
+    for (int i = level; i >= 0; i--) {
+        current = walk(current, i, key, hops);
+        update[i] = current;
+    }
+    exact = level;
+    _stats.add(STATS_SEARCH_PATHS);
+    _stats.add(STATS_SEARCH_HOPS, hops);
+    if (finger != nullptr) {
+        save_finger(update);
+    }
+    return current->forward[0];
+}
+
+// 没有其他线程在两次访问之间修改 finger 附近的节点时，exact 以上各层的旧前驱仍然准确，逐层确认即可；
+// 否则从头重新查找
+template<typename K, typename V, template<typename, typename> class Cache>
+void SkipList<K, V, Cache>::exact_path(const K& key, Node<K, V>** update, int exact, int level) {
+    for (int i = exact + 1; i <= level && i <= _skip_list_level; i++) {
+        if (!precedes(update[i], i, key)) {
+            Node<K, V>* current = _header;
+            size_t hops = 0;
+            for (int j = _skip_list_level; j >= 0; j--) {
+                current = walk(current, j, key, hops);
+                update[j] = current;
+            }
+            return;
+        }
+    }
+}
+
+template<typename K, typename V, template<typename, typename> class Cache>
+void SkipList<K, V, Cache>::save_finger(Node<K, V>** update) {
+    SearchFinger& finger = thread_finger();
+    finger.owner = _finger_owner;
+    finger.epoch = _finger_epoch;
+    finger.path.assign(update, update + _skip_list_level + 1);
+}
+
+template<typename K, typename V, template<typename, typename> class Cache>
+typename SkipList<K, V, Cache>::SearchFinger& SkipList<K, V, Cache>::thread_finger() {
+    thread_local SearchFinger finger;
+    return finger;
+}
+
+template<typename K, typename V, template<typename, typename> class Cache>
+uint64_t SkipList<K, V, Cache>::next_finger_owner() {
+    static std::atomic<uint64_t> next(1);
+    return next.fetch_add(1, std::memory_order_relaxed);
+}
+
+template<typename K, typename V, template<typename, typename> class Cache>
+void SkipList<K, V, Cache>::set_finger(bool enabled) {
+    _finger_enabled.store(enabled, std::memory_order_relaxed);
+}
+
+template<typename K, typename V, template<typename, typename> class Cache>
+void SkipList<K, V, Cache>::set_level_probability(double p) {
+    std::lock_guard<StatsMutex> lock(_mtx);
+    _levels.set_probability(p);
+    _grow_at = _levels.capacity(_max_level);
+    grow_max_level();
+}
+
+// 期望的最高层级为 log_{1/p}(n)，最大层级跟着元素数走，大表的高层不会被截断成一条长链
+template<typename K, typename V, template<typename, typename> class Cache>
+void SkipList<K, V, Cache>::grow_max_level() {
+    while (static_cast<size_t>(_element_count) > _grow_at && _max_level < _level_limit) {
+        _max_level++;
+        _grow_at = _levels.capacity(_max_level);
     }
-    k = (k < _max_level) ? k : _max_level;
-    return k;
+}
+
+// 获取随机层级，用于插入新节点时确定它在跳表中的层级（见 level_generator.h）
+template<typename K, typename V, template<typename, typename> class Cache>
+int SkipList<K, V, Cache>::get_random_level() {
+    return _levels.next(_max_level);
 }
 
 // 跳表构造函数，初始化最大层级和LRU缓存容量
-template<typename K, typename V>
-SkipList<K, V>::SkipList(int max_level, size_t lru_capacity) {
+template<typename K, typename V, template<typename, typename> class Cache>
+SkipList<K, V, Cache>::SkipList(int max_level, CacheCapacity lru_capacity)
+    : _level_limit(std::max(max_level, SKIPLIST_LEVEL_LIMIT)), _arena(_level_limit), _mtx(_stats),
+      _level_counts(_level_limit + 1, 0), _saving(false), _expire_next(0), _reclaimed(0),
+      _finger_enabled(false), _finger_owner(next_finger_owner()), _finger_epoch(0), _grow_at(_levels.capacity(max_level)) {
     this->_max_level = max_level;
     this->_skip_list_level = 0;
     this->_element_count = 0;
@@ -276,65 +577,74 @@ SkipList<K, V>::SkipList(int max_level, size_t lru_capacity) {
     // 创建头节点并初始化键值为空
     K k;
     V v;
-    this->_header = new Node<K, V>(k, v, _max_level);
+    this->_header = create_node(k, v, _level_limit); // 最大层级增长时不用重新分配头节点
 
     // 初始化LRU缓存
-    _lru_cache = new LRUCache<K, V>(lru_capacity);
+    _lru_cache = new Cache<K, V>(lru_capacity);
 }
 
 // 跳表析构函数，清理资源
-template<typename K, typename V>
-SkipList<K, V>::~SkipList() {
-    if (_file_writer.is_open()) {
-        _file_writer.close();
+template<typename K, typename V, template<typename, typename> class Cache>
+SkipList<K, V, Cache>::~SkipList() {
+    if (_save_thread.joinable()) {
+        _save_thread.join();
     }
     if (_file_reader.is_open()) {
         _file_reader.close();
     }
 
-    if (_header->forward[0] != nullptr) {
-        clear(_header->forward[0]);
-    }
-    delete _header;
+    clear();
     delete _lru_cache;
 }
 
-// 递归清理节点
-template<typename K, typename V>
-void SkipList<K, V>::clear(Node<K, V>* cur) {
-    if (cur->forward[0] != nullptr) {
-        clear(cur->forward[0]);
+// 释放所有节点：节点内存随内存池整块释放，只有键或值需要析构（或节点是逐个分配的）时才遍历第0层
+template<typename K, typename V, template<typename, typename> class Cache>
+void SkipList<K, V, Cache>::clear() {
+    if (!NodeArena::bulk_release() ||
+        !std::is_trivially_destructible<K>::value || !std::is_trivially_destructible<V>::value) {
+        Node<K, V>* cur = _header->forward[0];
+        while (cur != nullptr) {
+            Node<K, V>* next = cur->forward[0];
+            destroy_node(cur);
+            cur = next;
+        }
     }
-    delete cur;
+    destroy_node(_header);
+    _header = nullptr;
 }
 
 // 插入元素到跳表，并将元素插入LRU缓存
-template<typename K, typename V>
-int SkipList<K, V>::insert_element(const K key, const V value, time_t expire_time) {
-    mtx.lock(); // 加锁
+template<typename K, typename V, template<typename, typename> class Cache>
+int SkipList<K, V, Cache>::insert_element(const K key, const V value, int64_t expire_time) {
+    StatsScope scope(_stats, STATS_INSERT);
+    uint64_t seq = 0;
+    _mtx.lock(); // 加锁
     Node<K, V>* current = this->_header;
 
-    Node<K, V>* update[_max_level + 1];
-    memset(update, 0, sizeof(Node<K, V>*) * (_max_level + 1));
+    Node<K, V>* update[_level_limit + 1];
+    memset(update, 0, sizeof(Node<K, V>*) * (_level_limit + 1));
 
-    // 从最高层开始向下查找插入位置
-    for (int i = _skip_list_level; i >= 0; i--) {
-        while (current->forward[i] != NULL && current->forward[i]->get_key() < key) {
-            current = current->forward[i];
-        }
-        update[i] = current;
-    }
+    int exact;
+    current = locate(key, update, exact);
 
-    current = current->forward[0];
+    // 已过期但还没被清理的键视为不存在，与读操作一致：先删除它，再插入新值
+    if (current != NULL && current->get_key() == key && current->get_expire_time() != 0 &&
+        current->get_expire_time() <= expiry_now_ms()) {
+        exact_path(key, update, exact, current->node_level);
+        remove_node(current, update);
+        _reclaimed++;
+        current = NULL;
+    }
 
     if (current != NULL && current->get_key() == key) {
         std::cout << "key: " << key << ", exists" << std::endl;
-        mtx.unlock();
+        _mtx.unlock();
         return 1; // 如果键已存在，返回1
     }
 
     if (current == NULL || current->get_key() != key) {
         int random_level = get_random_level();
+        exact_path(key, update, exact, random_level);
 
         // 如果随机层级高于当前层级，更新跳表层级
         if (random_level > _skip_list_level) {
@@ -352,32 +662,40 @@ int SkipList<K, V>::insert_element(const K key, const V value, time_t expire_tim
         }
 
         // 插入LRU缓存
-        _lru_cache->put(key, value, expire_time);
+        _lru_cache->put(inserted_node);
+        track_expiry(key, expire_time);
 
         std::cout << "Successfully inserted key:" << key << ", value:" << value << std::endl;
         _element_count++;
+        _level_counts[random_level]++;
+        grow_max_level();
+
+        // 写日志
+        if (_wal.is_open()) {
+            std::string record;
+            wal_encode_put(record, key, value, expire_time);
+            seq = _wal.append(record);
+        }
     }
-    mtx.unlock(); // 解锁
+    _mtx.unlock(); // 解锁
+    commit_wal(seq);
     return 0;
 }
 
 // 删除元素，并从LRU缓存中移除
-template<typename K, typename V>
-void SkipList<K, V>::delete_element(K key) {
-    mtx.lock(); // 加锁
+template<typename K, typename V, template<typename, typename> class Cache>
+void SkipList<K, V, Cache>::delete_element(K key) {
+    StatsScope scope(_stats, STATS_DELETE);
+    uint64_t seq = 0;
+    _mtx.lock(); // 加锁
     Node<K, V>* current = this->_header;
-    Node<K, V>* update[_max_level + 1];
-    memset(update, 0, sizeof(Node<K, V>*) * (_max_level + 1));
-
-    for (int i = _skip_list_level; i >= 0; i--) {
-        while (current->forward[i] != NULL && current->forward[i]->get_key() < key) {
-            current = current->forward[i];
-        }
-        update[i] = current;
-    }
+    Node<K, V>* update[_level_limit + 1];
+    memset(update, 0, sizeof(Node<K, V>*) * (_level_limit + 1));
 
-    current = current->forward[0];
+    int exact;
+    current = locate(key, update, exact);
     if (current != NULL && current->get_key() == key) {
+        exact_path(key, update, exact, current->node_level);
         for (int i = 0; i <= _skip_list_level; i++) {
             if (update[i]->forward[i] != current)
                 break;
@@ -388,53 +706,536 @@ void SkipList<K, V>::delete_element(K key) {
             _skip_list_level--;
         }
 
-        _lru_cache->remove(key); // 从LRU缓存中移除
+        _lru_cache->remove(current); // 从LRU缓存中移除
 
         std::cout << "Successfully deleted key " << key << std::endl;
-        delete current;
+        _level_counts[current->node_level]--;
+        destroy_node(current);
         _element_count--;
+        if (_finger_enabled.load(std::memory_order_relaxed)) {
+            save_finger(update); // 前驱都还在，换成新的 epoch 重新记下
+        }
+
+        // 写日志
+        if (_wal.is_open()) {
+            std::string record;
+            wal_encode_delete(record, key);
+            seq = _wal.append(record);
+        }
     }
-    mtx.unlock(); // 解锁
+    _mtx.unlock(); // 解锁
+    commit_wal(seq);
 }
 
 // 查找元素
-template<typename K, typename V>
-bool SkipList<K, V>::search_element(K key) {
+template<typename K, typename V, template<typename, typename> class Cache>
+bool SkipList<K, V, Cache>::search_element(K key) {
+    StatsScope scope(_stats, STATS_SEARCH);
     std::cout << "search_element-----------------" << std::endl;
 
-    // 先在LRU缓存中查找
-    V value;
-    if (_lru_cache->get(key, value)) {
-        std::cout << "Found key in LRU Cache: " << key << ", value: " << value << std::endl;
+    // 缓存只记录节点的使用顺序：先在跳表中找到节点，再看它是否在缓存中，不在时加入缓存
+    auto found = [&](Node<K, V>* current) {
+        if (_lru_cache->get(current)) {
+            std::cout << "Found key in LRU Cache: " << key << ", value: " << current->get_value() << std::endl;
+            _stats.add(STATS_LRU_HIT);
+        } else {
+            _stats.add(STATS_LRU_MISS);
+            _lru_cache->put(current);
+            std::cout << "Found key in Skip List: " << key << ", value: " << current->get_value() << std::endl;
+        }
+    };
+
+    bool exists;
+    if (Cache<K, V>::concurrent) {
+        exists = read_node(key, found); // 命中只置位，和其他读一样持共享锁
+    } else {
+        std::lock_guard<StatsMutex> lock(_mtx); // 命中也会移动缓存链表，需要加写锁
+        Node<K, V>* current = find_live_node(key, expiry_now_ms());
+        exists = current != nullptr;
+        if (exists) {
+            found(current);
+        }
+    }
+    if (exists) {
+        _stats.add(STATS_SEARCH_HIT);
         return true;
     }
+    _stats.add(STATS_LRU_MISS);
+
+    std::cout << "Not Found Key:" << key << std::endl;
+    _stats.add(STATS_SEARCH_MISS);
+    return false;
+}
+
+// 从最高层向下查找键所在的节点，已过期的节点视为不存在并立即删除（读时过期）
+template<typename K, typename V, template<typename, typename> class Cache>
+Node<K, V>* SkipList<K, V, Cache>::find_live_node(const K& key, int64_t now) {
+    Node<K, V>* update[_level_limit + 1];
+    int exact;
+    Node<K, V>* current = locate(key, update, exact);
+    if (current == nullptr || current->get_key() != key) {
+        return nullptr;
+    }
+    if (current->get_expire_time() != 0 && current->get_expire_time() <= now) {
+        exact_path(key, update, exact, current->node_level);
+        remove_node(current, update);
+        _reclaimed++;
+        return nullptr;
+    }
+    return current;
+}
+
+// 共享锁下的只读查找，与 find_live_node 相同但不删除节点；节点已过期时改为加写锁，由 find_live_node 删除它。
+// 放开共享锁到加上写锁之间键可能已被删除或重新写入，所以加写锁后重新查找
+template<typename K, typename V, template<typename, typename> class Cache>
+template<typename Found>
+bool SkipList<K, V, Cache>::read_node(const K& key, Found found) {
+    int64_t now = expiry_now_ms();
+    {
+        std::shared_lock<StatsMutex> lock(_mtx);
+        Node<K, V>* update[_level_limit + 1];
+        int exact;
+        Node<K, V>* current = locate(key, update, exact);
+        if (current == nullptr || current->get_key() != key) {
+            return false;
+        }
+        if (current->get_expire_time() == 0 || current->get_expire_time() > now) {
+            found(current);
+            return true;
+        }
+    }
+    std::lock_guard<StatsMutex> lock(_mtx);
+    Node<K, V>* node = find_live_node(key, now);
+    if (node == nullptr) {
+        return false;
+    }
+    found(node);
+    return true;
+}
+
+// 查找并返回值的拷贝
+template<typename K, typename V, template<typename, typename> class Cache>
+std::optional<V> SkipList<K, V, Cache>::get(const K& key) {
+    StatsScope scope(_stats, STATS_GET);
+    std::optional<V> result;
+    read_node(key, [&](Node<K, V>* node) { result = node->get_value(); });
+    return result;
+}
 
-    // 如果在LRU缓存中找不到，再在跳表中查找
+// 查找并把值写入出参，找不到时出参保持不变
+template<typename K, typename V, template<typename, typename> class Cache>
+bool SkipList<K, V, Cache>::get(const K& key, V& value) {
+    StatsScope scope(_stats, STATS_GET);
+    return read_node(key, [&](Node<K, V>* node) { value = node->get_value(); });
+}
+
+// 零拷贝读取：visitor 执行期间持有（共享）锁，节点不会被修改或删除，visitor 内不能再调用本跳表
+template<typename K, typename V, template<typename, typename> class Cache>
+template<typename Visitor>
+bool SkipList<K, V, Cache>::get_with(const K& key, Visitor visitor) {
+    StatsScope scope(_stats, STATS_GET);
+    return read_node(key, [&](Node<K, V>* node) { visitor(node->get_value()); });
+}
+
+// 判断键是否存在
+template<typename K, typename V, template<typename, typename> class Cache>
+bool SkipList<K, V, Cache>::contains(const K& key) {
+    StatsScope scope(_stats, STATS_GET);
+    return read_node(key, [](Node<K, V>*) {});
+}
+
+// finger search：被 key 越过的层一定是从第0层开始的连续若干层（在第 i 层越过的节点也链接在更低的各层上）
+template<typename K, typename V, template<typename, typename> class Cache>
+Node<K, V>* SkipList<K, V, Cache>::finger_seek(const K& key, Node<K, V>** update) {
+    int stale = 0;
+    while (stale <= _skip_list_level && update[stale]->forward[stale] != NULL &&
+           update[stale]->forward[stale]->get_key() < key) {
+        stale++;
+    }
+
+    // 只重走这些层，起点取旧前驱和上一层走到的节点中更靠后的一个
     Node<K, V>* current = _header;
+    size_t hops = 0;
+    for (int i = stale - 1; i >= 0; i--) {
+        if (current == _header ||
+            (update[i] != _header && current->get_key() < update[i]->get_key())) {
+            current = update[i];
+        }
+        current = walk(current, i, key, hops);
+        update[i] = current;
+    }
+    _stats.add(STATS_SEARCH_PATHS);
+    _stats.add(STATS_SEARCH_HOPS, hops);
+    return update[0]->forward[0];
+}
 
+// 批量查找：排序在加锁前完成
+template<typename K, typename V, template<typename, typename> class Cache>
+std::vector<std::optional<V>> SkipList<K, V, Cache>::multi_get(const std::vector<K>& keys) {
+    StatsScope scope(_stats, STATS_MULTI_GET);
+    std::vector<size_t> order(keys.size());
+    for (size_t i = 0; i < order.size(); i++) {
+        order[i] = i;
+    }
+    std::sort(order.begin(), order.end(), [&keys](size_t a, size_t b) { return keys[a] < keys[b]; });
+
+    std::vector<std::optional<V>> values(keys.size());
+    std::vector<K> expired; // 遇到的已过期键，查完后删除，不打乱 update[]
+    std::lock_guard<StatsMutex> lock(_mtx);
+    int64_t now = expiry_now_ms();
+    std::vector<Node<K, V>*> update(_level_limit + 1, _header);
+    for (size_t i : order) {
+        Node<K, V>* node = finger_seek(keys[i], update.data());
+        if (node != NULL && node->get_key() == keys[i]) {
+            if (node->get_expire_time() == 0 || node->get_expire_time() > now) {
+                values[i] = node->get_value();
+            } else {
+                expired.push_back(keys[i]);
+            }
+        }
+    }
+    remove_expired(expired.data(), expired.size(), now);
+    return values;
+}
+
+// 批量构建：tail[i] 为第 i 层最后一个节点，比当前最大键还大的键直接接在后面
+template<typename K, typename V, template<typename, typename> class Cache>
+template<typename Source>
+size_t SkipList<K, V, Cache>::bulk_load(Source next, bool random_levels) {
+    StatsScope scope(_stats, STATS_BULK_LOAD);
+    std::lock_guard<StatsMutex> lock(_mtx);
+
+    std::vector<Node<K, V>*> tail(_level_limit + 1, _header);
+    Node<K, V>* current = _header;
     for (int i = _skip_list_level; i >= 0; i--) {
-        while (current->forward[i] && current->forward[i]->get_key() < key) {
+        while (current->forward[i] != NULL) {
             current = current->forward[i];
         }
+        tail[i] = current;
     }
 
-    current = current->forward[0];
+    std::vector<Node<K, V>*> update(_level_limit + 1, _header);
+    long position = _element_count;
+    size_t loaded = 0;
+    K key;
+    V value;
+    int64_t expire_time = 0;
+    while (next(key, value, expire_time)) {
+        if (tail[0] == _header || tail[0]->get_key() < key) {
+            // 追加：新节点覆盖的每一层都接在 tail[i] 之后
+            int level = random_levels ? get_random_level() : sequential_level(++position);
+            if (level > _skip_list_level) {
+                _skip_list_level = level;
+            }
+            Node<K, V>* node = create_node(key, value, level, expire_time);
+            for (int i = 0; i <= level; i++) {
+                tail[i]->forward[i] = node;
+                tail[i] = node;
+            }
+            track_expiry(key, expire_time);
+            _element_count++;
+            _level_counts[level]++;
+            grow_max_level();
+            loaded++;
+            continue;
+        }
 
-    if (current && current->get_key() == key) {
-        // 在跳表中找到，先输出并插入LRU缓存
-        value = current->get_value();
-        _lru_cache->put(key, value, current->get_expire_time());
-        std::cout << "Found key in Skip List: " << key << ", value: " << value << std::endl;
+        // 乱序：与 insert_element 相同的查找插入
+        current = _header;
+        for (int i = _skip_list_level; i >= 0; i--) {
+            while (current->forward[i] != NULL && current->forward[i]->get_key() < key) {
+                current = current->forward[i];
+            }
+            update[i] = current;
+        }
+        current = current->forward[0];
+        if (current != NULL && current->get_key() == key) {
+            continue;
+        }
+        int level = get_random_level();
+        if (level > _skip_list_level) {
+            for (int i = _skip_list_level + 1; i < level + 1; i++) {
+                update[i] = _header;
+            }
+            _skip_list_level = level;
+        }
+        Node<K, V>* node = create_node(key, value, level, expire_time);
+        for (int i = 0; i <= level; i++) {
+            node->forward[i] = update[i]->forward[i];
+            update[i]->forward[i] = node;
+            if (update[i] == tail[i]) { // 接在原来的最后一个节点之后，成为该层新的最后一个节点
+                tail[i] = node;
+            }
+        }
+        track_expiry(key, expire_time);
+        _element_count++;
+        _level_counts[level]++;
+        grow_max_level();
+        loaded++;
+    }
+    return loaded;
+}
+
+// 从有序的键值对数组构建，不带过期时间
+template<typename K, typename V, template<typename, typename> class Cache>
+size_t SkipList<K, V, Cache>::bulk_load(const std::vector<std::pair<K, V>>& items, bool random_levels) {
+    size_t i = 0;
+    return bulk_load([&items, &i](K& k, V& v, int64_t& expire_time) {
+        if (i == items.size()) {
+            return false;
+        }
+        k = items[i].first;
+        v = items[i].second;
+        expire_time = 0;
+        i++;
         return true;
+    }, random_levels);
+}
+
+// p = 1/2 时第 position 个键取 1 + position 末尾0的个数，各层级的比例与 get_random_level 完全一致
+template<typename K, typename V, template<typename, typename> class Cache>
+int SkipList<K, V, Cache>::sequential_level(long position) {
+    return _levels.sequential(position, _max_level);
+}
+
+// 原子写入一批操作
+template<typename K, typename V, template<typename, typename> class Cache>
+size_t SkipList<K, V, Cache>::write(const WriteBatch<K, V>& batch) {
+    StatsScope scope(_stats, STATS_WRITE_BATCH);
+    std::vector<size_t> order = batch.sorted_order();
+    uint64_t seq = 0;
+    size_t deleted;
+    {
+        std::lock_guard<StatsMutex> lock(_mtx);
+        deleted = apply_batch(batch, order);
+        // 整批写成一条日志记录
+        if (_wal.is_open() && !batch.empty()) {
+            std::string record;
+            wal_encode_batch(record, batch);
+            seq = _wal.append(record);
+        }
     }
+    commit_wal(seq);
+    return deleted;
+}
 
-    std::cout << "Not Found Key:" << key << std::endl;
-    return false;
+// 链接方式与 insert_element / delete_element 相同，区别是 put 会覆盖已有的值和过期时间，且不逐条打印。
+// 删除已过期但还没被清理的节点时同样摘除，但不计入返回值（读操作已经把它当作不存在）
+template<typename K, typename V, template<typename, typename> class Cache>
+size_t SkipList<K, V, Cache>::apply_batch(const WriteBatch<K, V>& batch, const std::vector<size_t>& order) {
+    std::vector<Node<K, V>*> update(_level_limit + 1, _header);
+    int64_t now = expiry_now_ms();
+    size_t deleted = 0;
+    for (size_t i : order) {
+        const typename WriteBatch<K, V>::Op& op = batch.ops()[i];
+        Node<K, V>* current = finger_seek(op.key, update.data());
+        bool found = current != NULL && current->get_key() == op.key;
+
+        if (op.is_delete) {
+            if (!found) {
+                continue;
+            }
+            if (current->get_expire_time() == 0 || current->get_expire_time() > now) {
+                deleted++;
+            }
+            for (int l = 0; l <= _skip_list_level; l++) {
+                if (update[l]->forward[l] != current)
+                    break;
+                update[l]->forward[l] = current->forward[l];
+            }
+            while (_skip_list_level > 0 && _header->forward[_skip_list_level] == 0) {
+                _skip_list_level--;
+            }
+            _lru_cache->remove(current);
+            _level_counts[current->node_level]--;
+            destroy_node(current);
+            _element_count--;
+        } else if (found) {
+            _lru_cache->remove(current); // 值的大小可能变化，先按原来的大小移出缓存，更新后重新放入
+            current->set_value(op.value);
+            current->set_expire_time(op.expire_time);
+            _lru_cache->put(current);
+            track_expiry(op.key, op.expire_time);
+        } else {
+            int random_level = get_random_level();
+            if (random_level > _skip_list_level) {
+                for (int l = _skip_list_level + 1; l < random_level + 1; l++) {
+                    update[l] = _header;
+                }
+                _skip_list_level = random_level;
+            }
+            // update[] 仍指向各层前驱，对下一个（不小于当前的）键依然有效
+            Node<K, V>* inserted_node = create_node(op.key, op.value, random_level, op.expire_time);
+            for (int l = 0; l <= random_level; l++) {
+                inserted_node->forward[l] = update[l]->forward[l];
+                update[l]->forward[l] = inserted_node;
+            }
+            _lru_cache->put(inserted_node);
+            track_expiry(op.key, op.expire_time);
+            _element_count++;
+            _level_counts[random_level]++;
+            grow_max_level();
+        }
+    }
+    return deleted;
+}
+
+// 从最高层向下查找第一个 >= key（或 > key）的节点，不检查过期
+template<typename K, typename V, template<typename, typename> class Cache>
+Node<K, V>* SkipList<K, V, Cache>::find_greater(const K& key, bool inclusive) {
+    Node<K, V>* current = _header;
+    for (int i = _skip_list_level; i >= 0; i--) {
+        while (current->forward[i] &&
+               (current->forward[i]->get_key() < key ||
+                (!inclusive && current->forward[i]->get_key() == key))) {
+            current = current->forward[i];
+        }
+    }
+    return current->forward[0];
+}
+
+// 查找最后一个 < key（或 <= key）的节点，不检查过期
+template<typename K, typename V, template<typename, typename> class Cache>
+Node<K, V>* SkipList<K, V, Cache>::find_less(const K& key, bool inclusive) {
+    Node<K, V>* current = _header;
+    for (int i = _skip_list_level; i >= 0; i--) {
+        while (current->forward[i] &&
+               (current->forward[i]->get_key() < key ||
+                (inclusive && current->forward[i]->get_key() == key))) {
+            current = current->forward[i];
+        }
+    }
+    return current == _header ? nullptr : current;
+}
+
+// 沿每层走到尽头，找到最后一个节点
+template<typename K, typename V, template<typename, typename> class Cache>
+Node<K, V>* SkipList<K, V, Cache>::find_last() {
+    Node<K, V>* current = _header;
+    for (int i = _skip_list_level; i >= 0; i--) {
+        while (current->forward[i]) {
+            current = current->forward[i];
+        }
+    }
+    return current == _header ? nullptr : current;
+}
+
+// 持锁按升序拷贝最多 max 个未过期的键值对
+template<typename K, typename V, template<typename, typename> class Cache>
+void SkipList<K, V, Cache>::read_forward(const K* from, bool inclusive, size_t max, std::vector<std::pair<K, V>>& out) {
+    std::lock_guard<StatsMutex> lock(_mtx);
+    int64_t now = expiry_now_ms();
+    std::vector<K> expired;
+    Node<K, V>* node = from ? find_greater(*from, inclusive) : _header->forward[0];
+    while (node != nullptr && out.size() < max) {
+        if (node->get_expire_time() == 0 || node->get_expire_time() > now) {
+            out.push_back(std::make_pair(node->get_key(), node->get_value()));
+        } else {
+            expired.push_back(node->get_key());
+        }
+        node = node->forward[0];
+    }
+    remove_expired(expired.data(), expired.size(), now);
+}
+
+// 持锁按降序拷贝；节点没有后向指针，每一步都重新从顶层查找前驱
+template<typename K, typename V, template<typename, typename> class Cache>
+void SkipList<K, V, Cache>::read_backward(const K* from, bool inclusive, size_t max, std::vector<std::pair<K, V>>& out) {
+    std::lock_guard<StatsMutex> lock(_mtx);
+    int64_t now = expiry_now_ms();
+    std::vector<K> expired;
+    Node<K, V>* node = from ? find_less(*from, inclusive) : find_last();
+    while (node != nullptr && out.size() < max) {
+        if (node->get_expire_time() == 0 || node->get_expire_time() > now) {
+            out.push_back(std::make_pair(node->get_key(), node->get_value()));
+        } else {
+            expired.push_back(node->get_key());
+        }
+        node = find_less(node->get_key(), false);
+    }
+    std::reverse(expired.begin(), expired.end());
+    remove_expired(expired.data(), expired.size(), now);
+}
+
+// 返回未定位的迭代器
+template<typename K, typename V, template<typename, typename> class Cache>
+typename SkipList<K, V, Cache>::Iterator SkipList<K, V, Cache>::new_iterator() {
+    return Iterator(this);
+}
+
+// 返回定位到第一个 >= key 的迭代器
+template<typename K, typename V, template<typename, typename> class Cache>
+typename SkipList<K, V, Cache>::Iterator SkipList<K, V, Cache>::lower_bound(const K& key) {
+    Iterator it(this);
+    it.seek(key);
+    return it;
+}
+
+// 返回定位到第一个 > key 的迭代器
+template<typename K, typename V, template<typename, typename> class Cache>
+typename SkipList<K, V, Cache>::Iterator SkipList<K, V, Cache>::upper_bound(const K& key) {
+    Iterator it(this);
+    it.seek_after(key);
+    return it;
+}
+
+// 范围扫描：每访问 SCAN_CHUNK_SIZE 个节点释放一次锁，再从上次停下的键之后重新定位
+template<typename K, typename V, template<typename, typename> class Cache>
+template<typename Callback>
+size_t SkipList<K, V, Cache>::scan(const K& begin, const K& end, size_t limit, Callback callback) {
+    size_t count = 0;
+    K from = begin;
+    bool inclusive = true;
+    while (true) {
+        std::lock_guard<StatsMutex> lock(_mtx);
+        int64_t now = expiry_now_ms();
+        Node<K, V>* node = find_greater(from, inclusive);
+        std::vector<K> expired; // 本批遇到的已过期键，放锁前删除
+        bool done = false;
+        for (size_t visited = 0; visited < SCAN_CHUNK_SIZE; visited++) {
+            if (node == nullptr || !(node->get_key() < end) || (limit != 0 && count >= limit)) {
+                done = true;
+                break;
+            }
+            if (node->get_expire_time() == 0 || node->get_expire_time() > now) {
+                callback(node->get_key(), node->get_value());
+                count++;
+            } else {
+                expired.push_back(node->get_key());
+            }
+            from = node->get_key();
+            node = node->forward[0];
+        }
+        remove_expired(expired.data(), expired.size(), now);
+        if (done) {
+            return count;
+        }
+        inclusive = false;
+    }
+}
+
+// 查找并返回值和过期时间（0表示永不过期）
+template<typename K, typename V, template<typename, typename> class Cache>
+std::optional<std::pair<V, int64_t>> SkipList<K, V, Cache>::get_with_ttl(const K& key) {
+    StatsScope scope(_stats, STATS_GET);
+    std::optional<std::pair<V, int64_t>> result;
+    read_node(key, [&](Node<K, V>* node) { result = std::make_pair(node->get_value(), node->get_expire_time()); });
+    return result;
+}
+
+// 查找并把值和过期时间写入出参
+template<typename K, typename V, template<typename, typename> class Cache>
+bool SkipList<K, V, Cache>::get_with_ttl(const K& key, V& value, int64_t& expire_time) {
+    StatsScope scope(_stats, STATS_GET);
+    return read_node(key, [&](Node<K, V>* node) {
+        value = node->get_value();
+        expire_time = node->get_expire_time();
+    });
 }
 
 // 显示跳表内容
-template<typename K, typename V>
-void SkipList<K, V>::display_list() {
+template<typename K, typename V, template<typename, typename> class Cache>
+void SkipList<K, V, Cache>::display_list() {
     std::cout << "\n*****Skip List*****" << "\n";
     for (int i = 0; i <= _skip_list_level; i++) {
         Node<K, V>* node = this->_header->forward[i];
@@ -447,51 +1248,230 @@ void SkipList<K, V>::display_list() {
     }
 }
 
-// 保存跳表内容到文件
-template<typename K, typename V>
-void SkipList<K, V>::dump_file() {
-
+// 保存跳表内容到文件，保存期间持锁，快照与清空日志时的内容一致
+template<typename K, typename V, template<typename, typename> class Cache>
+void SkipList<K, V, Cache>::dump_file() {
+    StatsScope scope(_stats, STATS_DUMP);
     std::cout << "dump_file-----------------" << std::endl;
-    _file_writer.open(STORE_FILE);
-    Node<K, V> *node = this->_header->forward[0];
+    std::lock_guard<std::mutex> save_lock(_save_mtx);
+    // 后台保存写的是同一个文件，先等它结束
+    if (_save_thread.joinable()) {
+        _save_thread.join();
+    }
+    std::lock_guard<StatsMutex> lock(_mtx);
+    std::string error;
+    if (!write_snapshot(&error)) {
+        std::cout << "dump_file failed: " << error << std::endl;
+        return;
+    }
+    // 所有写过日志的修改都已在快照中
+    if (_wal.is_open() && !_wal.reset()) {
+        std::cout << "dump_file: " << _wal.error() << std::endl;
+    }
+}
 
-    while (node != NULL) {
-        _file_writer << node->get_key() << ":" << node->get_value() << "\n";
-        std::cout << node->get_key() << ":" << node->get_value() << ";\n";
+// 按第0层的键序写出键、值和过期时间，不打印；调用方需持有 _mtx，或是 background_save fork 出的子进程
+template<typename K, typename V, template<typename, typename> class Cache>
+bool SkipList<K, V, Cache>::write_snapshot(std::string* error) {
+    SnapshotWriter writer;
+    bool ok = writer.open(STORE_FILE);
+    Node<K, V>* node = _header->forward[0];
+    while (ok && node != NULL) {
+        ok = writer.add(node->get_key(), node->get_value(), node->get_expire_time());
         node = node->forward[0];
     }
+    if (!ok || !writer.finish()) {
+        *error = writer.error();
+        return false;
+    }
+    return true;
+}
+
+// 后台保存：持锁轮换日志并 fork，子进程写快照，父进程立即放锁继续处理请求
+template<typename K, typename V, template<typename, typename> class Cache>
+bool SkipList<K, V, Cache>::background_save() {
+    std::lock_guard<std::mutex> save_lock(_save_mtx);
+    if (_saving) {
+        return false; // 上一次后台保存还没结束
+    }
+    if (_save_thread.joinable()) {
+        _save_thread.join();
+    }
 
-    _file_writer.flush();
-    _file_writer.close();
-    return ;
+    pid_t pid;
+    {
+        StatsScope scope(_stats, STATS_BGSAVE_FORK); // 写请求被挡住的时间
+        std::lock_guard<StatsMutex> lock(_mtx);
+        // 之后的修改写入新日志，子进程成功后再删除旧日志
+        if (_wal.is_open() && !_wal.rotate()) {
+            std::cout << "background_save failed: " << _wal.error() << std::endl;
+            return false;
+        }
+        pid = fork();
+        if (pid == 0) {
+            // 子进程里只有 fork 的这一个线程：不加锁，也不用 std::cout
+            std::string error;
+            if (write_snapshot(&error)) {
+                _exit(0);
+            }
+            error = "background_save failed: " + error + "\n";
+            ssize_t written = ::write(STDERR_FILENO, error.data(), error.size());
+            (void)written;
+            _exit(1);
+        }
+    }
+    if (pid < 0) {
+        std::cout << "background_save failed: fork: " << strerror(errno) << std::endl;
+        return false;
+    }
+
+    _saving = true;
+    _save_thread = std::thread([this, pid] {
+        int status = -1;
+        while (waitpid(pid, &status, 0) < 0 && errno == EINTR) {
+        }
+        if (WIFEXITED(status) && WEXITSTATUS(status) == 0) {
+            if (_wal.is_open()) {
+                _wal.drop_rotated();
+            }
+            std::cout << "background_save done" << std::endl;
+        } else {
+            // 保留轮换出的旧日志，下次保存时新日志接到它后面
+            std::cout << "background_save failed" << std::endl;
+        }
+        _saving = false;
+    });
+    return true;
 }
 
-// 从文件加载跳表内容
-template<typename K, typename V>
-void SkipList<K, V>::load_file() {
+// 从文件加载跳表内容，文件不是二进制快照时按旧的文本格式加载
+template<typename K, typename V, template<typename, typename> class Cache>
+void SkipList<K, V, Cache>::load_file() {
+    std::cout << "load_file-----------------" << std::endl;
+    if (!SnapshotReader::is_snapshot(STORE_FILE)) {
+        load_text_file();
+        return;
+    }
+
+    SnapshotReader reader;
+    if (!reader.open(STORE_FILE)) {
+        std::cout << "load_file failed: " << reader.error() << std::endl;
+        return;
+    }
+
+    // 记录按键序存放，可以一遍链接完成；保存之后已经过期的记录直接跳过
+    int64_t now = expiry_now_ms();
+    int64_t expire;
+    size_t loaded = bulk_load([&](K& k, V& v, int64_t& expire_time) {
+        while (reader.next(k, v, expire)) {
+            if (expire == 0 || expire > now) {
+                expire_time = static_cast<int64_t>(expire);
+                return true;
+            }
+        }
+        return false;
+    });
+    if (!reader.error().empty()) {
+        std::cout << "load_file stopped early: " << reader.error() << std::endl;
+    }
+    std::cout << "loaded " << loaded << " keys" << std::endl;
+}
+
+// 重放日志后以追加方式打开
+template<typename K, typename V, template<typename, typename> class Cache>
+bool SkipList<K, V, Cache>::open_wal(const std::string& path, WalSyncPolicy policy, int interval_ms) {
+    // 未完成的后台保存轮换出的旧日志在前
+    WriteBatch<K, V> logged;
+    size_t rotated_records;
+    size_t records;
+    std::string error;
+    if (!wal_replay(WriteAheadLog::rotated_path(path), logged, &rotated_records, &error) ||
+        !wal_replay(path, logged, &records, &error)) {
+        std::cout << "open_wal failed: " << error << std::endl;
+        return false;
+    }
+    records += rotated_records;
+
+    // 同一个键的操作保持日志顺序，整个日志可以作为一批应用；重放时已经过期的写入按删除处理
+    int64_t now = expiry_now_ms();
+    WriteBatch<K, V> replayed;
+    for (const typename WriteBatch<K, V>::Op& op : logged.ops()) {
+        if (op.is_delete || (op.expire_time != 0 && op.expire_time <= now)) {
+            replayed.remove(op.key);
+        } else {
+            replayed.put(op.key, op.value, op.expire_time);
+        }
+    }
+    if (!replayed.empty()) {
+        std::lock_guard<StatsMutex> lock(_mtx);
+        apply_batch(replayed, replayed.sorted_order());
+    }
+    std::cout << "replayed " << records << " log records" << std::endl;
+
+    if (!_wal.open(path, policy, interval_ms)) {
+        std::cout << "open_wal failed: " << _wal.error() << std::endl;
+        return false;
+    }
+    return true;
+}
+
+template<typename K, typename V, template<typename, typename> class Cache>
+void SkipList<K, V, Cache>::commit_wal(uint64_t seq) {
+    if (seq == 0) {
+        return;
+    }
+    StatsScope scope(_stats, STATS_WAL_COMMIT);
+    if (!_wal.commit(seq)) {
+        std::cout << "wal commit failed: " << _wal.error() << std::endl;
+    }
+}
 
+// 旧文本格式：每行 key:value 或 key:value:expire_time
+template<typename K, typename V, template<typename, typename> class Cache>
+void SkipList<K, V, Cache>::load_text_file() {
     _file_reader.open(STORE_FILE);
-    std::cout << "load_file-----------------" << std::endl;
     std::string line;
-    std::string* key = new std::string();
-    std::string* value = new std::string();
-    while (getline(_file_reader, line)) {
-        get_key_value_from_string(line, key, value);
-        if (key->empty() || value->empty()) {
-            continue;
+    std::string key;
+    std::string value;
+    std::string expire_time_str;
+
+    // dump_file 按第0层的键序写出，可以一遍链接完成
+    size_t loaded = bulk_load([&](K& k, V& v, int64_t& expire_time) {
+        while (getline(_file_reader, line)) {
+            if (!is_valid_string(line)) {
+                continue;
+            }
+            get_key_value_from_string(line, &key, &value, &expire_time_str);
+            // 只有一个分隔符时没有过期时间字段；最后一段不是完整的整数时是旧版 dump_file 写出的 key:value，
+            // 值本身带分隔符（如 2:http://x），按第一个分隔符切分，不过期
+            expire_time = 0;
+            if (line.find(delimiter) != line.rfind(delimiter)) {
+                char* end = nullptr;
+                errno = 0;
+                long long seconds = strtoll(expire_time_str.c_str(), &end, 10);
+                if (!expire_time_str.empty() && *end == '\0' && errno == 0) {
+                    expire_time = seconds * 1000; // 文本格式的过期时间以秒为单位
+                } else {
+                    value = line.substr(line.find(delimiter) + 1);
+                }
+            }
+            if (key.empty() || value.empty()) {
+                continue;
+            }
+            if (!snapshot_parse_text(key, k) || !snapshot_parse_text(value, v)) {
+                continue;
+            }
+            return true;
         }
-        // Define key as int type
-        insert_element(stoi(*key), *value);
-        std::cout << "key:" << *key << "value:" << *value << std::endl;
-    }
-    delete key;
-    delete value;
+        return false;
+    });
+    std::cout << "loaded " << loaded << " keys from text dump" << std::endl;
     _file_reader.close();
 }
 
 // 从字符串解析键值对和过期时间
-template<typename K, typename V>
-void SkipList<K, V>::get_key_value_from_string(const std::string& str, std::string* key, std::string* value, std::string* expire_time_str) {
+template<typename K, typename V, template<typename, typename> class Cache>
+void SkipList<K, V, Cache>::get_key_value_from_string(const std::string& str, std::string* key, std::string* value, std::string* expire_time_str) {
     if (!is_valid_string(str)) {
         return;
     }
@@ -501,8 +1481,8 @@ void SkipList<K, V>::get_key_value_from_string(const std::string& str, std::stri
 }
 
 // 检查字符串是否有效
-template<typename K, typename V>
-bool SkipList<K, V>::is_valid_string(const std::string& str) {
+template<typename K, typename V, template<typename, typename> class Cache>
+bool SkipList<K, V, Cache>::is_valid_string(const std::string& str) {
     if (str.empty()) {
         return false;
     }
@@ -513,7 +1493,183 @@ bool SkipList<K, V>::is_valid_string(const std::string& str) {
 }
 
 // 清理过期元素
-template<typename K, typename V>
-void SkipList<K, V>::evict_expired_items() {
-    _lru_cache->evict_expired_items();
+template<typename K, typename V, template<typename, typename> class Cache>
+void SkipList<K, V, Cache>::evict_expired_items() {
+    StatsScope scope(_stats, STATS_EXPIRE);
+    std::lock_guard<StatsMutex> lock(_mtx);
+    reclaim_expired(expiry_now_ms());
+}
+
+// 每批持锁处理 ACTIVE_EXPIRE_BATCH 个到期键，批与批之间其他线程可以拿到锁。
+// 上一批取出的键处理完后才推进过期索引；大量键同时到期时排序可能要几十毫秒，放在锁外做
+template<typename K, typename V, template<typename, typename> class Cache>
+size_t SkipList<K, V, Cache>::active_expire_cycle(long budget_us) {
+    StatsScope scope(_stats, STATS_EXPIRE);
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::microseconds(budget_us);
+    size_t removed = 0;
+    do {
+        std::vector<K> due;
+        {
+            std::lock_guard<StatsMutex> lock(_mtx);
+            int64_t now = expiry_now_ms();
+            if (_expire_next < _expire_backlog.size()) {
+                removed += reclaim_expired(now, ACTIVE_EXPIRE_BATCH);
+                continue;
+            }
+            _expiry.advance(now, [&due](const K& key, int64_t) { due.push_back(key); });
+            if (due.empty()) {
+                break; // 到期的键都处理完了
+            }
+        }
+        std::sort(due.begin(), due.end());
+        std::lock_guard<StatsMutex> lock(_mtx);
+        if (_expire_next == _expire_backlog.size()) {
+            _expire_backlog.swap(due);
+            _expire_next = 0;
+        } else {
+            // 放锁期间 evict_expired_items 又取出了一批，合并成一个有序列表
+            _expire_backlog.erase(_expire_backlog.begin(), _expire_backlog.begin() + _expire_next);
+            _expire_next = 0;
+            size_t middle = _expire_backlog.size();
+            _expire_backlog.insert(_expire_backlog.end(), due.begin(), due.end());
+            std::inplace_merge(_expire_backlog.begin(), _expire_backlog.begin() + middle, _expire_backlog.end());
+        }
+    } while (std::chrono::steady_clock::now() < deadline);
+    return removed;
+}
+
+// 过期索引只增不删，键被删除或改了过期时间后留下的失效记录在到期时丢弃；失效记录过多时重建
+template<typename K, typename V, template<typename, typename> class Cache>
+void SkipList<K, V, Cache>::track_expiry(const K& key, int64_t expire_time) {
+    if (expire_time == 0) {
+        return;
+    }
+    _expiry.add(key, expire_time);
+    if (_expiry.size() > 2 * static_cast<size_t>(_element_count) + EXPIRY_REBUILD_MIN) {
+        rebuild_expiry_index();
+    }
+}
+
+// 先处理上次没处理完的到期键，处理完后再从过期索引取出新到期的键，排好序接着处理
+template<typename K, typename V, template<typename, typename> class Cache>
+size_t SkipList<K, V, Cache>::reclaim_expired(int64_t now, size_t limit) {
+    size_t removed = 0;
+    bool refilled = false;
+    while (limit > 0) {
+        if (_expire_next == _expire_backlog.size()) {
+            if (refilled) {
+                break;
+            }
+            _expire_backlog.clear();
+            _expire_next = 0;
+            _expiry.advance(now, [this](const K& key, int64_t) { _expire_backlog.push_back(key); });
+            std::sort(_expire_backlog.begin(), _expire_backlog.end());
+            refilled = true;
+            continue;
+        }
+        size_t count = std::min(limit, _expire_backlog.size() - _expire_next);
+        removed += remove_expired(_expire_backlog.data() + _expire_next, count, now);
+        _expire_next += count;
+        limit -= count;
+    }
+    return removed;
+}
+
+// 有序的键用 finger search 逐个定位，节点当前的过期时间确实已到才删除（键可能已删除、重复或改了过期时间）
+template<typename K, typename V, template<typename, typename> class Cache>
+size_t SkipList<K, V, Cache>::remove_expired(const K* keys, size_t count, int64_t now) {
+    size_t removed = 0;
+    std::vector<Node<K, V>*> update(_level_limit + 1, _header);
+    for (size_t i = 0; i < count; i++) {
+        Node<K, V>* current = finger_seek(keys[i], update.data());
+        if (current == NULL || current->get_key() != keys[i] ||
+            current->get_expire_time() == 0 || current->get_expire_time() > now) {
+            continue;
+        }
+        remove_node(current, update.data());
+        removed++;
+    }
+    _reclaimed += removed;
+    return removed;
+}
+
+// 与 delete_element 的摘除步骤相同，不打印也不写日志（重放时过期的记录本来就会丢弃）
+template<typename K, typename V, template<typename, typename> class Cache>
+void SkipList<K, V, Cache>::remove_node(Node<K, V>* node, Node<K, V>** update) {
+    for (int l = 0; l <= _skip_list_level; l++) {
+        if (update[l]->forward[l] != node)
+            break;
+        update[l]->forward[l] = node->forward[l];
+    }
+    while (_skip_list_level > 0 && _header->forward[_skip_list_level] == 0) {
+        _skip_list_level--;
+    }
+    _lru_cache->remove(node, true);
+    _level_counts[node->node_level]--;
+    destroy_node(node);
+    _element_count--;
+}
+
+// 遍历第0层，重新加入所有带过期时间的节点
+template<typename K, typename V, template<typename, typename> class Cache>
+void SkipList<K, V, Cache>::rebuild_expiry_index() {
+    _expiry.clear();
+    for (Node<K, V>* node = _header->forward[0]; node != NULL; node = node->forward[0]) {
+        if (node->get_expire_time() != 0) {
+            _expiry.add(node->get_key(), node->get_expire_time());
+        }
+    }
+}
+
+// 获取跳表大小
+template<typename K, typename V, template<typename, typename> class Cache>
+int SkipList<K, V, Cache>::size() {
+    return _element_count;
+}
+
+// 获取统计快照：持锁读取元素数、层级分布和LRU计数，延迟直方图无锁汇总
+template<typename K, typename V, template<typename, typename> class Cache>
+SkipListStats SkipList<K, V, Cache>::stats() {
+    SkipListStats snapshot;
+    {
+        std::lock_guard<StatsMutex> lock(_mtx);
+        snapshot.element_count = _element_count;
+        snapshot.skip_list_level = _skip_list_level;
+        snapshot.max_level = _max_level;
+        snapshot.level_probability = _levels.probability();
+        snapshot.level_histogram.assign(_level_counts.begin(), _level_counts.begin() + _max_level + 1);
+        snapshot.lru_evictions = _lru_cache->eviction_count();
+        snapshot.lru_expired = _lru_cache->expired_count();
+        snapshot.expired_reclaimed = _reclaimed;
+    }
+    _stats.collect(snapshot);
+    return snapshot;
+}
+
+// 内存统计：持共享锁遍历第0层，按节点累加，耗时与元素数成正比
+template<typename K, typename V, template<typename, typename> class Cache>
+MemoryUsage SkipList<K, V, Cache>::memory_usage() {
+    MemoryUsage usage;
+    std::shared_lock<StatsMutex> lock(_mtx);
+    for (Node<K, V>* node = _header; node != nullptr; node = node->forward[0]) {
+        size_t tower = sizeof(Node<K, V>*) * node->node_level;
+        size_t value = heap_bytes(node->get_value());
+        size_t bytes = node->memory_bytes();
+        usage.nodes += sizeof(Node<K, V>);
+        usage.towers += tower;
+        usage.values += value;
+        usage.keys += bytes - sizeof(Node<K, V>) - tower - value;
+        if (node != _header && _lru_cache->cached(node)) {
+            usage.cache += bytes;
+        }
+    }
+    usage.cache_overhead = _lru_cache->overhead_bytes();
+    usage.arena_reserved = _arena.reserved_bytes();
+    return usage;
+}
+
+// 把统计快照以 Prometheus 文本格式写入文件
+template<typename K, typename V, template<typename, typename> class Cache>
+bool SkipList<K, V, Cache>::dump_stats(const std::string& path) {
+    return stats().dump_prometheus(path);
 }
@@ -0,0 +1,762 @@
+#ifndef ASYNC_IO_H
+#define ASYNC_IO_H
+
+#include <cerrno>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+
+#if defined(__linux__) && __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#define SKIPLIST_HAVE_IO_URING 1
+#else
+#define SKIPLIST_HAVE_IO_URING 0
+#endif
+
+// 快照和日志的文件 I/O 后端。
+//
+//   IO_BACKEND_URING   io_uring：写入先拷贝到一组预先注册（IORING_REGISTER_BUFFERS）的缓冲区，写满一个就排入提交队列，
+//                      攒够半组才调用一次 io_uring_enter 批量提交；调用方在内核写盘的同时继续编码下一个缓冲区，
+//                      只在缓冲区都在途时才等待完成。fsync 也作为请求提交（IOSQE_IO_DRAIN，排在所有写之后执行），
+//                      和最后几个写在同一次 io_uring_enter 中提交
+//   IO_BACKEND_PWRITE  同样的缓冲区，写满一个就在当前线程 pwrite，最后 fsync；内核不支持 io_uring 或编译环境没有头文件时使用
+//   IO_BACKEND_AUTO    O_DIRECT 时能用 io_uring 就用，否则 pwrite。缓冲写很快被页缓存吸收，io_uring 在 io_bench 中
+//                      与 pwrite 持平或略慢；O_DIRECT 的写要等设备完成，多个写同时在途才有明显收益
+//
+// direct 打开 O_DIRECT，写入绕过页缓存，不会把页缓存里的热数据挤出去；缓冲区按 IO_DIRECT_ALIGNMENT 对齐，
+// 最后不满一个对齐单位的部分补 0 写出后再 ftruncate 回实际长度。文件系统不支持 O_DIRECT（如 tmpfs）时退回普通写。
+//
+// 读取（SnapshotReader）：AUTO 且不 direct 时仍然 mmap，否则按同样的规则用多个并发的读请求（io_uring）或逐块 pread
+// 把整个文件读入内存。
+// 预写日志只用 io_uring 把一次 group commit 的 write 和 fdatasync 链接成一次提交，不使用 O_DIRECT（记录长度不对齐）。
+//
+// 默认后端可以在编译时用 -DSKIPLIST_IO_BACKEND=IO_BACKEND_PWRITE、-DSKIPLIST_IO_DIRECT=true 指定，
+// 单个写入器用 set_io_options 指定。
+
+#define IO_BUFFER_SIZE (1 << 20) // 每个缓冲区的大小，也是每个写请求的大小
+#define IO_QUEUE_DEPTH 8 // 缓冲区个数，即同时在途的写请求数
+#define IO_DIRECT_ALIGNMENT 4096
+
+enum IoBackend {
+    IO_BACKEND_AUTO,
+    IO_BACKEND_URING,
+    IO_BACKEND_PWRITE
+};
+
+#ifndef SKIPLIST_IO_BACKEND
+#define SKIPLIST_IO_BACKEND IO_BACKEND_AUTO
+#endif
+
+#ifndef SKIPLIST_IO_DIRECT
+#define SKIPLIST_IO_DIRECT false
+#endif
+
+struct IoOptions {
+    IoBackend backend = SKIPLIST_IO_BACKEND;
+    bool direct = SKIPLIST_IO_DIRECT;
+    size_t buffer_size = IO_BUFFER_SIZE;
+    unsigned queue_depth = IO_QUEUE_DEPTH;
+};
+
+inline const char* io_backend_name(IoBackend backend) {
+    switch (backend) {
+    case IO_BACKEND_URING:
+        return "io_uring";
+    case IO_BACKEND_PWRITE:
+        return "pwrite";
+    default:
+        return "auto";
+    }
+}
+
+inline size_t io_align_up(size_t n) {
+    return (n + IO_DIRECT_ALIGNMENT - 1) / IO_DIRECT_ALIGNMENT * IO_DIRECT_ALIGNMENT;
+}
+
+// O_DIRECT 打开失败（EINVAL）时去掉 O_DIRECT 重试，direct 改为 false
+inline int io_open(const std::string& path, int flags, bool& direct) {
+    if (direct) {
+        int fd = ::open(path.c_str(), flags | O_DIRECT, 0644);
+        if (fd >= 0 || errno != EINVAL) {
+            return fd;
+        }
+        direct = false;
+    }
+    return ::open(path.c_str(), flags, 0644);
+}
+
+#if SKIPLIST_HAVE_IO_URING
+
+// 直接用系统调用操作的 io_uring（不依赖 liburing），只供一个线程使用
+class IoRing {
+public:
+    IoRing()
+        : _fd(-1), _sq_ring(nullptr), _sq_ring_size(0), _cq_ring(nullptr), _cq_ring_size(0), _sqes(nullptr),
+          _sqes_size(0), _sq_entries(0), _sq_local_tail(0), _sq_pending(0), _features(0) {}
+
+    ~IoRing() { close(); }
+
+    IoRing(const IoRing&) = delete;
+    IoRing& operator=(const IoRing&) = delete;
+
+    bool init(unsigned entries, std::string* error); // 创建队列，entries 为提交队列长度
+
+    void close();
+
+    bool is_open() const { return _fd >= 0; }
+
+    bool register_buffers(const iovec* buffers, unsigned count); // 注册后可用 IORING_OP_WRITE_FIXED
+
+    io_uring_sqe* next_sqe(); // 取一个清零的提交项，队列满时返回 nullptr
+
+    unsigned pending() const { return _sq_pending; } // 已填写还没提交的个数
+
+    int enter(unsigned wait_for); // 提交所有已填写的请求，并等待至少 wait_for 个完成；成功返回 0，失败返回 -errno
+
+    bool reap(uint64_t& user_data, int32_t& result); // 取一个完成事件，没有时返回 false
+
+    static bool supported(); // 内核是否支持本文件用到的操作，进程内只探测一次
+
+private:
+    int _fd;
+    void* _sq_ring;
+    size_t _sq_ring_size;
+    void* _cq_ring;
+    size_t _cq_ring_size;
+    io_uring_sqe* _sqes;
+    size_t _sqes_size;
+    unsigned* _sq_head;
+    unsigned* _sq_tail;
+    unsigned* _sq_mask;
+    unsigned* _sq_array;
+    unsigned* _cq_head;
+    unsigned* _cq_tail;
+    unsigned* _cq_mask;
+    io_uring_cqe* _cqes;
+    unsigned _sq_entries;
+    unsigned _sq_local_tail; // 填写到的位置，enter 时才发布给内核
+    unsigned _sq_pending;
+    unsigned _features;
+};
+
+inline bool IoRing::init(unsigned entries, std::string* error) {
+    io_uring_params params;
+    memset(&params, 0, sizeof(params));
+    _fd = static_cast<int>(syscall(__NR_io_uring_setup, entries, &params));
+    if (_fd < 0) {
+        *error = std::string("io_uring_setup: ") + strerror(errno);
+        return false;
+    }
+    _features = params.features;
+    _sq_entries = params.sq_entries;
+    _sq_ring_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    _cq_ring_size = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+    bool single_mmap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+    if (single_mmap) {
+        _sq_ring_size = _cq_ring_size = _sq_ring_size > _cq_ring_size ? _sq_ring_size : _cq_ring_size;
+    }
+    _sq_ring = mmap(nullptr, _sq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, _fd, IORING_OFF_SQ_RING);
+    if (_sq_ring == MAP_FAILED) {
+        _sq_ring = nullptr;
+        *error = std::string("mmap io_uring: ") + strerror(errno);
+        close();
+        return false;
+    }
+    if (single_mmap) {
+        _cq_ring = _sq_ring;
+    } else {
+        _cq_ring = mmap(nullptr, _cq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, _fd,
+                        IORING_OFF_CQ_RING);
+        if (_cq_ring == MAP_FAILED) {
+            _cq_ring = nullptr;
+            *error = std::string("mmap io_uring: ") + strerror(errno);
+            close();
+            return false;
+        }
+    }
+    _sqes_size = params.sq_entries * sizeof(io_uring_sqe);
+    void* sqes = mmap(nullptr, _sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, _fd, IORING_OFF_SQES);
+    if (sqes == MAP_FAILED) {
+        *error = std::string("mmap io_uring: ") + strerror(errno);
+        close();
+        return false;
+    }
+    _sqes = static_cast<io_uring_sqe*>(sqes);
+
+    char* sq = static_cast<char*>(_sq_ring);
+    char* cq = static_cast<char*>(_cq_ring);
+    _sq_head = reinterpret_cast<unsigned*>(sq + params.sq_off.head);
+    _sq_tail = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+    _sq_mask = reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+    _sq_array = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+    _cq_head = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+    _cq_tail = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+    _cq_mask = reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+    _cqes = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+    _sq_local_tail = *_sq_tail;
+    _sq_pending = 0;
+    return true;
+}
+
+inline void IoRing::close() {
+    if (_sqes != nullptr) {
+        munmap(_sqes, _sqes_size);
+        _sqes = nullptr;
+    }
+    if (_cq_ring != nullptr && _cq_ring != _sq_ring) {
+        munmap(_cq_ring, _cq_ring_size);
+    }
+    _cq_ring = nullptr;
+    if (_sq_ring != nullptr) {
+        munmap(_sq_ring, _sq_ring_size);
+        _sq_ring = nullptr;
+    }
+    if (_fd >= 0) {
+        ::close(_fd); // 在途的请求由内核完成后释放
+        _fd = -1;
+    }
+}
+
+inline bool IoRing::register_buffers(const iovec* buffers, unsigned count) {
+    return syscall(__NR_io_uring_register, _fd, IORING_REGISTER_BUFFERS, buffers, count) == 0;
+}
+
+inline io_uring_sqe* IoRing::next_sqe() {
+    unsigned head = __atomic_load_n(_sq_head, __ATOMIC_ACQUIRE);
+    if (_sq_local_tail - head >= _sq_entries) {
+        return nullptr;
+    }
+    unsigned index = _sq_local_tail & *_sq_mask;
+    io_uring_sqe* sqe = &_sqes[index];
+    memset(sqe, 0, sizeof(*sqe));
+    _sq_array[index] = index;
+    _sq_local_tail++;
+    _sq_pending++;
+    return sqe;
+}
+
+inline int IoRing::enter(unsigned wait_for) {
+    __atomic_store_n(_sq_tail, _sq_local_tail, __ATOMIC_RELEASE);
+    while (_sq_pending > 0 || wait_for > 0) {
+        unsigned flags = wait_for > 0 ? IORING_ENTER_GETEVENTS : 0;
+        long submitted = syscall(__NR_io_uring_enter, _fd, _sq_pending, wait_for, flags, nullptr, 0);
+        if (submitted < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return -errno;
+        }
+        if (submitted == 0 && _sq_pending > 0) {
+            return -EBUSY;
+        }
+        _sq_pending -= static_cast<unsigned>(submitted);
+        if (_sq_pending == 0) {
+            break; // 完成事件留在完成队列中，再次 enter 时 wait_for 会立即满足
+        }
+    }
+    return 0;
+}
+
+inline bool IoRing::reap(uint64_t& user_data, int32_t& result) {
+    unsigned head = *_cq_head;
+    if (head == __atomic_load_n(_cq_tail, __ATOMIC_ACQUIRE)) {
+        return false;
+    }
+    const io_uring_cqe& cqe = _cqes[head & *_cq_mask];
+    user_data = cqe.user_data;
+    result = cqe.res;
+    __atomic_store_n(_cq_head, head + 1, __ATOMIC_RELEASE);
+    return true;
+}
+
+inline bool IoRing::supported() {
+    static const bool result = [] {
+        IoRing ring;
+        std::string error;
+        // IORING_OP_READ/WRITE 和 IORING_FEAT_RW_CUR_POS 同在 5.6 加入
+        return ring.init(2, &error) && (ring._features & IORING_FEAT_RW_CUR_POS) != 0;
+    }();
+    return result;
+}
+
+#endif // SKIPLIST_HAVE_IO_URING
+
+// 把 AUTO 解析为实际使用的后端，内核不支持 io_uring 时总是 pwrite
+inline IoBackend io_resolve_backend(IoBackend backend, bool direct) {
+#if SKIPLIST_HAVE_IO_URING
+    if ((backend == IO_BACKEND_URING || (backend == IO_BACKEND_AUTO && direct)) && IoRing::supported()) {
+        return IO_BACKEND_URING;
+    }
+#endif
+    (void)backend;
+    (void)direct;
+    return IO_BACKEND_PWRITE;
+}
+
+// 顺序写一个新文件：open、多次 write、close。write 只把数据拷进缓冲区，缓冲区写满才交给内核，
+// 所以 write 返回时数据不一定已写出，出错可能在之后的 write 或 close 时才报告
+class AsyncFileWriter {
+public:
+    AsyncFileWriter();
+
+    ~AsyncFileWriter(); // 没有 close 时等在途的写完成后关闭文件，不 fsync
+
+    AsyncFileWriter(const AsyncFileWriter&) = delete;
+    AsyncFileWriter& operator=(const AsyncFileWriter&) = delete;
+
+    bool open(const std::string& path, const IoOptions& options = IoOptions()); // 创建或截断 path
+
+    bool write(const char* data, size_t len);
+
+    bool close(bool sync = true); // 写出剩余的数据，sync 时 fsync，然后关闭文件
+
+    bool is_open() const { return _fd >= 0; }
+
+    const std::string& error() const { return _error; }
+
+    IoBackend backend() const { return _backend; } // 实际使用的后端
+
+    bool direct() const { return _direct; } // 是否实际使用了 O_DIRECT
+
+    uint64_t size() const { return _size; }
+
+    uint64_t submit_calls() const { return _calls; } // io_uring_enter 或 pwrite/fsync 的调用次数
+
+private:
+    struct Buffer {
+        char* data = nullptr;
+        size_t used = 0; // 已填入的字节数
+        size_t length = 0; // 提交时的写入长度（direct 时末尾补齐）
+        uint64_t offset = 0; // 提交时在文件中的偏移
+    };
+
+    bool fail(const std::string& what, int err);
+
+    bool acquire_buffer(); // 取一个空闲缓冲区作为当前缓冲区，都在途时等待完成
+
+    bool submit_current(); // 当前缓冲区交给内核（pwrite 后端直接写出）
+
+    bool pwrite_all(const char* data, size_t len, uint64_t offset);
+
+    bool wait_for_writes(unsigned count); // 等待 count 个写完成并回收缓冲区
+
+    bool complete_write(unsigned index, int32_t result); // 处理一个写的完成事件并回收缓冲区
+
+    void release();
+
+    int _fd;
+    std::string _path;
+    IoOptions _options;
+    IoBackend _backend;
+    bool _direct;
+    std::vector<Buffer> _buffers;
+    std::vector<unsigned> _free; // 空闲缓冲区下标
+    int _current; // 正在填充的缓冲区，-1 表示没有
+    uint64_t _offset; // 下一个提交的写在文件中的偏移
+    uint64_t _size; // 调用方写入的字节数
+    unsigned _inflight; // 已提交还没完成的写
+    uint64_t _calls;
+    bool _rewritten; // 有短写的剩余部分是同步补写的，io_uring 的 fsync 可能没有覆盖它
+    std::string _error;
+#if SKIPLIST_HAVE_IO_URING
+    IoRing _ring;
+    bool _registered; // 缓冲区是否注册成功（内存锁定上限不够时不注册，用普通的 IORING_OP_WRITE）
+#endif
+};
+
+#define IO_FSYNC_TAG UINT64_MAX // fsync 请求的 user_data，写请求的 user_data 为缓冲区下标
+
+inline AsyncFileWriter::AsyncFileWriter()
+    : _fd(-1), _backend(IO_BACKEND_PWRITE), _direct(false), _current(-1), _offset(0), _size(0), _inflight(0), _calls(0),
+      _rewritten(false)
+#if SKIPLIST_HAVE_IO_URING
+    , _registered(false)
+#endif
+{}
+
+inline AsyncFileWriter::~AsyncFileWriter() {
+    if (_fd >= 0) {
+        wait_for_writes(_inflight); // 内核可能还在读缓冲区，先等它们完成
+        ::close(_fd);
+    }
+    release();
+}
+
+inline void AsyncFileWriter::release() {
+#if SKIPLIST_HAVE_IO_URING
+    _ring.close();
+#endif
+    for (Buffer& buffer : _buffers) {
+        free(buffer.data);
+    }
+    _buffers.clear();
+    _free.clear();
+}
+
+inline bool AsyncFileWriter::fail(const std::string& what, int err) {
+    if (_error.empty()) {
+        _error = what + " " + _path + ": " + strerror(err);
+    }
+    return false;
+}
+
+inline bool AsyncFileWriter::open(const std::string& path, const IoOptions& options) {
+    _path = path;
+    _options = options;
+    _options.buffer_size = io_align_up(options.buffer_size > 0 ? options.buffer_size : IO_BUFFER_SIZE);
+    _options.queue_depth = options.queue_depth > 0 ? options.queue_depth : 1;
+    _backend = io_resolve_backend(options.backend, options.direct);
+    _direct = options.direct;
+    _fd = io_open(path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, _direct);
+    if (_fd < 0) {
+        return fail("open", errno);
+    }
+
+    // pwrite 后端同一时刻只有一个缓冲区在用
+    unsigned count = _backend == IO_BACKEND_URING ? _options.queue_depth : 1;
+    _buffers.resize(count);
+    for (unsigned i = 0; i < count; i++) {
+        void* data = nullptr;
+        if (posix_memalign(&data, IO_DIRECT_ALIGNMENT, _options.buffer_size) != 0) {
+            return fail("allocate buffers for", ENOMEM);
+        }
+        _buffers[i].data = static_cast<char*>(data);
+        _free.push_back(count - 1 - i);
+    }
+
+#if SKIPLIST_HAVE_IO_URING
+    if (_backend == IO_BACKEND_URING) {
+        std::string error;
+        if (!_ring.init(count + 1, &error)) { // 多一项给 fsync；创建失败（如资源不足）时退回 pwrite
+            _backend = IO_BACKEND_PWRITE;
+            return true;
+        }
+        std::vector<iovec> iovecs(count);
+        for (unsigned i = 0; i < count; i++) {
+            iovecs[i].iov_base = _buffers[i].data;
+            iovecs[i].iov_len = _options.buffer_size;
+        }
+        _registered = _ring.register_buffers(iovecs.data(), count);
+    }
+#endif
+    return true;
+}
+
+inline bool AsyncFileWriter::write(const char* data, size_t len) {
+    if (_fd < 0 || !_error.empty()) {
+        return false;
+    }
+    _size += len;
+    while (len > 0) {
+        if (_current < 0 && !acquire_buffer()) {
+            return false;
+        }
+        Buffer& buffer = _buffers[_current];
+        size_t n = _options.buffer_size - buffer.used;
+        if (n > len) {
+            n = len;
+        }
+        memcpy(buffer.data + buffer.used, data, n);
+        buffer.used += n;
+        data += n;
+        len -= n;
+        if (buffer.used == _options.buffer_size && !submit_current()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+inline bool AsyncFileWriter::acquire_buffer() {
+    if (_free.empty() && !wait_for_writes(1)) {
+        return false;
+    }
+    _current = static_cast<int>(_free.back());
+    _free.pop_back();
+    _buffers[_current].used = 0;
+    return true;
+}
+
+inline bool AsyncFileWriter::submit_current() {
+    Buffer& buffer = _buffers[_current];
+    buffer.offset = _offset;
+    buffer.length = buffer.used;
+    if (_direct && buffer.length % IO_DIRECT_ALIGNMENT != 0) {
+        // 只有最后一个缓冲区可能不满，补 0 到对齐长度，close 时再截回去
+        buffer.length = io_align_up(buffer.used);
+        memset(buffer.data + buffer.used, 0, buffer.length - buffer.used);
+    }
+    _offset += buffer.length;
+    unsigned index = static_cast<unsigned>(_current);
+    _current = -1;
+
+#if SKIPLIST_HAVE_IO_URING
+    if (_backend == IO_BACKEND_URING) {
+        io_uring_sqe* sqe = _ring.next_sqe(); // 提交队列比缓冲区多，总能取到
+        sqe->opcode = _registered ? IORING_OP_WRITE_FIXED : IORING_OP_WRITE;
+        sqe->fd = _fd;
+        sqe->addr = reinterpret_cast<uint64_t>(buffer.data);
+        sqe->len = static_cast<uint32_t>(buffer.length);
+        sqe->off = buffer.offset;
+        sqe->buf_index = static_cast<uint16_t>(index);
+        sqe->user_data = index;
+        _inflight++;
+        // 攒够半组再提交，一次系统调用提交多个写
+        if (_ring.pending() * 2 >= _buffers.size()) {
+            _calls++;
+            int result = _ring.enter(0);
+            if (result < 0) {
+                return fail("io_uring_enter for", -result);
+            }
+        }
+        return true;
+    }
+#endif
+    bool ok = pwrite_all(buffer.data, buffer.length, buffer.offset);
+    _free.push_back(index);
+    return ok;
+}
+
+inline bool AsyncFileWriter::pwrite_all(const char* data, size_t len, uint64_t offset) {
+    while (len > 0) {
+        _calls++;
+        ssize_t n = ::pwrite(_fd, data, len, static_cast<off_t>(offset));
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return fail("write", errno);
+        }
+        data += n;
+        len -= n;
+        offset += n;
+    }
+    return true;
+}
+
+inline bool AsyncFileWriter::wait_for_writes(unsigned count) {
+#if SKIPLIST_HAVE_IO_URING
+    bool ok = true;
+    while (count > 0 && _inflight > 0) {
+        uint64_t user_data;
+        int32_t result;
+        if (!_ring.reap(user_data, result)) {
+            _calls++;
+            int error = _ring.enter(1);
+            if (error < 0) {
+                return fail("io_uring_enter for", -error);
+            }
+            continue;
+        }
+        ok = complete_write(static_cast<unsigned>(user_data), result) && ok;
+        count--;
+    }
+    return ok;
+#else
+    (void)count;
+    return true;
+#endif
+}
+
+inline bool AsyncFileWriter::complete_write(unsigned index, int32_t result) {
+    Buffer& buffer = _buffers[index];
+    bool ok = true;
+    _inflight--;
+    if (result < 0) {
+        ok = fail("write", -result);
+    } else if (static_cast<size_t>(result) < buffer.length) {
+        // 短写（比如磁盘将满时）：剩下的部分同步写出
+        ok = pwrite_all(buffer.data + result, buffer.length - result, buffer.offset + result);
+        _rewritten = true;
+    }
+    _free.push_back(index);
+    return ok;
+}
+
+inline bool AsyncFileWriter::close(bool sync) {
+    if (_fd < 0) {
+        return false;
+    }
+    bool ok = _error.empty();
+    bool padded = false;
+    if (ok && _current >= 0) {
+        padded = _direct && _buffers[_current].used % IO_DIRECT_ALIGNMENT != 0;
+        ok = submit_current();
+    }
+
+#if SKIPLIST_HAVE_IO_URING
+    if (ok && sync && !padded && _backend == IO_BACKEND_URING) {
+        // fsync 排在所有在途的写之后执行，和还没提交的写一起提交，等全部完成
+        io_uring_sqe* sqe = _ring.next_sqe();
+        sqe->opcode = IORING_OP_FSYNC;
+        sqe->fd = _fd;
+        sqe->flags = IOSQE_IO_DRAIN;
+        sqe->user_data = IO_FSYNC_TAG;
+        int32_t fsync_result = 1; // 1 表示还没完成
+        while (fsync_result > 0 || _inflight > 0) {
+            uint64_t user_data;
+            int32_t result;
+            if (!_ring.reap(user_data, result)) {
+                _calls++;
+                int error = _ring.enter(1);
+                if (error < 0) {
+                    ok = fail("io_uring_enter for", -error);
+                    break;
+                }
+                continue;
+            }
+            if (user_data == IO_FSYNC_TAG) {
+                fsync_result = result;
+            } else {
+                ok = complete_write(static_cast<unsigned>(user_data), result) && ok;
+            }
+        }
+        if (ok && fsync_result < 0) {
+            ok = fail("fsync", -fsync_result);
+        }
+        sync = _rewritten; // 补写发生在 fsync 之后时再同步一次
+    }
+#endif
+    ok = wait_for_writes(_inflight) && ok;
+    if (ok && padded && ftruncate(_fd, static_cast<off_t>(_size)) != 0) {
+        ok = fail("truncate", errno);
+    }
+    if (ok && sync) {
+        _calls++;
+        if (::fsync(_fd) != 0) {
+            ok = fail("fsync", errno);
+        }
+    }
+    ::close(_fd);
+    _fd = -1;
+    release();
+    return ok;
+}
+
+// 把整个文件读入对齐分配的内存（用 free 释放），尾部补 0 到对齐长度。
+// URING 时保持 queue_depth 个 buffer_size 大小的读请求在途；其他后端逐块 pread
+inline bool io_read_file(const std::string& path, const IoOptions& options, char*& data, size_t& size,
+                         std::string* error) {
+    data = nullptr;
+    size = 0;
+    bool direct = options.direct;
+    int fd = io_open(path, O_RDONLY | O_CLOEXEC, direct);
+    if (fd < 0) {
+        *error = "open " + path + ": " + strerror(errno);
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        *error = "stat " + path + ": " + strerror(errno);
+        ::close(fd);
+        return false;
+    }
+    size = static_cast<size_t>(st.st_size);
+    size_t capacity = io_align_up(size > 0 ? size : 1);
+    void* memory = nullptr;
+    if (posix_memalign(&memory, IO_DIRECT_ALIGNMENT, capacity) != 0) {
+        *error = "out of memory reading " + path;
+        ::close(fd);
+        return false;
+    }
+    data = static_cast<char*>(memory);
+    memset(data + size, 0, capacity - size);
+    size_t chunk = io_align_up(options.buffer_size > 0 ? options.buffer_size : IO_BUFFER_SIZE);
+    if (!direct) {
+        posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+    }
+
+    bool ok = true;
+#if SKIPLIST_HAVE_IO_URING
+    IoRing ring;
+    unsigned depth = options.queue_depth > 0 ? options.queue_depth : 1;
+    if (io_resolve_backend(options.backend, options.direct) == IO_BACKEND_URING && ring.init(depth, error)) {
+        size_t next = 0; // 下一个要发出的读请求的偏移
+        unsigned inflight = 0;
+        while (ok && (next < size || inflight > 0)) {
+            while (next < size && inflight < depth) {
+                io_uring_sqe* sqe = ring.next_sqe();
+                size_t len = size - next < chunk ? io_align_up(size - next) : chunk;
+                sqe->opcode = IORING_OP_READ;
+                sqe->fd = fd;
+                sqe->addr = reinterpret_cast<uint64_t>(data + next);
+                sqe->len = static_cast<uint32_t>(len);
+                sqe->off = next;
+                sqe->user_data = next; // 长度由偏移算出
+                next += len;
+                inflight++;
+            }
+            int result = ring.enter(1);
+            if (result < 0) {
+                *error = "io_uring_enter reading " + path + ": " + strerror(-result);
+                ok = false;
+                break;
+            }
+            uint64_t user_data;
+            int32_t n;
+            while (ring.reap(user_data, n)) {
+                inflight--;
+                size_t offset = static_cast<size_t>(user_data);
+                size_t len = size - offset < chunk ? io_align_up(size - offset) : chunk;
+                if (n < 0) {
+                    *error = "read " + path + ": " + strerror(-n);
+                    ok = false;
+                } else if (static_cast<size_t>(n) < len && offset + n < size) {
+                    // 短读：剩下的部分同步读
+                    size_t done = offset + n;
+                    while (ok && done < offset + len && done < size) {
+                        ssize_t r = ::pread(fd, data + done, offset + len - done, static_cast<off_t>(done));
+                        if (r <= 0 && !(r < 0 && errno == EINTR)) {
+                            *error = "read " + path + ": " + (r < 0 ? strerror(errno) : "unexpected end of file");
+                            ok = false;
+                        }
+                        done += r > 0 ? r : 0;
+                    }
+                }
+            }
+        }
+        while (inflight > 0 && ring.enter(1) == 0) { // 出错时也要等在途的读完成，之后才能释放内存
+            uint64_t user_data;
+            int32_t n;
+            while (ring.reap(user_data, n)) {
+                inflight--;
+            }
+        }
+        ::close(fd);
+        if (!ok) {
+            free(data);
+            data = nullptr;
+        }
+        return ok;
+    }
+    error->clear();
+#endif
+    for (size_t offset = 0; ok && offset < size;) {
+        size_t len = size - offset < chunk ? io_align_up(size - offset) : chunk;
+        ssize_t n = ::pread(fd, data + offset, len, static_cast<off_t>(offset));
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            *error = "read " + path + ": " + (n < 0 ? strerror(errno) : "unexpected end of file");
+            ok = false;
+        }
+        offset += n > 0 ? n : 0;
+    }
+    ::close(fd);
+    if (!ok) {
+        free(data);
+        data = nullptr;
+    }
+    return ok;
+}
+
+#endif
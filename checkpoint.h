@@ -0,0 +1,152 @@
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <ctime>
+#include <string>
+#include <vector>
+#include <memory>
+#include <unistd.h>
+#include "snapshot_format.h"
+#include "expiry_clock.h"
+#include "write_batch.h"
+
+// 增量检查点：两次全量保存之间只写出变化过的键。
+//
+//   base          STORE_FILE，普通快照，文件头 sequence 为它包含到的检查点序号 B
+//   delta         STORE_FILE.delta.<n>，n = B+1, B+2, ... 连续编号，同样是快照格式，按键序存放
+//                 该检查点周期内改动过的键的当前值，删除的键写成删除记录（SNAPSHOT_TOMBSTONE）
+//
+// 加载时先读 base，再按编号依次应用 delta，遇到缺失的编号停止；编号不大于 B 的 delta 已合并进 base，直接删除。
+// 合并（compaction）把 base 和所有 delta 归并成新的 base（序号为最后一个 delta 的序号），
+// 只读写文件，不需要跳表的锁；新 base rename 成功后才删除旧的 delta，中途崩溃也能按上面的规则正确加载。
+
+inline std::string checkpoint_delta_path(const std::string& base, uint32_t sequence) {
+    return base + ".delta." + std::to_string(sequence);
+}
+
+inline bool checkpoint_exists(const std::string& path) {
+    return ::access(path.c_str(), F_OK) == 0;
+}
+
+// 删除序号不大于 upto 的 delta：从 upto 往下删到第一个缺失的编号为止（upto 是全量快照的序号时本身没有 delta）
+inline void checkpoint_remove_deltas(const std::string& base, uint32_t upto) {
+    uint32_t seq = upto;
+    if (seq > 0 && !checkpoint_exists(checkpoint_delta_path(base, seq))) {
+        seq--;
+    }
+    for (; seq > 0 && checkpoint_exists(checkpoint_delta_path(base, seq)); seq--) {
+        ::unlink(checkpoint_delta_path(base, seq).c_str());
+    }
+}
+
+// 把一个 delta 读成一批写操作（put 带过期时间，删除记录为 remove），键序与文件一致
+template<typename K, typename V>
+inline bool checkpoint_read_delta(const std::string& path, WriteBatch<K, V>& batch, std::string* error) {
+    SnapshotReader reader;
+    if (!reader.open(path)) {
+        *error = reader.error();
+        return false;
+    }
+    K key;
+    V value;
+    int64_t expire;
+    while (reader.next(key, value, expire)) {
+        if (expire == SNAPSHOT_TOMBSTONE) {
+            batch.remove(key);
+        } else {
+            batch.put(key, value, expire);
+        }
+    }
+    if (!reader.error().empty()) {
+        *error = path + ": " + reader.error();
+        return false;
+    }
+    return true;
+}
+
+// 把 base 和序号 B+1..upto 的 delta 归并成新的 base，去掉删除记录和已过期的记录，成功后删除这些 delta。
+// base 不存在时视为空。返回新 base 的记录数，失败返回 -1
+template<typename K, typename V>
+inline long checkpoint_compact(const std::string& base, uint32_t upto, std::string* error) {
+    // sources[0] 为 base，之后按序号排列，同一个键以序号最大的为准
+    // SnapshotReader 持有 mmap，不能拷贝，用指针保存
+    std::vector<std::unique_ptr<SnapshotReader>> sources;
+    sources.emplace_back(new SnapshotReader());
+    uint32_t base_seq = 0;
+    if (checkpoint_exists(base)) {
+        if (!sources[0]->open(base)) {
+            *error = base + ": " + sources[0]->error();
+            return -1;
+        }
+        base_seq = sources[0]->sequence();
+    }
+    if (upto <= base_seq) {
+        return static_cast<long>(sources[0]->record_count());
+    }
+    for (uint32_t seq = base_seq + 1; seq <= upto; seq++) {
+        std::string path = checkpoint_delta_path(base, seq);
+        sources.emplace_back(new SnapshotReader());
+        if (!sources.back()->open(path)) {
+            *error = path + ": " + sources.back()->error();
+            return -1;
+        }
+    }
+
+    // 每个来源当前的记录
+    struct Head {
+        K key;
+        V value;
+        int64_t expire;
+        bool valid;
+    };
+    std::vector<Head> heads(sources.size());
+    for (size_t i = 0; i < sources.size(); i++) {
+        heads[i].valid = sources[i]->next(heads[i].key, heads[i].value, heads[i].expire);
+    }
+
+    SnapshotWriter writer;
+    bool ok = writer.open(base, upto);
+    int64_t now = expiry_now_ms();
+    while (ok) {
+        // 来源只有十几个，线性找最小键即可；键相同时取后面的来源
+        int winner = -1;
+        for (size_t i = 0; i < heads.size(); i++) {
+            if (!heads[i].valid) {
+                continue;
+            }
+            if (winner < 0 || heads[i].key < heads[winner].key || !(heads[winner].key < heads[i].key)) {
+                winner = static_cast<int>(i);
+            }
+        }
+        if (winner < 0) {
+            break;
+        }
+        Head& h = heads[winner];
+        if (h.expire != SNAPSHOT_TOMBSTONE && (h.expire == 0 || h.expire > now)) {
+            ok = writer.add(h.key, h.value, h.expire);
+        }
+        K key = h.key;
+        for (size_t i = 0; i < heads.size(); i++) {
+            if (heads[i].valid && !(key < heads[i].key) && !(heads[i].key < key)) {
+                heads[i].valid = sources[i]->next(heads[i].key, heads[i].value, heads[i].expire);
+            }
+        }
+    }
+    for (size_t i = 0; ok && i < sources.size(); i++) {
+        if (!sources[i]->error().empty()) {
+            *error = sources[i]->error();
+            return -1;
+        }
+    }
+    if (!ok || !writer.finish()) {
+        *error = writer.error();
+        return -1;
+    }
+    checkpoint_remove_deltas(base, upto);
+    return static_cast<long>(writer.record_count());
+}
+
+#endif
@@ -0,0 +1,220 @@
+#ifndef CLOCK_CACHE_H
+#define CLOCK_CACHE_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include "memory_usage.h"
+
+// 并发缓存策略（CLOCK），作为 SkipList 的第三个模板参数使用：SkipList<K, V, ClockCache>。
+//
+// 键按哈希分到 CLOCK_CACHE_SEGMENTS 个段，容量（节点数或字节数，见 memory_usage.h）平均分给各段，
+// 每段一把锁、一个环形链表和一根指针（hand）。
+// 命中只在节点上原子地置 referenced 位（Node::lru_flags），不移动链表也不加锁，
+// 所以跳表在共享锁下处理命中（见 SkipList::search_element），读多的负载不会被写锁串行化。
+// 段满时在段内淘汰：hand 顺着环走，referenced 位为 1 的节点清零后跳过（再给一次机会），为 0 的节点移出缓存；
+// 新节点插在 hand 之前，下一轮最后才被检查。
+//
+// 链表指针同样在跳表节点中（Node::lru_prev/lru_next），移出缓存只是把节点摘出链表。
+// put 可以在跳表的共享锁下并发调用（未命中后加入缓存），由段锁互斥；remove 只在跳表的写锁下调用，此时没有并发的 get
+
+#define CLOCK_CACHE_SEGMENTS 16 // 段数，2 的幂
+#define CLOCK_CACHE_SCAN_LIMIT 2 // 淘汰时 hand 最多走 段内节点数 * 这个倍数 步，之后直接淘汰 hand 所指的节点
+
+#define CLOCK_IN_CACHE 1 // lru_flags：节点在缓存中
+#define CLOCK_REFERENCED 2 // lru_flags：上次 hand 经过之后被命中过
+
+template<typename K, typename V>
+class Node;
+
+template<typename K, typename V>
+class ClockCache {
+public:
+    static const bool concurrent = true; // get 只做原子操作，可在跳表的共享锁下并发调用
+
+    explicit ClockCache(CacheCapacity capacity);
+
+    bool get(Node<K, V>* node); // 节点在缓存中时置 referenced 位并返回 true（命中），无锁
+
+    void put(Node<K, V>* node); // 把节点加入所在的段，放不下时先按 CLOCK 淘汰；比段容量还大的节点不放入；已在缓存中时同 get
+
+    void remove(Node<K, V>* node, bool expired = false); // 把节点移出缓存，expired 表示节点因过期被删除
+
+    bool cached(const Node<K, V>* node) const { return node->lru_flags.load(std::memory_order_relaxed) & CLOCK_IN_CACHE; }
+    size_t size(); // 缓存中的节点数
+    size_t used(); // 已用的容量，单位与容量相同
+    size_t overhead_bytes() const { return sizeof(*this); } // 缓存自身占用的内存
+    size_t eviction_count(); // 因容量不足被移出缓存的次数
+    size_t expired_count(); // 在缓存中时因过期被删除的次数
+
+private:
+    struct alignas(64) Segment {
+        std::mutex mtx;
+        Node<K, V>* hand = nullptr; // 环中下一个要检查的节点，段为空时为 nullptr
+        size_t count = 0;
+        size_t used = 0; // 段内节点占用的容量之和
+        size_t capacity = 0;
+        size_t evictions = 0;
+        size_t expired = 0;
+    };
+
+    Segment& segment_of(const K& key);
+    void link(Segment& segment, Node<K, V>* node); // 插在 hand 之前，调用方需持有段锁
+    void unlink(Segment& segment, Node<K, V>* node); // 调用方需持有段锁
+    void evict(Segment& segment); // 按 CLOCK 移出一个节点，调用方需持有段锁
+    size_t charge(const Node<K, V>* node) const { return _in_bytes ? node->memory_bytes() : 1; } // 节点占用的容量
+
+    bool _in_bytes; // 容量是否按字节计
+    Segment _segments[CLOCK_CACHE_SEGMENTS];
+};
+
+template<typename K, typename V>
+ClockCache<K, V>::ClockCache(CacheCapacity capacity) : _in_bytes(capacity.in_bytes) {
+    size_t total = capacity.amount;
+    for (size_t i = 0; i < CLOCK_CACHE_SEGMENTS; i++) {
+        _segments[i].capacity = total / CLOCK_CACHE_SEGMENTS + (i < total % CLOCK_CACHE_SEGMENTS ? 1 : 0);
+    }
+}
+
+template<typename K, typename V>
+typename ClockCache<K, V>::Segment& ClockCache<K, V>::segment_of(const K& key) {
+    uint64_t h = std::hash<K>()(key);
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    return _segments[h & (CLOCK_CACHE_SEGMENTS - 1)];
+}
+
+template<typename K, typename V>
+void ClockCache<K, V>::link(Segment& segment, Node<K, V>* node) {
+    if (segment.hand == nullptr) {
+        node->lru_prev = node;
+        node->lru_next = node;
+        segment.hand = node;
+    } else {
+        node->lru_prev = segment.hand->lru_prev;
+        node->lru_next = segment.hand;
+        segment.hand->lru_prev->lru_next = node;
+        segment.hand->lru_prev = node;
+    }
+    node->lru_flags.store(CLOCK_IN_CACHE, std::memory_order_relaxed);
+    segment.count++;
+    segment.used += charge(node);
+}
+
+template<typename K, typename V>
+void ClockCache<K, V>::unlink(Segment& segment, Node<K, V>* node) {
+    if (node->lru_next == node) {
+        segment.hand = nullptr;
+    } else {
+        if (segment.hand == node) {
+            segment.hand = node->lru_next;
+        }
+        node->lru_prev->lru_next = node->lru_next;
+        node->lru_next->lru_prev = node->lru_prev;
+    }
+    node->lru_prev = nullptr;
+    node->lru_next = nullptr;
+    node->lru_flags.store(0, std::memory_order_relaxed);
+    segment.count--;
+    segment.used -= charge(node);
+}
+
+template<typename K, typename V>
+void ClockCache<K, V>::evict(Segment& segment) {
+    // 并发的命中可能不停地重新置位，走满 CLOCK_CACHE_SCAN_LIMIT 圈后不再给机会
+    size_t steps = segment.count * CLOCK_CACHE_SCAN_LIMIT;
+    while (steps-- > 0 &&
+           (segment.hand->lru_flags.fetch_and(~CLOCK_REFERENCED, std::memory_order_relaxed) & CLOCK_REFERENCED)) {
+        segment.hand = segment.hand->lru_next;
+    }
+    unlink(segment, segment.hand);
+    segment.evictions++;
+}
+
+template<typename K, typename V>
+bool ClockCache<K, V>::get(Node<K, V>* node) {
+    unsigned char flags = node->lru_flags.load(std::memory_order_relaxed);
+    if (!(flags & CLOCK_IN_CACHE)) {
+        return false;
+    }
+    if (!(flags & CLOCK_REFERENCED)) {
+        node->lru_flags.fetch_or(CLOCK_REFERENCED, std::memory_order_relaxed); // 已置位时不写，避免缓存行来回传递
+    }
+    return true;
+}
+
+template<typename K, typename V>
+void ClockCache<K, V>::put(Node<K, V>* node) {
+    Segment& segment = segment_of(node->get_key());
+    std::lock_guard<std::mutex> lock(segment.mtx);
+    if (node->lru_flags.load(std::memory_order_relaxed) & CLOCK_IN_CACHE) {
+        node->lru_flags.fetch_or(CLOCK_REFERENCED, std::memory_order_relaxed); // 另一个线程刚把它加入缓存
+        return;
+    }
+    size_t size = charge(node);
+    if (size > segment.capacity) {
+        return;
+    }
+    while (segment.used + size > segment.capacity) {
+        evict(segment);
+    }
+    link(segment, node);
+}
+
+template<typename K, typename V>
+void ClockCache<K, V>::remove(Node<K, V>* node, bool expired) {
+    Segment& segment = segment_of(node->get_key());
+    std::lock_guard<std::mutex> lock(segment.mtx);
+    if (!(node->lru_flags.load(std::memory_order_relaxed) & CLOCK_IN_CACHE)) {
+        return;
+    }
+    unlink(segment, node);
+    if (expired) {
+        segment.expired++;
+    }
+}
+
+template<typename K, typename V>
+size_t ClockCache<K, V>::size() {
+    size_t total = 0;
+    for (Segment& segment : _segments) {
+        std::lock_guard<std::mutex> lock(segment.mtx);
+        total += segment.count;
+    }
+    return total;
+}
+
+template<typename K, typename V>
+size_t ClockCache<K, V>::used() {
+    size_t total = 0;
+    for (Segment& segment : _segments) {
+        std::lock_guard<std::mutex> lock(segment.mtx);
+        total += segment.used;
+    }
+    return total;
+}
+
+template<typename K, typename V>
+size_t ClockCache<K, V>::eviction_count() {
+    size_t total = 0;
+    for (Segment& segment : _segments) {
+        std::lock_guard<std::mutex> lock(segment.mtx);
+        total += segment.evictions;
+    }
+    return total;
+}
+
+template<typename K, typename V>
+size_t ClockCache<K, V>::expired_count() {
+    size_t total = 0;
+    for (Segment& segment : _segments) {
+        std::lock_guard<std::mutex> lock(segment.mtx);
+        total += segment.expired;
+    }
+    return total;
+}
+
+#endif
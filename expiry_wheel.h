@@ -0,0 +1,149 @@
+#ifndef EXPIRY_WHEEL_H
+#define EXPIRY_WHEEL_H
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+#include "expiry_clock.h"
+
+// 过期索引：分层时间轮，记录带过期时间（毫秒，见 expiry_clock.h）的键，每次推进只访问到期的记录。
+//
+//   时间按 EXPIRY_WHEEL_TICK_MS 毫秒一个刻度，过期时间向上取整到刻度，所以记录最多晚一个刻度返回、不会提前。
+//   第 L 层（L = 0..EXPIRY_WHEEL_LEVELS-1）有 64 个槽，每槽 64^L 个刻度；距当前刻度 delta 的记录放在
+//   满足 delta < 64^(L+1) 的最低一层，槽号为 (tick >> 6L) & 63。时间走到第 L 层某个槽对应的区间开头时，
+//   把该槽的记录按新的 delta 重新放到更低的层（cascade），第 0 层的槽到点时其中的记录全部到期。
+//   超出最高层范围（约 46 小时）的记录放在 overflow 中，最高层每转一个槽重新检查一次。
+//
+// 时间轮只存键和加入时的过期时间，键被删除或覆盖时不从轮中移除：到期时由调用方检查节点当前的过期时间，
+// 已失效的记录直接丢弃。失效记录过多时调用方应 clear() 后按现有节点重建。不加锁，由调用方同步。
+
+#define EXPIRY_WHEEL_BITS 6
+#define EXPIRY_WHEEL_SLOTS (1 << EXPIRY_WHEEL_BITS)
+#define EXPIRY_WHEEL_LEVELS 4
+#define EXPIRY_WHEEL_TICK_MS 10
+
+template<typename K>
+class ExpiryWheel {
+public:
+    explicit ExpiryWheel(int64_t now_ms = expiry_now_ms()) : _now(now_ms / EXPIRY_WHEEL_TICK_MS), _size(0) {}
+
+    // 记录 key 在 expire 毫秒时过期，expire 不晚于当前刻度时下次 advance 立即返回
+    void add(const K& key, int64_t expire) {
+        _size++;
+        place(Entry{key, expire});
+    }
+
+    // 推进到 now_ms，对每条到期的记录调用 due(const K&, int64_t expire)，返回到期的记录数。
+    // 时间回拨时只返回已经到期的记录；一次跳过整个轮的范围时把全部记录重新放置
+    template<typename Callback>
+    size_t advance(int64_t now_ms, Callback due) {
+        int64_t now = now_ms / EXPIRY_WHEEL_TICK_MS;
+        size_t count = drain(_due, due);
+        if (now <= _now) {
+            return count;
+        }
+        if (now - _now >= span(EXPIRY_WHEEL_LEVELS)) {
+            std::vector<Entry> all;
+            all.swap(_overflow);
+            for (int l = 0; l < EXPIRY_WHEEL_LEVELS; l++) {
+                for (int s = 0; s < EXPIRY_WHEEL_SLOTS; s++) {
+                    all.insert(all.end(), _slots[l][s].begin(), _slots[l][s].end());
+                    _slots[l][s].clear();
+                }
+            }
+            _now = now;
+            for (const Entry& e : all) {
+                place(e);
+            }
+            return count + drain(_due, due);
+        }
+        while (_now < now) {
+            _now++;
+            // 从高层到低层把进入当前区间的槽拆到低层，最后处理第 0 层的槽
+            int top = 0;
+            while (top + 1 < EXPIRY_WHEEL_LEVELS && (_now & (span(top + 1) - 1)) == 0) {
+                top++;
+            }
+            if (top == EXPIRY_WHEEL_LEVELS - 1) {
+                cascade(_overflow);
+            }
+            for (int l = top; l > 0; l--) {
+                cascade(_slots[l][slot(_now, l)]);
+            }
+            count += drain(_slots[0][slot(_now, 0)], due);
+            count += drain(_due, due); // 拆下来时恰好在 _now 到期的记录
+        }
+        return count;
+    }
+
+    // 清空所有记录，当前时间设为 now_ms
+    void clear(int64_t now_ms = expiry_now_ms()) {
+        for (int l = 0; l < EXPIRY_WHEEL_LEVELS; l++) {
+            for (int s = 0; s < EXPIRY_WHEEL_SLOTS; s++) {
+                std::vector<Entry>().swap(_slots[l][s]);
+            }
+        }
+        std::vector<Entry>().swap(_overflow);
+        std::vector<Entry>().swap(_due);
+        _now = now_ms / EXPIRY_WHEEL_TICK_MS;
+        _size = 0;
+    }
+
+    size_t size() const { return _size; } // 轮中的记录数，包括已失效的
+
+private:
+    struct Entry {
+        K key;
+        int64_t expire;
+    };
+
+    static int64_t span(int level) { return static_cast<int64_t>(1) << (EXPIRY_WHEEL_BITS * level); }
+    static int slot(int64_t t, int level) { return static_cast<int>((t >> (EXPIRY_WHEEL_BITS * level)) & (EXPIRY_WHEEL_SLOTS - 1)); }
+
+    void place(const Entry& e) {
+        int64_t tick = (e.expire + EXPIRY_WHEEL_TICK_MS - 1) / EXPIRY_WHEEL_TICK_MS;
+        int64_t delta = tick - _now;
+        if (delta <= 0) {
+            _due.push_back(e);
+            return;
+        }
+        for (int l = 0; l < EXPIRY_WHEEL_LEVELS; l++) {
+            if (delta < span(l + 1)) {
+                _slots[l][slot(tick, l)].push_back(e);
+                return;
+            }
+        }
+        _overflow.push_back(e);
+    }
+
+    void cascade(std::vector<Entry>& bucket) {
+        std::vector<Entry> moving;
+        moving.swap(bucket);
+        for (const Entry& e : moving) {
+            place(e);
+        }
+    }
+
+    template<typename Callback>
+    size_t drain(std::vector<Entry>& bucket, Callback& due) {
+        if (bucket.empty()) {
+            return 0;
+        }
+        std::vector<Entry> expired;
+        expired.swap(bucket);
+        for (const Entry& e : expired) {
+            due(e.key, e.expire);
+        }
+        _size -= expired.size();
+        return expired.size();
+    }
+
+    int64_t _now; // 已推进到的刻度，不晚于它的记录都已返回
+    size_t _size;
+    std::vector<Entry> _slots[EXPIRY_WHEEL_LEVELS][EXPIRY_WHEEL_SLOTS];
+    std::vector<Entry> _overflow; // 超出最高层范围的记录
+    std::vector<Entry> _due; // 加入时已经到期的记录
+};
+
+#endif
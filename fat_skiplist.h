@@ -0,0 +1,488 @@
+#ifndef FAT_SKIPLIST_H
+#define FAT_SKIPLIST_H
+
+#include <iostream>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <mutex>
+#include <new>
+#include <optional>
+#include <random>
+#include <type_traits>
+#include <utility>
+#include <algorithm>
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define FAT_SIMD_X86 1
+#endif
+
+// 胖节点跳表：每个节点存放一段有序的键（整数键，键数组占 FAT_NODE_KEY_BYTES 字节，即两个缓存行），
+// 跳表按节点的最小键把节点串起来。节点数只有元素数的几十分之一，层数和下降时的跳转次数相应减少；
+// 到达目标节点后在键数组内查找，用 SIMD 一次比较 8（AVX2）或 4（SSE）个键，CPU 不支持时退回标量循环。
+// 节点满时对半分裂，新节点取随机层数链接在原节点之后；删除后键数少于容量的 1/FAT_NODE_MERGE_DIVISOR 时
+// 与后继节点合并，节点为空时摘除。
+// 与 skiplist.h 的 SkipList 的 insert/search/delete 接口保持一致，一把互斥锁保护整个跳表，热路径上不做控制台输出。
+
+#define FAT_NODE_KEY_BYTES 128 // 每个节点的键数组大小，int32 键 32 个，int64 键 16 个
+#define FAT_NODE_MERGE_DIVISOR 4 // 删除后键数少于容量的 1/4 时尝试与后继节点合并
+#define FAT_NODE_ALIGN 64 // 节点按缓存行对齐，键数组从缓存行开头开始
+
+// 节点内查找使用的指令集，首次调用时按 CPU 支持的指令集确定；基准测试可以改成 FAT_SEARCH_SCALAR 做对比
+enum FatSearchMode { FAT_SEARCH_SCALAR = 0, FAT_SEARCH_SSE, FAT_SEARCH_AVX2 };
+
+inline FatSearchMode& fat_search_mode() {
+    static FatSearchMode mode = [] {
+#ifdef FAT_SIMD_X86
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx2")) {
+            return FAT_SEARCH_AVX2;
+        }
+        if (__builtin_cpu_supports("sse4.2")) {
+            return FAT_SEARCH_SSE;
+        }
+#endif
+        return FAT_SEARCH_SCALAR;
+    }();
+    return mode;
+}
+
+inline const char* fat_search_mode_name(FatSearchMode mode) {
+    return mode == FAT_SEARCH_AVX2 ? "avx2" : mode == FAT_SEARCH_SSE ? "sse" : "scalar";
+}
+
+// 键数组 keys[0, n) 中小于 key 的个数。节点中 count 之后的位置填键类型的最大值，不会被计入，
+// 所以总是比较整个数组，没有分支
+template<typename K>
+inline int fat_rank_scalar(const K* keys, int n, K key) {
+    int rank = 0;
+    for (int i = 0; i < n; i++) {
+        rank += keys[i] < key;
+    }
+    return rank;
+}
+
+#ifdef FAT_SIMD_X86
+// SIMD 版本：key 广播到整个向量，与一组键做有符号大于比较，比较掩码中 1 的个数即这组中小于 key 的键数。
+// 无符号键与 bias（符号位）异或后按有符号数比较，顺序不变；有符号键的 bias 为 0。n 为每组键数的整数倍，keys 按 32 字节对齐
+__attribute__((target("avx2,popcnt")))
+inline int fat_rank_avx2(const int32_t* keys, int n, int32_t key, int32_t bias) {
+    __m256i b = _mm256_set1_epi32(bias);
+    __m256i k = _mm256_xor_si256(_mm256_set1_epi32(key), b);
+    int rank = 0;
+    for (int i = 0; i < n; i += 8) {
+        __m256i v = _mm256_xor_si256(_mm256_load_si256(reinterpret_cast<const __m256i*>(keys + i)), b);
+        rank += __builtin_popcount(_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpgt_epi32(k, v))));
+    }
+    return rank;
+}
+
+__attribute__((target("avx2,popcnt")))
+inline int fat_rank_avx2(const int64_t* keys, int n, int64_t key, int64_t bias) {
+    __m256i b = _mm256_set1_epi64x(bias);
+    __m256i k = _mm256_xor_si256(_mm256_set1_epi64x(key), b);
+    int rank = 0;
+    for (int i = 0; i < n; i += 4) {
+        __m256i v = _mm256_xor_si256(_mm256_load_si256(reinterpret_cast<const __m256i*>(keys + i)), b);
+        rank += __builtin_popcount(_mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpgt_epi64(k, v))));
+    }
+    return rank;
+}
+
+__attribute__((target("sse4.2,popcnt")))
+inline int fat_rank_sse(const int32_t* keys, int n, int32_t key, int32_t bias) {
+    __m128i b = _mm_set1_epi32(bias);
+    __m128i k = _mm_xor_si128(_mm_set1_epi32(key), b);
+    int rank = 0;
+    for (int i = 0; i < n; i += 4) {
+        __m128i v = _mm_xor_si128(_mm_load_si128(reinterpret_cast<const __m128i*>(keys + i)), b);
+        rank += __builtin_popcount(_mm_movemask_ps(_mm_castsi128_ps(_mm_cmpgt_epi32(k, v))));
+    }
+    return rank;
+}
+
+__attribute__((target("sse4.2,popcnt")))
+inline int fat_rank_sse(const int64_t* keys, int n, int64_t key, int64_t bias) {
+    __m128i b = _mm_set1_epi64x(bias);
+    __m128i k = _mm_xor_si128(_mm_set1_epi64x(key), b);
+    int rank = 0;
+    for (int i = 0; i < n; i += 2) {
+        __m128i v = _mm_xor_si128(_mm_load_si128(reinterpret_cast<const __m128i*>(keys + i)), b);
+        rank += __builtin_popcount(_mm_movemask_pd(_mm_castsi128_pd(_mm_cmpgt_epi64(k, v))));
+    }
+    return rank;
+}
+#endif
+
+// 按 fat_search_mode() 选择实现；32 位和 64 位整数键走 SIMD，其他宽度走标量
+template<typename K>
+inline int fat_rank(const K* keys, int n, K key) {
+#ifdef FAT_SIMD_X86
+    if constexpr (sizeof(K) == 4 || sizeof(K) == 8) {
+        typedef typename std::conditional<sizeof(K) == 4, int32_t, int64_t>::type S;
+        S bias = std::is_signed<K>::value ? 0 : std::numeric_limits<S>::min();
+        const S* s = reinterpret_cast<const S*>(keys);
+        switch (fat_search_mode()) {
+            case FAT_SEARCH_AVX2:
+                return fat_rank_avx2(s, n, static_cast<S>(key), bias);
+            case FAT_SEARCH_SSE:
+                return fat_rank_sse(s, n, static_cast<S>(key), bias);
+            default:
+                break;
+        }
+    }
+#endif
+    return fat_rank_scalar(keys, n, key);
+}
+
+// 胖节点：keys[0, count) 有序，之后填最大值；values 与 keys 一一对应，查找时不访问
+template<typename K, typename V>
+struct FatNode {
+    static const int kCapacity = FAT_NODE_KEY_BYTES / sizeof(K);
+
+    explicit FatNode(int level) : count(0), node_level(level) {
+        std::fill(keys, keys + kCapacity, std::numeric_limits<K>::max());
+        memset(forward, 0, sizeof(FatNode<K, V>*) * (level + 1));
+    }
+
+    alignas(FAT_NODE_ALIGN) K keys[kCapacity];
+    V values[kCapacity];
+    int count; // 节点中的键数
+    int node_level; // 节点所在的层级
+
+    // 指向下一个节点的指针数组，必须是最后一个成员，分配时按 level + 1 个指针预留空间
+    FatNode<K, V>* forward[1];
+};
+
+template<typename K, typename V>
+class FatSkipList {
+    static_assert(std::is_integral<K>::value, "FatSkipList requires integer keys");
+
+public:
+    typedef FatNode<K, V> NodeType;
+    static const int kCapacity = NodeType::kCapacity;
+
+    FatSkipList(int max_level); // 构造函数，初始化最大层数
+
+    ~FatSkipList();
+
+    int insert_element(const K& key, const V& value); // 插入元素，返回1表示已存在，0表示插入成功
+
+    void delete_element(const K& key); // 删除元素
+
+    bool search_element(const K& key); // 查找元素
+
+    std::optional<V> get(const K& key); // 返回值的拷贝，找不到时为空
+    bool get(const K& key, V& value); // 把值写入出参
+    bool contains(const K& key); // 判断键是否存在
+
+    void display_list(); // 显示跳表内容
+
+    int size(); // 获取跳表大小
+
+    size_t node_count(); // 节点数（不含头节点），元素数 / (节点数 * kCapacity) 即节点的平均填充率
+
+private:
+    int get_random_level();
+    NodeType* create_node(int level);
+    void destroy_node(NodeType* node);
+    // 从头节点下降，update[i] 为第 i 层最小键小于 key 的最后一个节点（可以为 nullptr），返回第0层的这个节点
+    NodeType* find(const K& key, NodeType** update);
+    // 键所在的节点和下标，找不到时返回 nullptr
+    NodeType* locate(const K& key, int& index);
+    // 把 x 的后一半移到新节点，新节点链接在各层的 update[i] 之后；调用方保证 update[i] 之后的节点的最小键都大于 x 的键
+    NodeType* split(NodeType* x, NodeType** update);
+    void insert_at(NodeType* node, int index, const K& key, const V& value);
+    void erase_at(NodeType* node, int index);
+    // 把节点从各层摘除，update 为最小键小于该节点最小键的前驱
+    void unlink(NodeType* node, NodeType** update);
+
+    int _max_level;
+    int _skip_list_level;
+    NodeType* _header;
+    int _element_count;
+    size_t _node_count;
+    std::mt19937 _gen;
+    std::mutex _mtx;
+};
+
+template<typename K, typename V>
+FatSkipList<K, V>::FatSkipList(int max_level)
+    : _max_level(max_level), _skip_list_level(0), _element_count(0), _node_count(0), _gen(std::random_device()()) {
+    _header = create_node(_max_level);
+}
+
+template<typename K, typename V>
+FatSkipList<K, V>::~FatSkipList() {
+    NodeType* node = _header->forward[0];
+    while (node != nullptr) {
+        NodeType* next = node->forward[0];
+        destroy_node(node);
+        node = next;
+    }
+    destroy_node(_header);
+}
+
+template<typename K, typename V>
+int FatSkipList<K, V>::get_random_level() {
+    int k = 1;
+    while (_gen() % 2) {
+        k++;
+    }
+    return k < _max_level ? k : _max_level;
+}
+
+template<typename K, typename V>
+typename FatSkipList<K, V>::NodeType* FatSkipList<K, V>::create_node(int level) {
+    size_t bytes = sizeof(NodeType) + sizeof(NodeType*) * level;
+    void* memory = ::operator new(bytes, std::align_val_t(FAT_NODE_ALIGN));
+    return new (memory) NodeType(level);
+}
+
+template<typename K, typename V>
+void FatSkipList<K, V>::destroy_node(NodeType* node) {
+    node->~NodeType();
+    ::operator delete(node, std::align_val_t(FAT_NODE_ALIGN));
+}
+
+template<typename K, typename V>
+typename FatSkipList<K, V>::NodeType* FatSkipList<K, V>::find(const K& key, NodeType** update) {
+    NodeType* current = _header;
+    for (int i = _skip_list_level; i >= 0; i--) {
+        while (current->forward[i] != nullptr && current->forward[i]->keys[0] < key) {
+            current = current->forward[i];
+        }
+        if (update != nullptr) {
+            update[i] = current;
+        }
+    }
+    return current;
+}
+
+template<typename K, typename V>
+typename FatSkipList<K, V>::NodeType* FatSkipList<K, V>::locate(const K& key, int& index) {
+    NodeType* current = find(key, nullptr);
+    NodeType* next = current->forward[0];
+    if (next != nullptr && next->keys[0] == key) {
+        index = 0;
+        return next;
+    }
+    if (current == _header) {
+        return nullptr;
+    }
+    index = fat_rank(current->keys, kCapacity, key);
+    if (index < current->count && current->keys[index] == key) {
+        return current;
+    }
+    return nullptr;
+}
+
+template<typename K, typename V>
+typename FatSkipList<K, V>::NodeType* FatSkipList<K, V>::split(NodeType* x, NodeType** update) {
+    int level = get_random_level();
+    NodeType* right = create_node(level);
+    int half = kCapacity / 2;
+    std::copy(x->keys + half, x->keys + kCapacity, right->keys);
+    std::move(x->values + half, x->values + kCapacity, right->values);
+    std::fill(x->keys + half, x->keys + kCapacity, std::numeric_limits<K>::max());
+    right->count = kCapacity - half;
+    x->count = half;
+
+    if (level > _skip_list_level) {
+        for (int i = _skip_list_level + 1; i <= level; i++) {
+            update[i] = _header;
+        }
+        _skip_list_level = level;
+    }
+    for (int i = 0; i <= level; i++) {
+        right->forward[i] = update[i]->forward[i];
+        update[i]->forward[i] = right;
+    }
+    _node_count++;
+    return right;
+}
+
+template<typename K, typename V>
+void FatSkipList<K, V>::insert_at(NodeType* node, int index, const K& key, const V& value) {
+    memmove(node->keys + index + 1, node->keys + index, sizeof(K) * (node->count - index));
+    std::move_backward(node->values + index, node->values + node->count, node->values + node->count + 1);
+    node->keys[index] = key;
+    node->values[index] = value;
+    node->count++;
+}
+
+template<typename K, typename V>
+void FatSkipList<K, V>::erase_at(NodeType* node, int index) {
+    memmove(node->keys + index, node->keys + index + 1, sizeof(K) * (node->count - index - 1));
+    std::move(node->values + index + 1, node->values + node->count, node->values + index);
+    node->count--;
+    node->keys[node->count] = std::numeric_limits<K>::max();
+    node->values[node->count] = V();
+}
+
+template<typename K, typename V>
+void FatSkipList<K, V>::unlink(NodeType* node, NodeType** update) {
+    for (int i = 0; i <= node->node_level && i <= _skip_list_level; i++) {
+        if (update[i]->forward[i] == node) {
+            update[i]->forward[i] = node->forward[i];
+        }
+    }
+    while (_skip_list_level > 0 && _header->forward[_skip_list_level] == nullptr) {
+        _skip_list_level--;
+    }
+    destroy_node(node);
+    _node_count--;
+}
+
+// 插入：找到最小键小于 key 的最后一个节点放入（key 比所有键都小时放入第一个节点），节点满时先分裂
+template<typename K, typename V>
+int FatSkipList<K, V>::insert_element(const K& key, const V& value) {
+    std::lock_guard<std::mutex> lock(_mtx);
+    NodeType* update[_max_level + 1];
+    NodeType* x = find(key, update);
+    NodeType* next = x->forward[0];
+    if (next != nullptr && next->keys[0] == key) {
+        return 1;
+    }
+
+    if (x == _header) {
+        if (next == nullptr) {
+            // 空表
+            NodeType* node = create_node(get_random_level());
+            if (node->node_level > _skip_list_level) {
+                _skip_list_level = node->node_level;
+            }
+            for (int i = 0; i <= node->node_level; i++) {
+                _header->forward[i] = node;
+            }
+            _node_count++;
+            insert_at(node, 0, key, value);
+            _element_count++;
+            return 0;
+        }
+        // 比所有键都小，放在第一个节点的开头；第一个节点在它所在的各层都紧跟头节点
+        x = next;
+        for (int i = 0; i <= x->node_level; i++) {
+            update[i] = x;
+        }
+    } else {
+        int index = fat_rank(x->keys, kCapacity, key);
+        if (index < x->count && x->keys[index] == key) {
+            return 1;
+        }
+    }
+
+    if (x->count == kCapacity) {
+        NodeType* right = split(x, update);
+        if (!(key < right->keys[0])) {
+            x = right;
+        }
+    }
+    insert_at(x, fat_rank(x->keys, kCapacity, key), key, value);
+    _element_count++;
+    return 0;
+}
+
+// 删除：节点变空时摘除，键数过少时把后继节点的键并进来
+template<typename K, typename V>
+void FatSkipList<K, V>::delete_element(const K& key) {
+    std::lock_guard<std::mutex> lock(_mtx);
+    NodeType* update[_max_level + 1];
+    NodeType* x = find(key, update);
+    NodeType* node = x->forward[0];
+    int index = 0;
+    if (node == nullptr || node->keys[0] != key) {
+        if (x == _header) {
+            return;
+        }
+        node = x;
+        index = fat_rank(x->keys, kCapacity, key);
+        if (index >= x->count || x->keys[index] != key) {
+            return;
+        }
+    }
+    _element_count--;
+
+    if (node->count == 1) {
+        // 唯一的键就是最小键，update 正好是它在各层的前驱
+        unlink(node, update);
+        return;
+    }
+    erase_at(node, index);
+
+    NodeType* next = node->forward[0];
+    if (node->count < kCapacity / FAT_NODE_MERGE_DIVISOR && next != nullptr &&
+        node->count + next->count <= kCapacity * 3 / 4) {
+        std::copy(next->keys, next->keys + next->count, node->keys + node->count);
+        std::move(next->values, next->values + next->count, node->values + node->count);
+        node->count += next->count;
+        find(next->keys[0], update);
+        unlink(next, update);
+    }
+}
+
+template<typename K, typename V>
+bool FatSkipList<K, V>::search_element(const K& key) {
+    return contains(key);
+}
+
+template<typename K, typename V>
+std::optional<V> FatSkipList<K, V>::get(const K& key) {
+    std::lock_guard<std::mutex> lock(_mtx);
+    int index;
+    NodeType* node = locate(key, index);
+    if (node == nullptr) {
+        return std::nullopt;
+    }
+    return node->values[index];
+}
+
+template<typename K, typename V>
+bool FatSkipList<K, V>::get(const K& key, V& value) {
+    std::lock_guard<std::mutex> lock(_mtx);
+    int index;
+    NodeType* node = locate(key, index);
+    if (node == nullptr) {
+        return false;
+    }
+    value = node->values[index];
+    return true;
+}
+
+template<typename K, typename V>
+bool FatSkipList<K, V>::contains(const K& key) {
+    std::lock_guard<std::mutex> lock(_mtx);
+    int index;
+    return locate(key, index) != nullptr;
+}
+
+template<typename K, typename V>
+void FatSkipList<K, V>::display_list() {
+    std::lock_guard<std::mutex> lock(_mtx);
+    std::cout << "\n*****Fat Skip List*****" << "\n";
+    for (int i = 0; i <= _skip_list_level; i++) {
+        std::cout << "Level " << i << ": ";
+        for (NodeType* node = _header->forward[i]; node != nullptr; node = node->forward[i]) {
+            std::cout << "[";
+            for (int j = 0; j < node->count; j++) {
+                std::cout << node->keys[j] << ":" << node->values[j] << ";";
+            }
+            std::cout << "] ";
+        }
+        std::cout << std::endl;
+    }
+}
+
+template<typename K, typename V>
+int FatSkipList<K, V>::size() {
+    std::lock_guard<std::mutex> lock(_mtx);
+    return _element_count;
+}
+
+template<typename K, typename V>
+size_t FatSkipList<K, V>::node_count() {
+    std::lock_guard<std::mutex> lock(_mtx);
+    return _node_count;
+}
+
+#endif
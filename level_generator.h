@@ -0,0 +1,98 @@
+#ifndef LEVEL_GENERATOR_H
+#define LEVEL_GENERATOR_H
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <thread>
+
+// 跳表节点层级的生成：层级为 1 + 几何分布，节点出现在第 k 层以上的概率为 p^(k-1)。
+//
+// 随机数来自线程本地的 xorshift64*，不经过 rand() 的全局锁，每个节点只取一次随机数：
+// 1/p 为 2 的幂（1/2、1/4）时层级就是随机数末尾0的个数除以 log2(1/p)，用一条 ctz 指令得到；
+// 其他的 p（如 1/e）对均匀分布取对数。
+//
+// p 越小，节点的平均指针数 1/(1-p) 越少，每层要向后走的步数 (1/p - 1) 越多：
+//   p = 1/2   每节点 2 个指针
+//   p = 1/e   每节点约 1.58 个指针，查找的期望比较次数最少
+//   p = 1/4   每节点约 1.33 个指针
+
+#define SKIPLIST_P_HALF 0.5
+#define SKIPLIST_P_QUARTER 0.25
+#define SKIPLIST_P_E 0.36787944117144233 // 1/e
+#define SKIPLIST_LEVEL_LIMIT 32 // 最大层级随元素数增长的上限，头节点按这个高度分配
+
+class LevelGenerator {
+public:
+    explicit LevelGenerator(double p = SKIPLIST_P_HALF) { set_probability(p); }
+
+    // p 取值 (0, 1)，超出范围时取 1/2
+    void set_probability(double p) {
+        if (!(p > 0.0 && p < 1.0)) {
+            p = SKIPLIST_P_HALF;
+        }
+        _p = p;
+        _log_p = std::log(p);
+        _shift = 0;
+        for (int shift = 1; shift < 32; shift++) {
+            if (p == std::ldexp(1.0, -shift)) {
+                _shift = shift;
+                break;
+            }
+        }
+        _base = static_cast<long>(std::lround(1.0 / p));
+        if (_base < 2) {
+            _base = 2;
+        }
+    }
+
+    double probability() const { return _p; }
+
+    // 随机层级，不超过 max_level
+    int next(int max_level) const {
+        uint64_t bits = random_bits();
+        int k;
+        if (_shift > 0) {
+            k = 1 + __builtin_ctzll(bits | (1ULL << 63)) / _shift;
+        } else {
+            double u = static_cast<double>(bits >> 11) * (1.0 / 9007199254740992.0); // [0, 1)
+            k = 1 + static_cast<int>(std::log1p(-u) / _log_p); // u < 1，结果不超过 1 + 53 * ln2 / -ln(p)
+        }
+        return k < max_level ? k : max_level;
+    }
+
+    // 平衡构建时第 position 个（从1开始）键的层级：1 + position 能被 round(1/p) 整除的次数，各层级的比例与 next 一致
+    int sequential(long position, int max_level) const {
+        int k = 1;
+        while (position % _base == 0 && k < max_level) {
+            position /= _base;
+            k++;
+        }
+        return k;
+    }
+
+    // 最大层级为 level 时适合的元素数 (1/p)^level，元素数超过它时应增加一层
+    size_t capacity(int level) const {
+        double n = std::exp(-_log_p * level);
+        return n >= 1.8e19 ? SIZE_MAX : static_cast<size_t>(n);
+    }
+
+    // 线程本地的 xorshift64*，种子取自线程 id
+    static uint64_t random_bits() {
+        thread_local uint64_t state = 0x9E3779B97F4A7C15ULL ^
+            static_cast<uint64_t>(std::hash<std::thread::id>()(std::this_thread::get_id()));
+        state ^= state >> 12;
+        state ^= state << 25;
+        state ^= state >> 27;
+        return state * 0x2545F4914F6CDD1DULL;
+    }
+
+private:
+    double _p;
+    double _log_p;
+    int _shift; // 1/p == 2^_shift 时为 _shift，否则为 0
+    long _base; // round(1/p)，sequential 使用
+};
+
+#endif
@@ -0,0 +1,514 @@
+#ifndef LOCKFREE_SKIPLIST_H
+#define LOCKFREE_SKIPLIST_H
+
+#include <iostream>
+#include <cstdint>
+#include <atomic>
+#include <vector>
+#include <mutex>
+#include <chrono>
+#include <thread>
+
+// 无锁跳表：forward 指针为原子变量，通过 CAS 链接；删除先在指针最低位打标记（逻辑删除），
+// 再由查找过程物理摘除；被摘除的节点交给基于纪元（epoch）的回收器，确保没有线程还在读时才释放。
+// 与 skiplist.h 的 SkipList 接口保持一致，但热路径上不做任何控制台输出。
+
+#define LF_MAX_THREADS 256 // 同时访问无锁跳表的最大线程数
+
+// 为每个线程分配一个 [0, LF_MAX_THREADS) 的槽位编号，线程退出时归还
+class LockFreeThreadRegistry {
+public:
+    static int acquire() {
+        std::lock_guard<std::mutex> lock(registry_mutex());
+        std::vector<int>& free_ids = free_slots();
+        if (!free_ids.empty()) {
+            int id = free_ids.back();
+            free_ids.pop_back();
+            return id;
+        }
+        int id = next_slot()++;
+        if (id >= LF_MAX_THREADS) {
+            std::cerr << "lockfree skiplist: too many threads" << std::endl;
+            std::terminate();
+        }
+        return id;
+    }
+
+    static void release(int id) {
+        std::lock_guard<std::mutex> lock(registry_mutex());
+        free_slots().push_back(id);
+    }
+
+    // 当前线程的槽位编号
+    static int slot() {
+        thread_local Holder holder;
+        return holder.id;
+    }
+
+private:
+    struct Holder {
+        int id;
+        Holder() : id(acquire()) {}
+        ~Holder() { release(id); }
+    };
+
+    static std::mutex& registry_mutex() {
+        static std::mutex m;
+        return m;
+    }
+    static std::vector<int>& free_slots() {
+        static std::vector<int> ids;
+        return ids;
+    }
+    static int& next_slot() {
+        static int next = 0;
+        return next;
+    }
+};
+
+// 基于纪元的内存回收：节点在全局纪元 e 被退休，等全局纪元推进到 e+2 后，
+// 所有可能持有它的线程都已离开临界区，此时才真正释放
+class EpochManager {
+public:
+    typedef void (*Deleter)(void*);
+
+    EpochManager() : _global_epoch(1) {
+        for (int i = 0; i < LF_MAX_THREADS; i++) {
+            _slots[i].local_epoch.store(0);
+            _slots[i].nesting = 0;
+            _slots[i].op_count = 0;
+            for (int j = 0; j < 3; j++) {
+                _slots[i].limbo_epoch[j] = 0;
+            }
+        }
+    }
+
+    ~EpochManager() {
+        for (int i = 0; i < LF_MAX_THREADS; i++) {
+            for (int j = 0; j < 3; j++) {
+                free_list(_slots[i].limbo[j]);
+            }
+        }
+    }
+
+    // 进入临界区，之后读到的节点在退出前不会被释放
+    void enter() {
+        Slot& s = _slots[LockFreeThreadRegistry::slot()];
+        if (s.nesting++ > 0) {
+            return;
+        }
+        uint64_t e;
+        do {
+            e = _global_epoch.load();
+            s.local_epoch.store((e << 1) | 1);
+        } while (_global_epoch.load() != e);
+
+        for (int j = 0; j < 3; j++) {
+            if (!s.limbo[j].empty() && s.limbo_epoch[j] + 2 <= e) {
+                free_list(s.limbo[j]);
+            }
+        }
+        if (++s.op_count % 64 == 0) {
+            try_advance();
+        }
+    }
+
+    // 离开临界区
+    void exit() {
+        Slot& s = _slots[LockFreeThreadRegistry::slot()];
+        if (--s.nesting == 0) {
+            s.local_epoch.store(0);
+        }
+    }
+
+    // 退休一个已从所有层摘除的对象，延迟到安全时刻再调用 deleter 释放
+    void retire(void* ptr, Deleter deleter) {
+        Slot& s = _slots[LockFreeThreadRegistry::slot()];
+        uint64_t e = _global_epoch.load();
+        int j = e % 3;
+        if (s.limbo_epoch[j] != e) {
+            // 同一下标里旧的对象至少早三个纪元，已可安全释放
+            free_list(s.limbo[j]);
+            s.limbo_epoch[j] = e;
+        }
+        s.limbo[j].push_back(Retired{ptr, deleter});
+        if (s.limbo[j].size() % 128 == 0) {
+            try_advance();
+        }
+    }
+
+private:
+    struct Retired {
+        void* ptr;
+        Deleter deleter;
+    };
+
+    // 每个线程一个槽位，按缓存行对齐避免伪共享
+    struct alignas(64) Slot {
+        std::atomic<uint64_t> local_epoch; // 0 表示不在临界区，否则为 (纪元 << 1) | 1
+        int nesting; // 临界区嵌套深度
+        unsigned op_count;
+        uint64_t limbo_epoch[3]; // 每个待回收链表对应的退休纪元
+        std::vector<Retired> limbo[3]; // 待回收对象，只由所属线程访问
+    };
+
+    // 所有处于临界区的线程都已观察到当前纪元时，推进全局纪元
+    void try_advance() {
+        uint64_t e = _global_epoch.load();
+        for (int i = 0; i < LF_MAX_THREADS; i++) {
+            uint64_t local = _slots[i].local_epoch.load();
+            if ((local & 1) && (local >> 1) != e) {
+                return;
+            }
+        }
+        _global_epoch.compare_exchange_strong(e, e + 1);
+    }
+
+    static void free_list(std::vector<Retired>& list) {
+        for (size_t i = 0; i < list.size(); i++) {
+            list[i].deleter(list[i].ptr);
+        }
+        list.clear();
+    }
+
+    std::atomic<uint64_t> _global_epoch;
+    Slot _slots[LF_MAX_THREADS];
+};
+
+// RAII 方式进入/退出纪元临界区
+class EpochGuard {
+public:
+    explicit EpochGuard(EpochManager& epoch) : _epoch(epoch) { _epoch.enter(); }
+    ~EpochGuard() { _epoch.exit(); }
+
+private:
+    EpochManager& _epoch;
+};
+
+// 无锁跳表节点，forward[i] 的最低位为 1 表示该节点在第 i 层已被逻辑删除
+template<typename K, typename V>
+class LockFreeNode {
+
+public:
+    LockFreeNode(const K& k, const V& v, int level);
+
+    ~LockFreeNode();
+
+    const K& get_key() const;
+
+    const V& get_value() const;
+
+    // 指向每一层下一个节点的原子指针数组
+    std::atomic<LockFreeNode<K, V>*>* forward;
+
+    int node_level;
+
+    // 插入线程和删除线程各持有一份，两者都结束后节点才能退休
+    std::atomic<int> release_count;
+
+private:
+    K key;
+    V value;
+};
+
+template<typename K, typename V>
+LockFreeNode<K, V>::LockFreeNode(const K& k, const V& v, int level)
+    : node_level(level), release_count(2), key(k), value(v) {
+    this->forward = new std::atomic<LockFreeNode<K, V>*>[level + 1];
+    for (int i = 0; i <= level; i++) {
+        this->forward[i].store(nullptr, std::memory_order_relaxed);
+    }
+}
+
+template<typename K, typename V>
+LockFreeNode<K, V>::~LockFreeNode() {
+    delete[] forward;
+}
+
+template<typename K, typename V>
+const K& LockFreeNode<K, V>::get_key() const {
+    return key;
+}
+
+template<typename K, typename V>
+const V& LockFreeNode<K, V>::get_value() const {
+    return value;
+}
+
+// 无锁跳表类模板
+template<typename K, typename V>
+class LockFreeSkipList {
+
+public:
+    LockFreeSkipList(int max_level); // 构造函数，初始化最大层数
+
+    ~LockFreeSkipList(); // 析构函数，调用时不能再有并发访问
+
+    int insert_element(const K& key, const V& value); // 插入元素，返回1表示已存在，0表示插入成功
+
+    bool delete_element(const K& key); // 删除元素，返回是否由本线程删除
+
+    bool search_element(const K& key); // 查找元素
+
+    void display_list(); // 显示跳表内容
+
+    int size(); // 获取跳表大小
+
+private:
+    typedef LockFreeNode<K, V> NodeType;
+
+    int get_random_level(); // 使用线程本地的随机数生成器获取随机层级
+
+    // 查找 key 在每一层的前驱和后继，顺带摘除路过的已标记节点；返回 key 是否存在
+    bool find(const K& key, NodeType** preds, NodeType** succs);
+
+    // 插入线程或删除线程完成各自的工作，最后一个完成的负责退休节点
+    void release_node(NodeType* node);
+
+    static bool is_marked(NodeType* p) {
+        return reinterpret_cast<uintptr_t>(p) & 1;
+    }
+    static NodeType* get_marked(NodeType* p) {
+        return reinterpret_cast<NodeType*>(reinterpret_cast<uintptr_t>(p) | 1);
+    }
+    static NodeType* get_unmarked(NodeType* p) {
+        return reinterpret_cast<NodeType*>(reinterpret_cast<uintptr_t>(p) & ~static_cast<uintptr_t>(1));
+    }
+    static void delete_node(void* p) {
+        delete static_cast<NodeType*>(p);
+    }
+
+private:
+    int _max_level; // 最大层级
+    std::atomic<int> _skip_list_level; // 当前层级，只增不减
+    std::atomic<int> _element_count; // 跳表中的元素数量
+    NodeType* _header; // 跳表头节点
+    EpochManager _epoch; // 节点回收器
+};
+
+template<typename K, typename V>
+LockFreeSkipList<K, V>::LockFreeSkipList(int max_level)
+    : _max_level(max_level), _skip_list_level(0), _element_count(0) {
+    _header = new NodeType(K(), V(), _max_level);
+}
+
+template<typename K, typename V>
+LockFreeSkipList<K, V>::~LockFreeSkipList() {
+    // 已退休的节点都不在链表中，由 _epoch 析构时释放；这里只释放仍在第0层上的节点
+    NodeType* node = get_unmarked(_header->forward[0].load());
+    while (node != nullptr) {
+        NodeType* next = get_unmarked(node->forward[0].load());
+        delete node;
+        node = next;
+    }
+    delete _header;
+}
+
+template<typename K, typename V>
+int LockFreeSkipList<K, V>::get_random_level() {
+    thread_local uint64_t state = 0x9E3779B97F4A7C15ULL ^
+        static_cast<uint64_t>(std::hash<std::thread::id>()(std::this_thread::get_id()));
+    int k = 1;
+    while (true) {
+        // xorshift64
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        if (!(state & 1) || k >= _max_level) {
+            break;
+        }
+        k++;
+    }
+    return k;
+}
+
+template<typename K, typename V>
+bool LockFreeSkipList<K, V>::find(const K& key, NodeType** preds, NodeType** succs) {
+retry:
+    NodeType* pred = _header;
+    for (int i = _skip_list_level.load(); i >= 0; i--) {
+        NodeType* pred_next = pred->forward[i].load();
+        if (is_marked(pred_next)) {
+            // 前驱自身已被删除，从头再来
+            goto retry;
+        }
+        NodeType* curr = pred_next;
+        while (curr != nullptr) {
+            NodeType* succ = curr->forward[i].load();
+            if (is_marked(succ)) {
+                // curr 在这一层已被删除，跳过它
+                curr = get_unmarked(succ);
+                continue;
+            }
+            if (!(curr->get_key() < key)) {
+                break;
+            }
+            pred = curr;
+            pred_next = succ;
+            curr = succ;
+        }
+        // 一次 CAS 摘除 pred 与 curr 之间所有已标记的节点
+        if (pred_next != curr && !pred->forward[i].compare_exchange_strong(pred_next, curr)) {
+            goto retry;
+        }
+        preds[i] = pred;
+        succs[i] = curr;
+    }
+    return succs[0] != nullptr && succs[0]->get_key() == key;
+}
+
+template<typename K, typename V>
+void LockFreeSkipList<K, V>::release_node(NodeType* node) {
+    if (node->release_count.fetch_sub(1) == 1) {
+        _epoch.retire(node, &LockFreeSkipList<K, V>::delete_node);
+    }
+}
+
+template<typename K, typename V>
+int LockFreeSkipList<K, V>::insert_element(const K& key, const V& value) {
+    EpochGuard guard(_epoch);
+    NodeType* preds[_max_level + 1];
+    NodeType* succs[_max_level + 1];
+
+    int random_level = get_random_level();
+
+    // 抬高当前层级，使查找能覆盖新节点的所有层
+    int level = _skip_list_level.load();
+    while (random_level > level && !_skip_list_level.compare_exchange_weak(level, random_level)) {
+    }
+
+    NodeType* inserted_node = nullptr;
+    while (true) {
+        if (find(key, preds, succs)) {
+            delete inserted_node;
+            return 1; // 键已存在
+        }
+        if (inserted_node == nullptr) {
+            inserted_node = new NodeType(key, value, random_level);
+        }
+        for (int i = 0; i <= random_level; i++) {
+            inserted_node->forward[i].store(succs[i], std::memory_order_relaxed);
+        }
+        // 第0层链接成功即视为插入完成（线性化点）
+        NodeType* expected = succs[0];
+        if (preds[0]->forward[0].compare_exchange_strong(expected, inserted_node)) {
+            break;
+        }
+    }
+    _element_count++;
+
+    // 逐层向上链接，节点已被并发删除时停止
+    for (int i = 1; i <= random_level; i++) {
+        while (true) {
+            NodeType* next = inserted_node->forward[i].load();
+            if (is_marked(next)) {
+                goto done;
+            }
+            if (next != succs[i] && !inserted_node->forward[i].compare_exchange_strong(next, succs[i])) {
+                goto done;
+            }
+            NodeType* expected = succs[i];
+            if (preds[i]->forward[i].compare_exchange_strong(expected, inserted_node)) {
+                break;
+            }
+            if (!find(key, preds, succs) || succs[0] != inserted_node) {
+                goto done;
+            }
+        }
+    }
+
+done:
+    // 链接期间被删除的话，上层可能刚被重新挂上，再查找一次确保完全摘除
+    if (is_marked(inserted_node->forward[0].load())) {
+        find(key, preds, succs);
+    }
+    release_node(inserted_node);
+    return 0;
+}
+
+template<typename K, typename V>
+bool LockFreeSkipList<K, V>::delete_element(const K& key) {
+    EpochGuard guard(_epoch);
+    NodeType* preds[_max_level + 1];
+    NodeType* succs[_max_level + 1];
+
+    if (!find(key, preds, succs)) {
+        return false;
+    }
+    NodeType* node = succs[0];
+
+    // 自顶向下标记第1层及以上的指针
+    for (int i = node->node_level; i >= 1; i--) {
+        NodeType* succ = node->forward[i].load();
+        while (!is_marked(succ)) {
+            node->forward[i].compare_exchange_weak(succ, get_marked(succ));
+        }
+    }
+
+    // 第0层标记成功的线程才算删除了该节点
+    NodeType* succ = node->forward[0].load();
+    while (true) {
+        if (is_marked(succ)) {
+            return false;
+        }
+        if (node->forward[0].compare_exchange_strong(succ, get_marked(succ))) {
+            break;
+        }
+    }
+    _element_count--;
+
+    // 物理摘除
+    find(key, preds, succs);
+    release_node(node);
+    return true;
+}
+
+template<typename K, typename V>
+bool LockFreeSkipList<K, V>::search_element(const K& key) {
+    EpochGuard guard(_epoch);
+    NodeType* pred = _header;
+    NodeType* curr = nullptr;
+
+    // 只读遍历，跳过已标记的节点但不摘除
+    for (int i = _skip_list_level.load(); i >= 0; i--) {
+        curr = get_unmarked(pred->forward[i].load());
+        while (curr != nullptr) {
+            NodeType* succ = curr->forward[i].load();
+            if (is_marked(succ)) {
+                curr = get_unmarked(succ);
+                continue;
+            }
+            if (!(curr->get_key() < key)) {
+                break;
+            }
+            pred = curr;
+            curr = succ;
+        }
+    }
+    return curr != nullptr && curr->get_key() == key;
+}
+
+template<typename K, typename V>
+void LockFreeSkipList<K, V>::display_list() {
+    EpochGuard guard(_epoch);
+    std::cout << "\n*****Lock-free Skip List*****" << "\n";
+    for (int i = 0; i <= _skip_list_level.load(); i++) {
+        NodeType* node = get_unmarked(_header->forward[i].load());
+        std::cout << "Level " << i << ": ";
+        while (node != nullptr) {
+            NodeType* next = node->forward[i].load();
+            if (!is_marked(next)) {
+                std::cout << node->get_key() << ":" << node->get_value() << ";";
+            }
+            node = get_unmarked(next);
+        }
+        std::cout << std::endl;
+    }
+}
+
+template<typename K, typename V>
+int LockFreeSkipList<K, V>::size() {
+    return _element_count.load();
+}
+
+#endif
@@ -7,7 +7,7 @@ int main() {
     // 插入100个元素，每个元素的过期时间不同
     for (int i = 1; i <= 100; ++i) {
         // 将每个元素的过期时间设置为当前时间 + i 秒，方便观察逐渐过期
-        skip_list.insert_element(i, "value" + std::to_string(i), time(nullptr) + i);
+        skip_list.insert_element(i, "value" + std::to_string(i), expiry_now_ms() + i * 1000);
     }
 
     // 显示初始跳表内容
@@ -44,7 +44,7 @@ int main() {
 
     // 再次插入新的元素，覆盖之前的一些键
     for (int i = 90; i <= 100; ++i) {
-        skip_list.insert_element(i, "new_value" + std::to_string(i), time(nullptr) + 60); // 60秒后过期
+        skip_list.insert_element(i, "new_value" + std::to_string(i), expiry_now_ms() + 60 * 1000); // 60秒后过期
     }
 
     std::cout << "Skip List after reinserting some keys with updated values: " << std::endl;
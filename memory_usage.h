@@ -0,0 +1,67 @@
+#ifndef MEMORY_USAGE_H
+#define MEMORY_USAGE_H
+
+#include <cstddef>
+#include <string>
+
+// 内存统计：缓存容量的单位（节点数或字节数）、单个值在堆上占用的字节数，以及 SkipList::memory_usage() 的返回值。
+
+// 缓存容量：默认按节点数计；CacheCapacity::bytes(n) 按字节计，每个节点按 Node::memory_bytes()
+// （节点和指针塔，加上键和值在堆上的部分）计入，缓存中节点的总字节数不超过 n。
+// 可以从 size_t 隐式构造，原来传节点数的地方不用修改
+struct CacheCapacity {
+    CacheCapacity(size_t items) : amount(items), in_bytes(false) {}
+
+    static CacheCapacity bytes(size_t budget) {
+        CacheCapacity capacity(budget);
+        capacity.in_bytes = true;
+        return capacity;
+    }
+
+    size_t amount; // 节点数或字节数
+    bool in_bytes; // amount 是否为字节数
+};
+
+// 值在对象之外占用的堆内存。std::string 使用短字符串优化（数据就在对象内）时为 0，否则为 capacity + 1；
+// 其他类型按 0 计，自定义类型可以在自己的命名空间里重载 heap_bytes（通过 ADL 找到）
+template<typename T>
+inline size_t heap_bytes(const T&) {
+    return 0;
+}
+
+inline size_t heap_bytes(const std::string& s) {
+    const char* data = s.data();
+    const char* object = reinterpret_cast<const char*>(&s);
+    if (data >= object && data < object + sizeof(s)) {
+        return 0;
+    }
+    return s.capacity() + 1;
+}
+
+// memory_usage() 的结果，单位为字节。cache 是其他几项中属于缓存中节点的部分，不重复计入 total()
+struct MemoryUsage {
+    size_t nodes = 0; // 节点本身（sizeof(Node)，含第0层指针），包括头节点
+    size_t towers = 0; // 第1层及以上的 forward 指针
+    size_t keys = 0; // 键在堆上的部分
+    size_t values = 0; // 值在堆上的部分
+    size_t cache = 0; // 缓存中节点的 nodes + towers + keys + values
+    size_t cache_overhead = 0; // 缓存策略自身的内存（链表指针在节点中，TinyLFUCache 另有频率表）
+    size_t arena_reserved = 0; // 节点内存池向系统申请的字节数，减去 nodes + towers 即空闲链表和对齐浪费
+
+    size_t total() const {
+        size_t node_memory = nodes + towers > arena_reserved ? nodes + towers : arena_reserved;
+        return node_memory + keys + values + cache_overhead;
+    }
+
+    void merge(const MemoryUsage& other) {
+        nodes += other.nodes;
+        towers += other.towers;
+        keys += other.keys;
+        values += other.values;
+        cache += other.cache;
+        cache_overhead += other.cache_overhead;
+        arena_reserved += other.arena_reserved;
+    }
+};
+
+#endif
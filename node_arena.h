@@ -0,0 +1,107 @@
+#ifndef NODE_ARENA_H
+#define NODE_ARENA_H
+
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+#include <vector>
+
+// 跳表节点的内存池：节点和它的 forward 指针塔放在同一块内存里，
+// 从大块（block）中按顺序切分；删除的节点按层级放入对应尺寸的空闲链表，下次同层插入时复用。
+// 跳表析构时直接整块释放，不再逐个节点 delete。
+// 定义 SKIPLIST_MALLOC_NODES 后退化为每个节点单独 operator new，便于做性能对比。
+
+#define NODE_ARENA_BLOCK_SIZE (1 << 20) // 每个大块 1MB
+
+class NodeArena {
+public:
+    NodeArena(int max_level);
+
+    ~NodeArena();
+
+    void* allocate(size_t bytes, int level); // 分配一个层级为 level 的节点
+
+    void deallocate(void* ptr, int level); // 归还节点到该层级的空闲链表
+
+    // 析构时是否整块释放（为 false 时调用方需要逐个 deallocate）
+    static bool bulk_release() {
+#ifdef SKIPLIST_MALLOC_NODES
+        return false;
+#else
+        return true;
+#endif
+    }
+
+    size_t reserved_bytes() const; // 已向系统申请的字节数
+
+private:
+    static size_t align_up(size_t bytes) {
+        const size_t align = alignof(std::max_align_t);
+        return (bytes + align - 1) & ~(align - 1);
+    }
+
+    std::vector<char*> _blocks; // 所有大块，析构时统一释放
+    char* _cursor; // 当前大块中下一个可分配的位置
+    size_t _remaining; // 当前大块剩余字节数
+    size_t _reserved; // 已申请的总字节数
+    std::vector<void*> _free_lists; // 每个层级一条空闲链表，链接指针存放在空闲节点自身的前8字节
+};
+
+inline NodeArena::NodeArena(int max_level)
+    : _cursor(nullptr), _remaining(0), _reserved(0), _free_lists(max_level + 1, nullptr) {}
+
+inline NodeArena::~NodeArena() {
+    for (size_t i = 0; i < _blocks.size(); i++) {
+        std::free(_blocks[i]);
+    }
+}
+
+inline void* NodeArena::allocate(size_t bytes, int level) {
+#ifdef SKIPLIST_MALLOC_NODES
+    (void)level;
+    return ::operator new(bytes);
+#else
+    if (level < (int)_free_lists.size() && _free_lists[level] != nullptr) {
+        void* ptr = _free_lists[level];
+        _free_lists[level] = *static_cast<void**>(ptr);
+        return ptr;
+    }
+
+    bytes = align_up(bytes);
+    if (bytes > _remaining) {
+        // 超大节点单独占一块，否则开新的大块（当前块剩余部分丢弃）
+        size_t block_size = bytes > NODE_ARENA_BLOCK_SIZE ? bytes : NODE_ARENA_BLOCK_SIZE;
+        char* block = static_cast<char*>(std::malloc(block_size));
+        if (block == nullptr) {
+            throw std::bad_alloc();
+        }
+        _blocks.push_back(block);
+        _reserved += block_size;
+        _cursor = block;
+        _remaining = block_size;
+    }
+    void* ptr = _cursor;
+    _cursor += bytes;
+    _remaining -= bytes;
+    return ptr;
+#endif
+}
+
+inline void NodeArena::deallocate(void* ptr, int level) {
+#ifdef SKIPLIST_MALLOC_NODES
+    (void)level;
+    ::operator delete(ptr);
+#else
+    if (level >= (int)_free_lists.size()) {
+        return; // 不会发生：层级不超过最大层级；内存随大块一起释放
+    }
+    *static_cast<void**>(ptr) = _free_lists[level];
+    _free_lists[level] = ptr;
+#endif
+}
+
+inline size_t NodeArena::reserved_bytes() const {
+    return _reserved;
+}
+
+#endif
@@ -0,0 +1,331 @@
+#ifndef RESP_PROTOCOL_H
+#define RESP_PROTOCOL_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+// RESP（Redis 序列化协议）的请求解析和回复编码，供 server.cpp 使用。
+//
+// 请求有两种形式：
+//   *<参数个数>\r\n 后跟每个参数 $<长度>\r\n<数据>\r\n    redis-cli、redis-benchmark 和各语言客户端发送的格式
+//   以空格分隔、以 \n 或 \r\n 结尾的一行                  inline 命令，telnet / nc 手工输入用
+// 解析是无状态的：每次从一条命令的开头解析，数据不完整时返回 RESP_INCOMPLETE，调用方读到更多数据后从同一位置重试。
+// 批量字符串按长度跳过，不逐字节扫描，大的值分多次到达时重试的代价只与参数个数有关。
+// 解析出的参数是指向输入缓冲区的 string_view，处理完这条命令之前缓冲区不能移动。
+
+#define RESP_MAX_ARGS (1 << 20) // 一条命令的最大参数个数
+#define RESP_MAX_BULK_LENGTH (64 << 20) // 单个参数的最大字节数
+#define RESP_MAX_INLINE_LENGTH (64 << 10) // inline 命令一行的最大字节数
+
+enum RespParseResult {
+    RESP_COMMAND, // 解析出一条完整的命令
+    RESP_INCOMPLETE, // 数据还不完整
+    RESP_PROTOCOL_ERROR // 格式错误，应回复错误后关闭连接
+};
+
+// 从 data[0, len) 的开头解析一条命令，成功时参数写入 args，consumed 为这条命令占用的字节数。
+// 空行（inline 格式下只有换行）也算一条命令，args 为空，调用方跳过即可。出错时 error 为错误信息
+inline RespParseResult resp_parse_command(const char* data, size_t len, std::vector<std::string_view>& args,
+                                          size_t& consumed, const char*& error);
+
+// 回复编码，追加到 out
+inline void resp_append_simple(std::string& out, std::string_view status) { // +OK
+    out.push_back('+');
+    out.append(status.data(), status.size());
+    out.append("\r\n", 2);
+}
+
+inline void resp_append_error(std::string& out, std::string_view message) { // -ERR ...，message 包括错误类型前缀
+    out.push_back('-');
+    out.append(message.data(), message.size());
+    out.append("\r\n", 2);
+}
+
+inline void resp_append_decimal(std::string& out, char type, int64_t value) {
+    char buf[24];
+    char* end = buf + sizeof(buf);
+    char* p = end;
+    uint64_t magnitude = value < 0 ? 0 - static_cast<uint64_t>(value) : static_cast<uint64_t>(value);
+    do {
+        *--p = static_cast<char>('0' + magnitude % 10);
+        magnitude /= 10;
+    } while (magnitude != 0);
+    if (value < 0) {
+        *--p = '-';
+    }
+    out.push_back(type);
+    out.append(p, end - p);
+    out.append("\r\n", 2);
+}
+
+inline void resp_append_integer(std::string& out, int64_t value) { // :<整数>
+    resp_append_decimal(out, ':', value);
+}
+
+inline void resp_append_bulk(std::string& out, std::string_view data) { // $<长度>\r\n<数据>
+    resp_append_decimal(out, '$', static_cast<int64_t>(data.size()));
+    out.append(data.data(), data.size());
+    out.append("\r\n", 2);
+}
+
+inline void resp_append_null(std::string& out) { // 不存在的键
+    out.append("$-1\r\n", 5);
+}
+
+inline void resp_append_array(std::string& out, size_t count) { // *<元素个数>，之后追加各元素
+    resp_append_decimal(out, '*', static_cast<int64_t>(count));
+}
+
+// 解析非负十进制整数，不允许符号、空白和溢出
+inline bool resp_parse_size(std::string_view text, int64_t limit, int64_t& value) {
+    if (text.empty() || text.size() > 18) {
+        return false;
+    }
+    value = 0;
+    for (char c : text) {
+        if (c < '0' || c > '9') {
+            return false;
+        }
+        value = value * 10 + (c - '0');
+    }
+    return value <= limit;
+}
+
+// 解析带符号的十进制整数（命令参数中的数字，如 EX 的秒数、SCAN 的游标）
+inline bool resp_parse_int(std::string_view text, int64_t& value) {
+    bool negative = !text.empty() && text[0] == '-';
+    if (negative) {
+        text.remove_prefix(1);
+    }
+    if (!resp_parse_size(text, INT64_MAX, value)) {
+        return false;
+    }
+    if (negative) {
+        value = -value;
+    }
+    return true;
+}
+
+// 命令名和选项不区分大小写，name 为大写
+inline bool resp_equals(std::string_view arg, const char* name) {
+    size_t n = strlen(name);
+    if (arg.size() != n) {
+        return false;
+    }
+    for (size_t i = 0; i < n; i++) {
+        char c = arg[i];
+        if (c >= 'a' && c <= 'z') {
+            c = static_cast<char>(c - 'a' + 'A');
+        }
+        if (c != name[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// 读取 data[pos, len) 中的一行（不含行尾的 \r\n，\r 可以省略），找不到 \n 时返回 false
+inline bool resp_read_line(const char* data, size_t len, size_t& pos, std::string_view& line) {
+    const char* begin = data + pos;
+    const char* newline = static_cast<const char*>(memchr(begin, '\n', len - pos));
+    if (newline == nullptr) {
+        return false;
+    }
+    const char* end = newline > begin && newline[-1] == '\r' ? newline - 1 : newline;
+    line = std::string_view(begin, end - begin);
+    pos = newline + 1 - data;
+    return true;
+}
+
+inline RespParseResult resp_parse_inline(const char* data, size_t len, std::vector<std::string_view>& args,
+                                         size_t& consumed, const char*& error) {
+    const char* newline = static_cast<const char*>(memchr(data, '\n', len));
+    if (newline == nullptr) {
+        if (len > RESP_MAX_INLINE_LENGTH) {
+            error = "ERR Protocol error: too big inline request";
+            return RESP_PROTOCOL_ERROR;
+        }
+        return RESP_INCOMPLETE;
+    }
+    const char* end = newline > data && newline[-1] == '\r' ? newline - 1 : newline;
+    const char* p = data;
+    while (p < end) {
+        while (p < end && (*p == ' ' || *p == '\t')) {
+            p++;
+        }
+        const char* word = p;
+        while (p < end && *p != ' ' && *p != '\t') {
+            p++;
+        }
+        if (p > word) {
+            args.emplace_back(word, p - word);
+        }
+    }
+    consumed = newline + 1 - data;
+    return RESP_COMMAND;
+}
+
+inline RespParseResult resp_parse_command(const char* data, size_t len, std::vector<std::string_view>& args,
+                                          size_t& consumed, const char*& error) {
+    args.clear();
+    if (len == 0) {
+        return RESP_INCOMPLETE;
+    }
+    if (data[0] != '*') {
+        return resp_parse_inline(data, len, args, consumed, error);
+    }
+
+    size_t pos = 1;
+    std::string_view line;
+    if (!resp_read_line(data, len, pos, line)) {
+        if (len > RESP_MAX_INLINE_LENGTH) {
+            error = "ERR Protocol error: too big mbulk count string";
+            return RESP_PROTOCOL_ERROR;
+        }
+        return RESP_INCOMPLETE;
+    }
+    int64_t count;
+    if (!resp_parse_size(line, RESP_MAX_ARGS, count)) {
+        error = "ERR Protocol error: invalid multibulk length";
+        return RESP_PROTOCOL_ERROR;
+    }
+    args.reserve(count < 1024 ? count : 1024);
+    for (int64_t i = 0; i < count; i++) {
+        if (pos >= len) {
+            return RESP_INCOMPLETE;
+        }
+        if (data[pos] != '$') {
+            error = "ERR Protocol error: expected '$'";
+            return RESP_PROTOCOL_ERROR;
+        }
+        pos++;
+        if (!resp_read_line(data, len, pos, line)) {
+            return RESP_INCOMPLETE;
+        }
+        int64_t size;
+        if (!resp_parse_size(line, RESP_MAX_BULK_LENGTH, size)) {
+            error = "ERR Protocol error: invalid bulk length";
+            return RESP_PROTOCOL_ERROR;
+        }
+        if (len - pos < static_cast<size_t>(size) + 2) {
+            return RESP_INCOMPLETE;
+        }
+        if (data[pos + size] != '\r' || data[pos + size + 1] != '\n') {
+            error = "ERR Protocol error: bulk string not terminated by CRLF";
+            return RESP_PROTOCOL_ERROR;
+        }
+        args.emplace_back(data + pos, size);
+        pos += size + 2;
+    }
+    consumed = pos;
+    return RESP_COMMAND;
+}
+
+// glob 中除 * 以外的一个元素（字节、?、[...] 字符集、\ 转义）与字节 c 比较，返回元素在 pattern 中的长度，
+// 字符集缺少 ] 时返回 0
+inline size_t resp_glob_token(const char* pattern, size_t plen, unsigned char c, bool& matched) {
+    switch (*pattern) {
+    case '?':
+        matched = true;
+        return 1;
+    case '[': {
+        size_t i = 1;
+        bool negate = i < plen && pattern[i] == '^';
+        if (negate) {
+            i++;
+        }
+        bool found = false;
+        while (i < plen && pattern[i] != ']') {
+            if (pattern[i] == '\\' && i + 1 < plen) {
+                i++;
+                found |= static_cast<unsigned char>(pattern[i]) == c;
+            } else if (i + 2 < plen && pattern[i + 1] == '-') {
+                unsigned char low = pattern[i], high = pattern[i + 2];
+                if (low > high) {
+                    std::swap(low, high);
+                }
+                found |= c >= low && c <= high;
+                i += 2;
+            } else {
+                found |= static_cast<unsigned char>(pattern[i]) == c;
+            }
+            i++;
+        }
+        if (i == plen) {
+            return 0;
+        }
+        matched = found != negate;
+        return i + 1;
+    }
+    case '\\':
+        if (plen >= 2) {
+            matched = static_cast<unsigned char>(pattern[1]) == c; // 转义后的字符按普通字符处理
+            return 2;
+        }
+        [[fallthrough]];
+    default:
+        matched = static_cast<unsigned char>(*pattern) == c;
+        return 1;
+    }
+}
+
+// Redis 的 glob 匹配（SCAN 的 MATCH）：* 任意串，? 任意一个字节，[abc] [^a-z] 字符集，\ 转义。
+// 迭代实现，只记住最近的一个 *：其他元素都恰好匹配一个字节，后面匹配失败时让这个 * 多吞一个字节重试即可，
+// 更早的 * 不需要回溯。最坏 O(plen * tlen)，不会像递归回溯那样被 *a*a*a*b 之类的模式拖成指数时间（CVE-2022-36021）
+inline bool resp_glob_match(const char* pattern, size_t plen, const char* text, size_t tlen) {
+    const char* star_pattern = nullptr; // 最近的 * 之后的模式
+    size_t star_plen = 0;
+    const char* star_text = nullptr; // 这个 * 吞到的位置
+    size_t star_tlen = 0;
+    while (tlen > 0) {
+        if (plen > 0 && *pattern == '*') {
+            while (plen > 0 && *pattern == '*') {
+                pattern++;
+                plen--;
+            }
+            if (plen == 0) {
+                return true;
+            }
+            star_pattern = pattern;
+            star_plen = plen;
+            star_text = text;
+            star_tlen = tlen;
+            continue;
+        }
+        bool matched = false;
+        if (plen > 0) {
+            size_t token = resp_glob_token(pattern, plen, static_cast<unsigned char>(*text), matched);
+            if (token == 0) {
+                return false; // 缺少 ]，按 Redis 的做法视为不匹配
+            }
+            if (matched) {
+                pattern += token;
+                plen -= token;
+                text++;
+                tlen--;
+                continue;
+            }
+        }
+        if (star_pattern == nullptr) {
+            return false;
+        }
+        star_text++;
+        star_tlen--;
+        pattern = star_pattern;
+        plen = star_plen;
+        text = star_text;
+        tlen = star_tlen;
+    }
+    while (plen > 0 && *pattern == '*') {
+        pattern++;
+        plen--;
+    }
+    return plen == 0;
+}
+
+#endif
@@ -0,0 +1,753 @@
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <deque>
+#include <unordered_map>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+#include <cstdlib>
+#include <unistd.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <sched.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include "sharded_skiplist.h"
+#include "resp_protocol.h"
+
+// RESP 服务端：用 Redis 协议的一个子集对外提供 ShardedSkipList<StringKey, std::string>，redis-cli 和各语言的 Redis 客户端可以直接连接。
+//
+//   GET key                            值，不存在或已过期时为 nil
+//   SET key value [EX 秒 | PX 毫秒]     覆盖写入，可带过期时间
+//   DEL key [key ...]                  返回删除的个数
+//   EXISTS key [key ...]               返回存在的个数（同一个键出现几次算几次）
+//   SCAN cursor [MATCH pattern] [COUNT n]  按键序分批遍历
+//   INFO [section]                     server / clients / stats / keyspace，memory 需要显式指定或用 all
+//   另外支持 PING、ECHO、DBSIZE、QUIT，以及客户端启动时会发的 COMMAND、CONFIG GET（回复空数组）
+//
+// 每个 I/O 线程（默认每个 CPU 一个，绑在对应的核上）有自己的 epoll 和监听 socket（SO_REUSEPORT，由内核分配新连接），
+// 连接从建立到关闭都在同一个线程上处理，线程之间只通过跳表的分片锁交互。
+// 连接以边缘触发（EPOLLET）注册：每次事件都读到 EAGAIN，把读到的所有完整命令依次执行（pipelining），
+// 回复先追加到连接的输出缓冲区，处理完这一批再一次写出（批量回复）。
+// 客户端只发不收时，待发送的回复超过 SERVER_OUTPUT_LIMIT 就暂停读取和执行，等 EPOLLOUT 把回复写出去再继续。
+//
+// 过期：读时发现过期的键会被删除，另有主线程每 SERVER_EXPIRE_INTERVAL_MS 执行一次主动过期。数据只在内存中，不落盘。
+//
+// 用法：./bin/server [--port 6379] [--threads CPU数] [--shards 16] [--max-level 18] [--cache 100000]
+
+#define SERVER_PORT 6379
+#define SERVER_SHARDS 16
+#define SERVER_MAX_LEVEL 18
+#define SERVER_CACHE_CAPACITY 100000
+#define SERVER_BACKLOG 4096
+#define SERVER_MAX_EVENTS 256 // 每次 epoll_wait 取回的最大事件数
+#define SERVER_READ_CHUNK (64 << 10) // 每次 read 的字节数
+#define SERVER_OUTPUT_LIMIT (16 << 20) // 待发送的回复超过这个字节数时暂停处理该连接的请求
+#define SERVER_MAX_KEY_LENGTH (64 << 10) // 键的最大长度，SCAN 用比它长的全 0xff 串作为上界
+#define SERVER_SCAN_COUNT 10 // SCAN 默认每次访问的键数
+#define SERVER_SCAN_CURSORS 65536 // 保留的 SCAN 游标数，更早的游标失效
+#define SERVER_EXPIRE_INTERVAL_MS 100
+#define SERVER_EXPIRE_BUDGET_US 1000
+
+typedef ShardedSkipList<StringKey, std::string> Store;
+
+struct ServerOptions {
+    int port = SERVER_PORT;
+    int threads = 0; // 0 表示 CPU 数
+    int shards = SERVER_SHARDS;
+    int max_level = SERVER_MAX_LEVEL;
+    long cache = SERVER_CACHE_CAPACITY;
+};
+
+static std::atomic<bool> g_stop(false);
+
+static void handle_signal(int) {
+    g_stop.store(true);
+}
+
+// SCAN 的游标：客户端（redis-cli --scan、redis-py 等）把游标当整数解析，所以返回编号，
+// 编号对应的下一个起始键保存在服务端；只保留最近 SERVER_SCAN_CURSORS 个，过旧的游标返回错误
+class ScanCursors {
+public:
+    uint64_t save(std::string next_key) {
+        std::lock_guard<std::mutex> lock(_mtx);
+        uint64_t id = ++_last_id;
+        _keys.emplace(id, std::move(next_key));
+        _order.push_back(id);
+        if (_order.size() > SERVER_SCAN_CURSORS) {
+            _keys.erase(_order.front());
+            _order.pop_front();
+        }
+        return id;
+    }
+
+    bool find(uint64_t id, std::string& next_key) {
+        std::lock_guard<std::mutex> lock(_mtx);
+        auto it = _keys.find(id);
+        if (it == _keys.end()) {
+            return false;
+        }
+        next_key = it->second;
+        return true;
+    }
+
+private:
+    std::mutex _mtx;
+    uint64_t _last_id = 0;
+    std::unordered_map<uint64_t, std::string> _keys;
+    std::deque<uint64_t> _order;
+};
+
+// 每个 I/O 线程的计数，INFO 时汇总
+struct alignas(64) LoopStats {
+    std::atomic<int64_t> clients{0};
+    std::atomic<uint64_t> connections{0};
+    std::atomic<uint64_t> commands{0};
+    std::atomic<uint64_t> hits{0};
+    std::atomic<uint64_t> misses{0};
+};
+
+struct Connection {
+    int fd;
+    std::string in; // 收到还没执行的数据从 in_pos 开始
+    size_t in_pos = 0;
+    std::string out; // 待发送的回复从 out_pos 开始
+    size_t out_pos = 0;
+    bool eof = false; // 对端已关闭写方向，执行完已收到的命令、发完回复后关闭
+    bool closing = false; // QUIT 或协议错误，发完回复后关闭
+
+    size_t pending_output() const { return out.size() - out_pos; }
+};
+
+class Server;
+
+class EventLoop {
+public:
+    EventLoop(Server& server, int id) : _server(server), _id(id), _epoll_fd(-1), _listen_fd(-1) {}
+
+    ~EventLoop();
+
+    bool listen(int port); // 创建本线程的监听 socket 和 epoll
+    void run(); // 事件循环，g_stop 置位后返回
+
+    const LoopStats& stats() const { return _stats; }
+
+private:
+    void accept_connections();
+    void handle(Connection* c); // 读、执行、写，直到没有进展
+    bool read_input(Connection* c, bool& failed);
+    bool process(Connection* c);
+    bool flush(Connection* c, bool& failed);
+    void close_connection(Connection* c);
+    void execute(Connection* c, const std::vector<std::string_view>& args);
+
+    void command_get(Connection* c, const std::vector<std::string_view>& args);
+    void command_set(Connection* c, const std::vector<std::string_view>& args);
+    void command_del(Connection* c, const std::vector<std::string_view>& args);
+    void command_exists(Connection* c, const std::vector<std::string_view>& args);
+    void command_scan(Connection* c, const std::vector<std::string_view>& args);
+    void command_info(Connection* c, const std::vector<std::string_view>& args);
+
+    Server& _server;
+    int _id;
+    int _epoll_fd;
+    int _listen_fd;
+    LoopStats _stats;
+    std::vector<Connection*> _connections; // 按 fd 索引
+    std::vector<std::string_view> _args; // 复用的参数数组
+    char _read_buffer[SERVER_READ_CHUNK];
+};
+
+class Server {
+public:
+    explicit Server(const ServerOptions& options)
+        : options(options), store(options.shards, options.max_level, options.cache),
+          scan_end(std::string(SERVER_MAX_KEY_LENGTH + 1, '\xff')), started(std::chrono::steady_clock::now()) {}
+
+    bool start();
+    void wait(); // 主线程执行主动过期，直到 g_stop 置位，然后等待 I/O 线程退出
+
+    ServerOptions options;
+    Store store;
+    ScanCursors cursors;
+    const StringKey scan_end; // 大于所有合法的键
+    std::chrono::steady_clock::time_point started;
+    std::vector<std::unique_ptr<EventLoop>> loops;
+
+private:
+    std::vector<std::thread> _threads;
+};
+
+static void wrong_arity(Connection* c, std::string_view name) {
+    std::string message = "ERR wrong number of arguments for '";
+    for (char ch : name) {
+        message.push_back(static_cast<char>(tolower(static_cast<unsigned char>(ch))));
+    }
+    message += "' command";
+    resp_append_error(c->out, message);
+}
+
+EventLoop::~EventLoop() {
+    for (Connection* c : _connections) {
+        if (c != nullptr) {
+            close(c->fd);
+            delete c;
+        }
+    }
+    if (_listen_fd >= 0) {
+        close(_listen_fd);
+    }
+    if (_epoll_fd >= 0) {
+        close(_epoll_fd);
+    }
+}
+
+bool EventLoop::listen(int port) {
+    _listen_fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (_listen_fd < 0) {
+        std::cout << "socket: " << strerror(errno) << std::endl;
+        return false;
+    }
+    int one = 1;
+    setsockopt(_listen_fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    if (setsockopt(_listen_fd, SOL_SOCKET, SO_REUSEPORT, &one, sizeof(one)) != 0) {
+        std::cout << "SO_REUSEPORT: " << strerror(errno) << std::endl;
+        return false;
+    }
+    sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    addr.sin_port = htons(static_cast<uint16_t>(port));
+    if (bind(_listen_fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 ||
+        ::listen(_listen_fd, SERVER_BACKLOG) != 0) {
+        std::cout << "listen on port " << port << ": " << strerror(errno) << std::endl;
+        return false;
+    }
+
+    _epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    if (_epoll_fd < 0) {
+        std::cout << "epoll_create1: " << strerror(errno) << std::endl;
+        return false;
+    }
+    epoll_event event;
+    event.events = EPOLLIN | EPOLLET;
+    event.data.ptr = nullptr; // nullptr 表示监听 socket
+    return epoll_ctl(_epoll_fd, EPOLL_CTL_ADD, _listen_fd, &event) == 0;
+}
+
+void EventLoop::run() {
+    epoll_event events[SERVER_MAX_EVENTS];
+    while (!g_stop.load(std::memory_order_relaxed)) {
+        int n = epoll_wait(_epoll_fd, events, SERVER_MAX_EVENTS, 500);
+        if (n < 0 && errno != EINTR) {
+            std::cout << "epoll_wait: " << strerror(errno) << std::endl;
+            return;
+        }
+        for (int i = 0; i < n; i++) {
+            if (events[i].data.ptr == nullptr) {
+                accept_connections();
+            } else {
+                handle(static_cast<Connection*>(events[i].data.ptr));
+            }
+        }
+    }
+}
+
+void EventLoop::accept_connections() {
+    while (true) {
+        int fd = accept4(_listen_fd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) {
+            if (errno == EINTR || errno == ECONNABORTED) {
+                continue;
+            }
+            if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                std::cout << "accept: " << strerror(errno) << std::endl; // EMFILE 等，等下一个连接到来时再试
+            }
+            return;
+        }
+        int one = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+        Connection* c = new Connection();
+        c->fd = fd;
+        if (static_cast<size_t>(fd) >= _connections.size()) {
+            _connections.resize(fd + 1, nullptr);
+        }
+        _connections[fd] = c;
+        _stats.clients.fetch_add(1, std::memory_order_relaxed); // 在 epoll_ctl 之前，失败时 close_connection 会减掉
+        _stats.connections.fetch_add(1, std::memory_order_relaxed);
+        epoll_event event;
+        event.events = EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET;
+        event.data.ptr = c;
+        if (epoll_ctl(_epoll_fd, EPOLL_CTL_ADD, fd, &event) != 0) {
+            std::cout << "epoll_ctl: " << strerror(errno) << std::endl;
+            close_connection(c);
+            continue;
+        }
+        handle(c); // 连接建立时可能已经有数据，边缘触发不会再通知
+    }
+}
+
+// 边缘触发：每一步都做到不能再做为止，三步都没有进展时说明在等新数据或等 socket 可写，下次事件到来时继续
+void EventLoop::handle(Connection* c) {
+    bool failed = false;
+    while (true) {
+        bool progress = false;
+        if (!c->eof && !c->closing && c->pending_output() < SERVER_OUTPUT_LIMIT) {
+            progress |= read_input(c, failed);
+        }
+        progress |= process(c);
+        progress |= flush(c, failed);
+        if (failed) {
+            close_connection(c);
+            return;
+        }
+        if (!progress) {
+            break;
+        }
+    }
+    if ((c->eof || c->closing) && c->pending_output() == 0) {
+        close_connection(c);
+    }
+}
+
+bool EventLoop::read_input(Connection* c, bool& failed) {
+    bool progress = false;
+    // 每次最多读 4 块就先执行，输入缓冲区不会因为一次读太多而变得很大
+    for (int i = 0; i < 4; i++) {
+        ssize_t n = read(c->fd, _read_buffer, sizeof(_read_buffer));
+        if (n > 0) {
+            c->in.append(_read_buffer, n);
+            progress = true;
+            continue;
+        }
+        if (n == 0) {
+            c->eof = true;
+            return true;
+        }
+        if (errno == EINTR) {
+            continue;
+        }
+        if (errno != EAGAIN && errno != EWOULDBLOCK) {
+            failed = true;
+        }
+        break;
+    }
+    return progress;
+}
+
+bool EventLoop::process(Connection* c) {
+    bool progress = false;
+    while (!c->closing && c->pending_output() < SERVER_OUTPUT_LIMIT && c->in_pos < c->in.size()) {
+        size_t consumed = 0;
+        const char* error = nullptr;
+        RespParseResult result = resp_parse_command(c->in.data() + c->in_pos, c->in.size() - c->in_pos, _args,
+                                                    consumed, error);
+        if (result == RESP_INCOMPLETE) {
+            if (c->in.size() - c->in_pos > RESP_MAX_BULK_LENGTH + RESP_MAX_INLINE_LENGTH) {
+                resp_append_error(c->out, "ERR Protocol error: request too large");
+                c->closing = true;
+                progress = true;
+            }
+            break;
+        }
+        progress = true;
+        if (result == RESP_PROTOCOL_ERROR) {
+            resp_append_error(c->out, error);
+            c->closing = true;
+            break;
+        }
+        if (!_args.empty()) {
+            execute(c, _args); // _args 指向 c->in，执行完才移动 in_pos
+            _stats.commands.fetch_add(1, std::memory_order_relaxed);
+        }
+        c->in_pos += consumed;
+    }
+    if (c->in_pos == c->in.size()) {
+        c->in.clear();
+        c->in_pos = 0;
+    } else if (c->in_pos > SERVER_READ_CHUNK) {
+        c->in.erase(0, c->in_pos);
+        c->in_pos = 0;
+    }
+    return progress;
+}
+
+bool EventLoop::flush(Connection* c, bool& failed) {
+    bool progress = false;
+    while (c->pending_output() > 0) {
+        ssize_t n = send(c->fd, c->out.data() + c->out_pos, c->pending_output(), MSG_NOSIGNAL);
+        if (n > 0) {
+            c->out_pos += n;
+            progress = true;
+            continue;
+        }
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK) {
+            failed = true;
+        }
+        break;
+    }
+    if (c->pending_output() == 0) {
+        if (c->out.capacity() > SERVER_OUTPUT_LIMIT) {
+            std::string().swap(c->out); // 大的回复发完后归还内存
+        } else {
+            c->out.clear();
+        }
+        c->out_pos = 0;
+    } else if (c->out_pos > SERVER_READ_CHUNK) {
+        c->out.erase(0, c->out_pos);
+        c->out_pos = 0;
+    }
+    return progress;
+}
+
+void EventLoop::close_connection(Connection* c) {
+    if (_connections[c->fd] == c) {
+        _connections[c->fd] = nullptr;
+        _stats.clients.fetch_sub(1, std::memory_order_relaxed);
+    }
+    close(c->fd); // 关闭时自动从 epoll 中移除
+    delete c;
+}
+
+void EventLoop::execute(Connection* c, const std::vector<std::string_view>& args) {
+    std::string_view name = args[0];
+    if (resp_equals(name, "GET")) {
+        command_get(c, args);
+    } else if (resp_equals(name, "SET")) {
+        command_set(c, args);
+    } else if (resp_equals(name, "DEL")) {
+        command_del(c, args);
+    } else if (resp_equals(name, "EXISTS")) {
+        command_exists(c, args);
+    } else if (resp_equals(name, "SCAN")) {
+        command_scan(c, args);
+    } else if (resp_equals(name, "INFO")) {
+        command_info(c, args);
+    } else if (resp_equals(name, "PING")) {
+        if (args.size() > 2) {
+            wrong_arity(c, name);
+        } else if (args.size() == 2) {
+            resp_append_bulk(c->out, args[1]);
+        } else {
+            resp_append_simple(c->out, "PONG");
+        }
+    } else if (resp_equals(name, "ECHO")) {
+        if (args.size() != 2) {
+            wrong_arity(c, name);
+        } else {
+            resp_append_bulk(c->out, args[1]);
+        }
+    } else if (resp_equals(name, "DBSIZE")) {
+        resp_append_integer(c->out, _server.store.size());
+    } else if (resp_equals(name, "QUIT")) {
+        resp_append_simple(c->out, "OK");
+        c->closing = true;
+    } else if (resp_equals(name, "COMMAND") || resp_equals(name, "CONFIG")) {
+        resp_append_array(c->out, 0); // redis-cli 启动时取命令文档、redis-benchmark 取配置，都能处理空数组
+    } else {
+        std::string message = "ERR unknown command '";
+        message.append(name.data(), name.size() < 128 ? name.size() : 128);
+        message += "'";
+        resp_append_error(c->out, message);
+    }
+}
+
+void EventLoop::command_get(Connection* c, const std::vector<std::string_view>& args) {
+    if (args.size() != 2) {
+        wrong_arity(c, args[0]);
+        return;
+    }
+    // StringKey 直接引用请求缓冲区里的键，查找时不复制；值在持锁期间直接编码进回复
+    std::string& out = c->out;
+    bool found = _server.store.get_with(StringKey(args[1]), [&out](const std::string& value) {
+        resp_append_bulk(out, value);
+    });
+    if (found) {
+        _stats.hits.fetch_add(1, std::memory_order_relaxed);
+    } else {
+        _stats.misses.fetch_add(1, std::memory_order_relaxed);
+        resp_append_null(out);
+    }
+}
+
+void EventLoop::command_set(Connection* c, const std::vector<std::string_view>& args) {
+    if (args.size() < 3) {
+        wrong_arity(c, args[0]);
+        return;
+    }
+    if (args[1].size() > SERVER_MAX_KEY_LENGTH) {
+        resp_append_error(c->out, "ERR key too long");
+        return;
+    }
+    int64_t expire_time = 0;
+    for (size_t i = 3; i < args.size(); i++) {
+        bool seconds = resp_equals(args[i], "EX");
+        if ((!seconds && !resp_equals(args[i], "PX")) || expire_time != 0 || i + 1 == args.size()) {
+            resp_append_error(c->out, "ERR syntax error");
+            return;
+        }
+        int64_t amount;
+        if (!resp_parse_int(args[++i], amount)) {
+            resp_append_error(c->out, "ERR value is not an integer or out of range");
+            return;
+        }
+        if (amount <= 0 || amount > (seconds ? INT64_MAX / 1000 : INT64_MAX) / 2) {
+            resp_append_error(c->out, "ERR invalid expire time in 'set' command");
+            return;
+        }
+        expire_time = expiry_now_ms() + (seconds ? amount * 1000 : amount);
+    }
+    WriteBatch<StringKey, std::string> batch;
+    batch.put(StringKey(args[1]), std::string(args[2]), expire_time);
+    _server.store.write(batch);
+    resp_append_simple(c->out, "OK");
+}
+
+// 先判断存在再删除，两步之间其他连接可能修改同一个键，返回的个数在并发删除时可能偏大
+void EventLoop::command_del(Connection* c, const std::vector<std::string_view>& args) {
+    if (args.size() < 2) {
+        wrong_arity(c, args[0]);
+        return;
+    }
+    // 所有键放进一批删除，在分片锁内统计真正删掉的键数（与 delete_element 相同，但不打印）
+    WriteBatch<StringKey, std::string> batch;
+    for (size_t i = 1; i < args.size(); i++) {
+        batch.remove(StringKey(args[i]));
+    }
+    resp_append_integer(c->out, static_cast<int64_t>(_server.store.write(batch)));
+}
+
+void EventLoop::command_exists(Connection* c, const std::vector<std::string_view>& args) {
+    if (args.size() < 2) {
+        wrong_arity(c, args[0]);
+        return;
+    }
+    int64_t count = 0;
+    for (size_t i = 1; i < args.size(); i++) {
+        if (_server.store.contains(StringKey(args[i]))) {
+            count++;
+        }
+    }
+    resp_append_integer(c->out, count);
+}
+
+// 游标 0 从最小的键开始；每次访问 COUNT 个键（MATCH 在访问之后过滤，所以返回的可能更少），
+// 没访问满说明已到末尾，返回游标 0。遍历期间一直存在的键都会返回，新增和删除的键可能返回也可能不返回
+void EventLoop::command_scan(Connection* c, const std::vector<std::string_view>& args) {
+    if (args.size() < 2 || args.size() % 2 != 0) {
+        resp_append_error(c->out, args.size() < 2 ? "ERR wrong number of arguments for 'scan' command" : "ERR syntax error");
+        return;
+    }
+    int64_t cursor;
+    if (!resp_parse_size(args[1], INT64_MAX, cursor)) {
+        resp_append_error(c->out, "ERR invalid cursor");
+        return;
+    }
+    std::string_view pattern;
+    bool has_pattern = false;
+    int64_t count = SERVER_SCAN_COUNT;
+    for (size_t i = 2; i < args.size(); i += 2) {
+        if (resp_equals(args[i], "MATCH")) {
+            pattern = args[i + 1];
+            has_pattern = !(pattern.size() == 1 && pattern[0] == '*');
+        } else if (resp_equals(args[i], "COUNT")) {
+            if (!resp_parse_int(args[i + 1], count)) {
+                resp_append_error(c->out, "ERR value is not an integer or out of range");
+                return;
+            }
+            if (count < 1) {
+                resp_append_error(c->out, "ERR syntax error");
+                return;
+            }
+        } else {
+            resp_append_error(c->out, "ERR syntax error");
+            return;
+        }
+    }
+
+    std::string begin;
+    if (cursor != 0 && !_server.cursors.find(static_cast<uint64_t>(cursor), begin)) {
+        resp_append_error(c->out, "ERR invalid cursor");
+        return;
+    }
+    std::vector<std::string> keys;
+    std::string last;
+    size_t visited = _server.store.scan(StringKey(begin), _server.scan_end, static_cast<size_t>(count),
+        [&](const StringKey& key, const std::string&) {
+            if (!has_pattern || resp_glob_match(pattern.data(), pattern.size(), key.data(), key.size())) {
+                keys.push_back(key.str());
+            }
+            last.assign(key.data(), key.size());
+        });
+    uint64_t next = 0;
+    if (visited == static_cast<size_t>(count)) {
+        last.push_back('\0'); // 比 last 大的最小的键
+        next = _server.cursors.save(std::move(last));
+    }
+
+    resp_append_array(c->out, 2);
+    resp_append_bulk(c->out, std::to_string(next));
+    resp_append_array(c->out, keys.size());
+    for (const std::string& key : keys) {
+        resp_append_bulk(c->out, key);
+    }
+}
+
+void EventLoop::command_info(Connection* c, const std::vector<std::string_view>& args) {
+    if (args.size() > 2) {
+        wrong_arity(c, args[0]);
+        return;
+    }
+    std::string_view section = args.size() == 2 ? args[1] : std::string_view("default");
+    bool all = resp_equals(section, "ALL") || resp_equals(section, "EVERYTHING");
+    bool by_default = all || resp_equals(section, "DEFAULT");
+    auto wanted = [&](const char* name) { return by_default || resp_equals(section, name); };
+
+    int64_t clients = 0;
+    uint64_t connections = 0, commands = 0, hits = 0, misses = 0;
+    for (const std::unique_ptr<EventLoop>& loop : _server.loops) {
+        const LoopStats& s = loop->stats();
+        clients += s.clients.load(std::memory_order_relaxed);
+        connections += s.connections.load(std::memory_order_relaxed);
+        commands += s.commands.load(std::memory_order_relaxed);
+        hits += s.hits.load(std::memory_order_relaxed);
+        misses += s.misses.load(std::memory_order_relaxed);
+    }
+
+    std::string info;
+    if (wanted("SERVER")) {
+        auto uptime = std::chrono::steady_clock::now() - _server.started;
+        info += "# Server\r\n";
+        info += "process_id:" + std::to_string(getpid()) + "\r\n";
+        info += "tcp_port:" + std::to_string(_server.options.port) + "\r\n";
+        info += "uptime_in_seconds:" +
+                std::to_string(std::chrono::duration_cast<std::chrono::seconds>(uptime).count()) + "\r\n";
+        info += "io_threads:" + std::to_string(_server.loops.size()) + "\r\n";
+        info += "shards:" + std::to_string(_server.store.shard_count()) + "\r\n\r\n";
+    }
+    if (wanted("CLIENTS")) {
+        info += "# Clients\r\n";
+        info += "connected_clients:" + std::to_string(clients) + "\r\n\r\n";
+    }
+    if (wanted("STATS")) {
+        SkipListStats stats = _server.store.stats();
+        info += "# Stats\r\n";
+        info += "total_connections_received:" + std::to_string(connections) + "\r\n";
+        info += "total_commands_processed:" + std::to_string(commands) + "\r\n";
+        info += "keyspace_hits:" + std::to_string(hits) + "\r\n";
+        info += "keyspace_misses:" + std::to_string(misses) + "\r\n";
+        info += "expired_keys:" + std::to_string(stats.expired_reclaimed) + "\r\n";
+        info += "skiplist_max_level:" + std::to_string(stats.max_level) + "\r\n";
+        info += "skiplist_mean_hops:" + std::to_string(stats.mean_hops()) + "\r\n\r\n";
+    }
+    if (all || resp_equals(section, "MEMORY")) { // 要遍历所有节点，默认不输出
+        MemoryUsage memory = _server.store.memory_usage();
+        info += "# Memory\r\n";
+        info += "used_memory:" + std::to_string(memory.total()) + "\r\n";
+        info += "used_memory_nodes:" + std::to_string(memory.nodes + memory.towers) + "\r\n";
+        info += "used_memory_keys:" + std::to_string(memory.keys) + "\r\n";
+        info += "used_memory_values:" + std::to_string(memory.values) + "\r\n\r\n";
+    }
+    if (wanted("KEYSPACE")) {
+        info += "# Keyspace\r\n";
+        info += "db0:keys=" + std::to_string(_server.store.size()) + "\r\n";
+    }
+    resp_append_bulk(c->out, info);
+}
+
+bool Server::start() {
+    int cpus = static_cast<int>(std::thread::hardware_concurrency());
+    if (cpus < 1) {
+        cpus = 1;
+    }
+    int threads = options.threads > 0 ? options.threads : cpus;
+    for (int i = 0; i < threads; i++) {
+        loops.emplace_back(new EventLoop(*this, i));
+        if (!loops.back()->listen(options.port)) {
+            return false;
+        }
+    }
+    for (int i = 0; i < threads; i++) {
+        _threads.emplace_back([this, i] { loops[i]->run(); });
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(i % cpus, &set);
+        pthread_setaffinity_np(_threads.back().native_handle(), sizeof(set), &set);
+    }
+    std::cout << "listening on port " << options.port << " with " << threads << " I/O threads, "
+              << options.shards << " shards" << std::endl;
+    return true;
+}
+
+void Server::wait() {
+    while (!g_stop.load()) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(SERVER_EXPIRE_INTERVAL_MS));
+        store.active_expire_cycle(SERVER_EXPIRE_BUDGET_US);
+    }
+    for (std::thread& thread : _threads) {
+        thread.join();
+    }
+    std::cout << "shutting down" << std::endl;
+}
+
+// 连接数受文件描述符上限限制，启动时把软上限提到硬上限
+static void raise_fd_limit() {
+    rlimit limit;
+    if (getrlimit(RLIMIT_NOFILE, &limit) == 0 && limit.rlim_cur < limit.rlim_max) {
+        limit.rlim_cur = limit.rlim_max;
+        setrlimit(RLIMIT_NOFILE, &limit);
+    }
+}
+
+int main(int argc, char* argv[]) {
+    ServerOptions options;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        std::string name = argv[i];
+        int value = atoi(argv[i + 1]);
+        if (name == "--port") {
+            options.port = value;
+        } else if (name == "--threads") {
+            options.threads = value;
+        } else if (name == "--shards") {
+            options.shards = value;
+        } else if (name == "--max-level") {
+            options.max_level = value;
+        } else if (name == "--cache") {
+            options.cache = value;
+        } else {
+            std::cout << "unknown option " << name << std::endl;
+            return 1;
+        }
+    }
+    if (argc % 2 == 0) {
+        std::cout << "missing value for option " << argv[argc - 1] << std::endl;
+        return 1;
+    }
+
+    signal(SIGPIPE, SIG_IGN);
+    signal(SIGINT, handle_signal);
+    signal(SIGTERM, handle_signal);
+    raise_fd_limit();
+
+    Server server(options);
+    if (!server.start()) {
+        return 1;
+    }
+    server.wait();
+    return 0;
+}
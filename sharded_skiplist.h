@@ -0,0 +1,483 @@
+#ifndef SHARDED_SKIPLIST_H
+#define SHARDED_SKIPLIST_H
+
+#include <cstdint>
+#include <vector>
+#include <queue>
+#include <functional>
+#include <tuple>
+#include "LRU_skiplist.h"
+
+// 分片跳表：按键的哈希把请求路由到 N 个互相独立的 SkipList，
+// 每个分片拥有自己的锁、头节点、层级和 LRU 缓存，不同分片上的操作互不阻塞。
+// 分片内部仍然有序，dump_file / display_list 通过多路归并按全局键序输出。
+
+template<typename K, typename V, typename Hash = std::hash<K>>
+class ShardedSkipList {
+
+public:
+    // 构造函数：分片数、每个分片的最大层数、缓存总容量（节点数或字节数，平均分给各分片）
+    ShardedSkipList(int shard_count, int max_level, CacheCapacity lru_capacity);
+
+    ~ShardedSkipList();
+
+    int insert_element(K, V, int64_t expire_time = 0); // 插入元素
+
+    void delete_element(K); // 删除元素
+
+    bool search_element(K); // 查找元素
+
+    std::optional<V> get(const K&); // 返回值的拷贝，找不到时为空
+    bool get(const K&, V&); // 把值写入出参
+    template<typename Visitor>
+    bool get_with(const K&, Visitor); // 持有分片锁时对存储的值调用 visitor(const V&)
+    bool contains(const K&); // 判断键是否存在
+    std::optional<std::pair<V, int64_t>> get_with_ttl(const K&); // 同时返回值和过期时间
+    bool get_with_ttl(const K&, V&, int64_t&); // 把值和过期时间写入出参
+
+    std::vector<std::optional<V>> multi_get(const std::vector<K>&); // 按分片分组后各分片各加一次锁批量查找
+    size_t write(const WriteBatch<K, V>&); // 按分片拆分后同时持有涉及到的分片锁应用，整批原子可见；返回删掉的未过期键数
+
+    void display_list(); // 按全局键序显示所有分片的第0层
+
+    void dump_file(); // 按全局键序保存到文件
+
+    void load_file(); // 从文件加载，按分片分组后各分片批量构建
+
+    void evict_expired_items(); // 清理所有分片的过期元素
+    size_t active_expire_cycle(long budget_us); // 各分片依次主动过期，每个分片分到 budget_us 的一份
+
+    int size(); // 所有分片的元素总数
+
+    int shard_count(); // 分片数量
+
+    SkipListStats stats(); // 所有分片统计的合并快照
+    MemoryUsage memory_usage(); // 所有分片内存占用之和
+    bool dump_stats(const std::string& path = STATS_FILE); // 以 Prometheus 文本格式写入文件
+
+    // 按全局键序遍历所有元素，callback(const K&, const V&)；遍历期间持有全部分片锁
+    template<typename Callback>
+    void for_each(Callback callback);
+
+    // 按全局键序访问 [begin, end) 内的元素，最多 limit 个（0 表示不限），返回访问的个数；
+    // 每轮从各分片拷贝一批再归并，callback(const K&, const V&) 执行时不持有任何分片锁
+    template<typename Callback>
+    size_t scan(const K& begin, const K& end, size_t limit, Callback callback);
+
+private:
+    template<typename Callback>
+    void for_each_node(Callback callback); // 按全局键序对每个节点调用 callback(Node<K, V>*)，持有全部分片锁
+
+    void load_text_file(); // 加载旧的 key:value 文本格式的 dumpFile
+
+    size_t shard_index(const K& key); // 计算键所在分片的下标
+
+    SkipList<K, V>* shard_for(const K& key); // 计算键所在的分片
+
+private:
+    std::vector<SkipList<K, V>*> _shards; // 各个分片
+    Hash _hash; // 键的哈希函数
+    std::ifstream _file_reader; // 读取旧文本格式 dumpFile 的文件对象
+};
+
+template<typename K, typename V, typename Hash>
+ShardedSkipList<K, V, Hash>::ShardedSkipList(int shard_count, int max_level, CacheCapacity lru_capacity) {
+    if (shard_count < 1) {
+        shard_count = 1;
+    }
+    CacheCapacity shard_capacity = lru_capacity;
+    shard_capacity.amount = (lru_capacity.amount + shard_count - 1) / shard_count;
+    if (shard_capacity.amount == 0) {
+        shard_capacity.amount = 1;
+    }
+    for (int i = 0; i < shard_count; i++) {
+        _shards.push_back(new SkipList<K, V>(max_level, shard_capacity));
+    }
+}
+
+template<typename K, typename V, typename Hash>
+ShardedSkipList<K, V, Hash>::~ShardedSkipList() {
+    if (_file_reader.is_open()) {
+        _file_reader.close();
+    }
+    for (size_t i = 0; i < _shards.size(); i++) {
+        delete _shards[i];
+    }
+}
+
+template<typename K, typename V, typename Hash>
+size_t ShardedSkipList<K, V, Hash>::shard_index(const K& key) {
+    // std::hash 对整数是恒等映射，再乘一个奇数常量打散低位，避免连续键挤在同一分片
+    uint64_t h = static_cast<uint64_t>(_hash(key)) * 0x9E3779B97F4A7C15ULL;
+    return (h >> 32) % _shards.size();
+}
+
+template<typename K, typename V, typename Hash>
+SkipList<K, V>* ShardedSkipList<K, V, Hash>::shard_for(const K& key) {
+    return _shards[shard_index(key)];
+}
+
+template<typename K, typename V, typename Hash>
+int ShardedSkipList<K, V, Hash>::insert_element(const K key, const V value, int64_t expire_time) {
+    return shard_for(key)->insert_element(key, value, expire_time);
+}
+
+template<typename K, typename V, typename Hash>
+void ShardedSkipList<K, V, Hash>::delete_element(K key) {
+    shard_for(key)->delete_element(key);
+}
+
+template<typename K, typename V, typename Hash>
+bool ShardedSkipList<K, V, Hash>::search_element(K key) {
+    return shard_for(key)->search_element(key);
+}
+
+template<typename K, typename V, typename Hash>
+std::optional<V> ShardedSkipList<K, V, Hash>::get(const K& key) {
+    return shard_for(key)->get(key);
+}
+
+template<typename K, typename V, typename Hash>
+bool ShardedSkipList<K, V, Hash>::get(const K& key, V& value) {
+    return shard_for(key)->get(key, value);
+}
+
+template<typename K, typename V, typename Hash>
+template<typename Visitor>
+bool ShardedSkipList<K, V, Hash>::get_with(const K& key, Visitor visitor) {
+    return shard_for(key)->get_with(key, visitor);
+}
+
+template<typename K, typename V, typename Hash>
+bool ShardedSkipList<K, V, Hash>::contains(const K& key) {
+    return shard_for(key)->contains(key);
+}
+
+template<typename K, typename V, typename Hash>
+std::optional<std::pair<V, int64_t>> ShardedSkipList<K, V, Hash>::get_with_ttl(const K& key) {
+    return shard_for(key)->get_with_ttl(key);
+}
+
+template<typename K, typename V, typename Hash>
+bool ShardedSkipList<K, V, Hash>::get_with_ttl(const K& key, V& value, int64_t& expire_time) {
+    return shard_for(key)->get_with_ttl(key, value, expire_time);
+}
+
+template<typename K, typename V, typename Hash>
+std::vector<std::optional<V>> ShardedSkipList<K, V, Hash>::multi_get(const std::vector<K>& keys) {
+    // 按分片分组，记下每个键在原数组中的位置，查完后放回原位
+    std::vector<std::vector<K>> shard_keys(_shards.size());
+    std::vector<std::vector<size_t>> positions(_shards.size());
+    for (size_t i = 0; i < keys.size(); i++) {
+        size_t s = shard_index(keys[i]);
+        shard_keys[s].push_back(keys[i]);
+        positions[s].push_back(i);
+    }
+
+    std::vector<std::optional<V>> values(keys.size());
+    for (size_t s = 0; s < _shards.size(); s++) {
+        if (shard_keys[s].empty()) {
+            continue;
+        }
+        std::vector<std::optional<V>> shard_values = _shards[s]->multi_get(shard_keys[s]);
+        for (size_t j = 0; j < shard_values.size(); j++) {
+            values[positions[s][j]] = std::move(shard_values[j]);
+        }
+    }
+    return values;
+}
+
+template<typename K, typename V, typename Hash>
+size_t ShardedSkipList<K, V, Hash>::write(const WriteBatch<K, V>& batch) {
+    if (batch.size() == 1) {
+        return shard_for(batch.ops()[0].key)->write(batch); // 单个键（服务端的 SET、DEL）不用拆分
+    }
+    std::vector<WriteBatch<K, V>> shard_batches(_shards.size());
+    for (const typename WriteBatch<K, V>::Op& op : batch.ops()) {
+        WriteBatch<K, V>& b = shard_batches[shard_index(op.key)];
+        if (op.is_delete) {
+            b.remove(op.key);
+        } else {
+            b.put(op.key, op.value, op.expire_time);
+        }
+    }
+    std::vector<std::vector<size_t>> orders(_shards.size());
+    for (size_t s = 0; s < _shards.size(); s++) {
+        orders[s] = shard_batches[s].sorted_order();
+    }
+
+    // 和 for_each 一样按分片下标顺序加锁，全部应用完再统一解锁
+    for (size_t s = 0; s < _shards.size(); s++) {
+        if (!shard_batches[s].empty()) {
+            _shards[s]->_mtx.lock();
+        }
+    }
+    size_t deleted = 0;
+    for (size_t s = 0; s < _shards.size(); s++) {
+        if (!shard_batches[s].empty()) {
+            deleted += _shards[s]->apply_batch(shard_batches[s], orders[s]);
+        }
+    }
+    for (size_t s = _shards.size(); s > 0; s--) {
+        if (!shard_batches[s - 1].empty()) {
+            _shards[s - 1]->_mtx.unlock();
+        }
+    }
+    return deleted;
+}
+
+template<typename K, typename V, typename Hash>
+void ShardedSkipList<K, V, Hash>::evict_expired_items() {
+    for (size_t i = 0; i < _shards.size(); i++) {
+        _shards[i]->evict_expired_items();
+    }
+}
+
+template<typename K, typename V, typename Hash>
+size_t ShardedSkipList<K, V, Hash>::active_expire_cycle(long budget_us) {
+    size_t removed = 0;
+    for (size_t i = 0; i < _shards.size(); i++) {
+        removed += _shards[i]->active_expire_cycle(budget_us / static_cast<long>(_shards.size()));
+    }
+    return removed;
+}
+
+template<typename K, typename V, typename Hash>
+int ShardedSkipList<K, V, Hash>::size() {
+    int count = 0;
+    for (size_t i = 0; i < _shards.size(); i++) {
+        count += _shards[i]->size();
+    }
+    return count;
+}
+
+template<typename K, typename V, typename Hash>
+int ShardedSkipList<K, V, Hash>::shard_count() {
+    return static_cast<int>(_shards.size());
+}
+
+template<typename K, typename V, typename Hash>
+SkipListStats ShardedSkipList<K, V, Hash>::stats() {
+    SkipListStats snapshot;
+    for (size_t i = 0; i < _shards.size(); i++) {
+        snapshot.merge(_shards[i]->stats());
+    }
+    return snapshot;
+}
+
+template<typename K, typename V, typename Hash>
+MemoryUsage ShardedSkipList<K, V, Hash>::memory_usage() {
+    MemoryUsage usage;
+    for (size_t i = 0; i < _shards.size(); i++) {
+        usage.merge(_shards[i]->memory_usage());
+    }
+    return usage;
+}
+
+template<typename K, typename V, typename Hash>
+bool ShardedSkipList<K, V, Hash>::dump_stats(const std::string& path) {
+    return stats().dump_prometheus(path);
+}
+
+// 多路归并：每个分片的第0层已经有序，用小顶堆每次取出最小的键
+template<typename K, typename V, typename Hash>
+template<typename Callback>
+void ShardedSkipList<K, V, Hash>::for_each_node(Callback callback) {
+    // 按分片下标顺序加锁，保证多个遍历者之间不会死锁
+    for (size_t i = 0; i < _shards.size(); i++) {
+        _shards[i]->_mtx.lock();
+    }
+
+    auto greater = [](Node<K, V>* a, Node<K, V>* b) { return b->get_key() < a->get_key(); };
+    std::priority_queue<Node<K, V>*, std::vector<Node<K, V>*>, decltype(greater)> heap(greater);
+    for (size_t i = 0; i < _shards.size(); i++) {
+        Node<K, V>* node = _shards[i]->_header->forward[0];
+        if (node != NULL) {
+            heap.push(node);
+        }
+    }
+    while (!heap.empty()) {
+        Node<K, V>* node = heap.top();
+        heap.pop();
+        callback(node);
+        if (node->forward[0] != NULL) {
+            heap.push(node->forward[0]);
+        }
+    }
+
+    for (size_t i = _shards.size(); i > 0; i--) {
+        _shards[i - 1]->_mtx.unlock();
+    }
+}
+
+// 分批归并：各分片每轮最多拷贝 SCAN_CHUNK_SIZE 个（limit 更小时只拷贝还需要的个数），只输出不超过"已满批次中最小的末尾键"的部分，
+// 更大的键可能还有分片没读到，留到下一轮从该键之后重新读取
+template<typename K, typename V, typename Hash>
+template<typename Callback>
+size_t ShardedSkipList<K, V, Hash>::scan(const K& begin, const K& end, size_t limit, Callback callback) {
+    size_t count = 0;
+    K from = begin;
+    bool inclusive = true;
+    std::vector<std::vector<std::pair<K, V>>> batches(_shards.size());
+    while (true) {
+        if (limit != 0 && count >= limit) {
+            return count;
+        }
+        const K* cutoff = nullptr;
+        size_t chunk = limit == 0 ? SCAN_CHUNK_SIZE : std::min<size_t>(SCAN_CHUNK_SIZE, limit - count);
+        for (size_t i = 0; i < _shards.size(); i++) {
+            batches[i].clear();
+            _shards[i]->read_forward(&from, inclusive, chunk, batches[i]);
+            if (batches[i].size() == chunk &&
+                (cutoff == nullptr || batches[i].back().first < *cutoff)) {
+                cutoff = &batches[i].back().first;
+            }
+        }
+
+        typedef std::pair<size_t, size_t> Cursor; // (分片下标, 批次内下标)
+        auto greater = [&batches](const Cursor& a, const Cursor& b) {
+            return batches[b.first][b.second].first < batches[a.first][a.second].first;
+        };
+        std::priority_queue<Cursor, std::vector<Cursor>, decltype(greater)> heap(greater);
+        for (size_t i = 0; i < batches.size(); i++) {
+            if (!batches[i].empty()) {
+                heap.push(Cursor(i, 0));
+            }
+        }
+        while (!heap.empty()) {
+            Cursor c = heap.top();
+            heap.pop();
+            const std::pair<K, V>& item = batches[c.first][c.second];
+            if (cutoff != nullptr && *cutoff < item.first) {
+                break;
+            }
+            if (!(item.first < end) || (limit != 0 && count >= limit)) {
+                return count;
+            }
+            callback(item.first, item.second);
+            count++;
+            if (c.second + 1 < batches[c.first].size()) {
+                heap.push(Cursor(c.first, c.second + 1));
+            }
+        }
+        if (cutoff == nullptr) {
+            return count; // 所有分片都已读完
+        }
+        from = *cutoff;
+        inclusive = false;
+    }
+}
+
+template<typename K, typename V, typename Hash>
+template<typename Callback>
+void ShardedSkipList<K, V, Hash>::for_each(Callback callback) {
+    for_each_node([&callback](Node<K, V>* node) {
+        callback(node->get_key(), node->get_value());
+    });
+}
+
+template<typename K, typename V, typename Hash>
+void ShardedSkipList<K, V, Hash>::display_list() {
+    std::cout << "\n*****Sharded Skip List (" << _shards.size() << " shards)*****" << "\n";
+    std::cout << "Level 0: ";
+    for_each([](const K& key, const V& value) {
+        std::cout << key << ":" << value << ";";
+    });
+    std::cout << std::endl;
+}
+
+template<typename K, typename V, typename Hash>
+void ShardedSkipList<K, V, Hash>::dump_file() {
+    std::cout << "dump_file-----------------" << std::endl;
+    // 与单个跳表相同的二进制快照格式，记录按全局键序写出
+    SnapshotWriter writer;
+    bool ok = writer.open(STORE_FILE);
+    for_each_node([&writer, &ok](Node<K, V>* node) {
+        if (ok) {
+            ok = writer.add(node->get_key(), node->get_value(), node->get_expire_time());
+        }
+    });
+    if (!ok || !writer.finish()) {
+        std::cout << "dump_file failed: " << writer.error() << std::endl;
+    }
+}
+
+template<typename K, typename V, typename Hash>
+void ShardedSkipList<K, V, Hash>::load_file() {
+    std::cout << "load_file-----------------" << std::endl;
+    if (!SnapshotReader::is_snapshot(STORE_FILE)) {
+        load_text_file();
+        return;
+    }
+
+    SnapshotReader reader;
+    if (!reader.open(STORE_FILE)) {
+        std::cout << "load_file failed: " << reader.error() << std::endl;
+        return;
+    }
+
+    // 快照按全局键序写出，路由到每个分片的子序列同样有序，可以直接交给 bulk_load
+    typedef std::tuple<K, V, int64_t> Item;
+    std::vector<std::vector<Item>> shard_items(_shards.size());
+    int64_t now = expiry_now_ms();
+    K key;
+    V value;
+    int64_t expire;
+    while (reader.next(key, value, expire)) {
+        if (expire == 0 || expire > now) {
+            shard_items[shard_index(key)].push_back(Item(key, value, expire));
+        }
+    }
+    if (!reader.error().empty()) {
+        std::cout << "load_file stopped early: " << reader.error() << std::endl;
+    }
+
+    size_t loaded = 0;
+    for (size_t s = 0; s < _shards.size(); s++) {
+        size_t i = 0;
+        std::vector<Item>& items = shard_items[s];
+        loaded += _shards[s]->bulk_load([&items, &i](K& k, V& v, int64_t& expire_time) {
+            if (i == items.size()) {
+                return false;
+            }
+            k = std::get<0>(items[i]);
+            v = std::get<1>(items[i]);
+            expire_time = std::get<2>(items[i]);
+            i++;
+            return true;
+        });
+    }
+    std::cout << "loaded " << loaded << " keys" << std::endl;
+}
+
+template<typename K, typename V, typename Hash>
+void ShardedSkipList<K, V, Hash>::load_text_file() {
+    _file_reader.open(STORE_FILE);
+    std::string line;
+    // 文件按全局键序写出，路由到每个分片的子序列同样有序，可以直接交给 bulk_load
+    std::vector<std::vector<std::pair<K, V>>> shard_items(_shards.size());
+    while (getline(_file_reader, line)) {
+        size_t pos = line.find(delimiter);
+        if (line.empty() || pos == std::string::npos) {
+            continue;
+        }
+        std::string key = line.substr(0, pos);
+        std::string value = line.substr(pos + 1);
+        if (key.empty() || value.empty()) {
+            continue;
+        }
+        K k;
+        V v;
+        if (snapshot_parse_text(key, k) && snapshot_parse_text(value, v)) {
+            shard_items[shard_index(k)].push_back(std::make_pair(k, v));
+        }
+    }
+    _file_reader.close();
+    size_t loaded = 0;
+    for (size_t s = 0; s < _shards.size(); s++) {
+        loaded += _shards[s]->bulk_load(shard_items[s]);
+    }
+    std::cout << "loaded " << loaded << " keys from text dump" << std::endl;
+}
+
+#endif
@@ -4,10 +4,30 @@
 #include <cstring>
 #include <mutex>
 #include <fstream>
-
+#include <new>
+#include <type_traits>
+#include <optional>
+#include <vector>
+#include <algorithm>
+#include <thread>
+#include <atomic>
+#include <cerrno>
+#include <unistd.h>
+#include <sys/wait.h>
+#include "node_arena.h"
+#include "level_generator.h"
+#include "skiplist_stats.h"
+#include "skiplist_iterator.h"
+#include "write_batch.h"
+#include "snapshot_format.h"
+#include "write_ahead_log.h"
+#include "string_key.h"
+
+#ifndef STORE_FILE
 #define STORE_FILE "store/dumpFile"
+#endif
+#define SCAN_CHUNK_SIZE 1024    // nodes visited by scan() per lock acquisition
 
-std::mutex mtx;     // mutex for critical section
 std::string delimiter = ":";
 
 //Class template to implement node
@@ -20,22 +40,23 @@ public:
 
     Node(K k, V v, int); 
 
-    ~Node();
-
-    K get_key() const;
+    const K& get_key() const; // by reference, so traversal never copies the key
 
-    V get_value() const;
+    const V& get_value() const;
 
     void set_value(V);
-    
-    // Linear array to hold pointers to next node of different level
-    Node<K, V> **forward;
 
     int node_level;
 
 private:
     K key;
     V value;
+
+public:
+    // Array to hold pointers to next node of different level. It must stay the last
+    // member: the node is allocated with room for level+1 entries, so the tower lives
+    // in the same block as the node instead of a separate heap array.
+    Node<K, V> *forward[1];
 };
 
 template<typename K, typename V> 
@@ -44,25 +65,17 @@ Node<K, V>::Node(const K k, const V v, int level) {
     this->value = v;
     this->node_level = level; 
 
-    // level + 1, because array index is from 0 - level
-    this->forward = new Node<K, V>*[level+1];
-    
-	// Fill forward array with 0(NULL) 
+	// Fill forward array with 0(NULL), level + 1 because array index is from 0 - level
     memset(this->forward, 0, sizeof(Node<K, V>*)*(level+1));
 };
 
 template<typename K, typename V> 
-Node<K, V>::~Node() {
-    delete []forward;
-};
-
-template<typename K, typename V> 
-K Node<K, V>::get_key() const {
+const K& Node<K, V>::get_key() const {
     return key;
 };
 
 template<typename K, typename V> 
-V Node<K, V>::get_value() const {
+const V& Node<K, V>::get_value() const {
     return value;
 };
 template<typename K, typename V> 
@@ -73,51 +86,194 @@ void Node<K, V>::set_value(V value) {
 // Class template for Skip list
 template <typename K, typename V> 
 class SkipList {
+    friend class SkipListIterator<SkipList<K, V>, K, V>;
 
 public: 
+    typedef SkipListIterator<SkipList<K, V>, K, V> Iterator;
+
     SkipList(int);
     ~SkipList();
     int get_random_level();
     Node<K, V>* create_node(K, V, int);
+    void destroy_node(Node<K, V>*);
     int insert_element(K, V);
     void display_list();
     bool search_element(K);
+
+    // lookups that hand the value back to the caller instead of printing it
+    std::optional<V> get(const K&);
+    bool get(const K&, V&);
+    // run visitor(const V&) on the stored value while the list is locked, no copy is made
+    template<typename Visitor>
+    bool get_with(const K&, Visitor);
+    bool contains(const K&);
+
+    // batched access: keys are sorted once and looked up or applied under one lock
+    // acquisition, each key resuming the search from the previous key's predecessors.
+    // multi_get returns one result per key, in the order the keys were given.
+    std::vector<std::optional<V>> multi_get(const std::vector<K>&);
+    // apply every put and remove in batch atomically, see write_batch.h; returns how many
+    // removes found their key
+    size_t write(const WriteBatch<K, V>&);
+
+    // bulk import from key-sorted input in one pass: each key larger than everything in
+    // the list is linked straight after the last node of every level it spans, with no
+    // search and no per-key output. Tower heights follow the key's position (1 + number
+    // of trailing zero bits, a perfectly balanced list) unless random_levels is set.
+    // Keys out of order fall back to a normal search and insert; existing keys are kept,
+    // as in insert_element. next(K&, V&) fills in the next pair and returns false at the
+    // end of input. Returns the number of keys added.
+    template<typename Source>
+    size_t bulk_load(Source next, bool random_levels = false);
+    size_t bulk_load(const std::vector<std::pair<K, V>>&, bool random_levels = false);
+
+    // ordered iteration, see skiplist_iterator.h; iterators copy small batches under the
+    // lock and re-seek, so they stay valid while other threads write
+    Iterator new_iterator();
+    Iterator lower_bound(const K&);     // positioned at the first key >= k
+    Iterator upper_bound(const K&);     // positioned at the first key > k
+    // visit keys in [begin, end) in order, at most limit of them (0 means no limit), and
+    // return how many were visited. callback(const K&, const V&) runs under the lock, which
+    // is released every SCAN_CHUNK_SIZE nodes to let writers in; it must not call back
+    // into this skip list.
+    template<typename Callback>
+    size_t scan(const K& begin, const K& end, size_t limit, Callback callback);
+
     void delete_element(K);
     void dump_file();
     void load_file();
-    //递归删除节点
-    void clear(Node<K,V>*);
     int size();
 
+    // dump_file without stopping traffic: the list is locked only while the log is
+    // rotated and the process forks; the child writes the snapshot from its copy-on-write
+    // view and exits. Returns false if a background save is still running or the fork
+    // fails. dump_file waits for a running background save before writing.
+    bool background_save();
+    bool saving() const { return _saving; }     // a background save is still running
+
+    // write-ahead log, see write_ahead_log.h. Records already in the log at path are
+    // replayed on top of the current contents first, so recovery is load_file() followed
+    // by open_wal(). From then on every effective insert_element, delete_element and
+    // write() is logged and only returns once the record is written (and synced, with
+    // WAL_SYNC_ALWAYS); concurrent writers share one write/fsync. A successful dump_file
+    // empties the log. bulk_load is not logged, dump_file after an import.
+    // Returns false, with the reason printed, if the log cannot be read or opened.
+    bool open_wal(const std::string& path = WAL_FILE, WalSyncPolicy policy = WAL_SYNC_INTERVAL,
+                  int interval_ms = 1000);
+    WriteAheadLog& wal() { return _wal; }
+
+    // snapshot of latency histograms, lock wait/hold times, level distribution and counters
+    SkipListStats stats();
+    // write stats() in Prometheus text format, returns false if the file cannot be written
+    bool dump_stats(const std::string& path = STATS_FILE);
+
+    // probability p that a node also appears on the next level up: SKIPLIST_P_HALF (the
+    // default), SKIPLIST_P_QUARTER, SKIPLIST_P_E or any other value in (0, 1), see
+    // level_generator.h; only nodes inserted afterwards are affected. The maximum level
+    // starts at the value given to the constructor and goes up by one whenever the element
+    // count passes (1/p)^max_level, up to SKIPLIST_LEVEL_LIMIT (or the constructor value if
+    // that is larger); it never shrinks. stats() reports the level_histogram and mean_hops()
+    void set_level_probability(double p);
+
 private:
+    // raise _max_level while the element count exceeds (1/p)^_max_level, caller must hold _mtx
+    void grow_max_level();
+    // load a dump written by the old text dump_file, one key:value per line
+    void load_text_file();
     void get_key_value_from_string(const std::string& str, std::string* key, std::string* value);
     bool is_valid_string(const std::string& str);
+    // descend from the header and return the node holding key, caller must hold _mtx
+    Node<K, V>* find_node(const K&);
+    // first node with key >= k (or > k when inclusive is false), caller must hold _mtx
+    Node<K, V>* find_greater(const K&, bool inclusive);
+    // last node with key < k (or <= k when inclusive is true), nullptr if none
+    Node<K, V>* find_less(const K&, bool inclusive);
+    // finger search: update[] holds the predecessors of a key <= this one (all _header to
+    // start from the top); only the levels that key has moved past are re-walked, starting
+    // at the old predecessor. Leaves the predecessors of key in update[] and returns the
+    // first node >= key, caller must hold _mtx
+    Node<K, V>* finger_seek(const K&, Node<K, V>** update);
+    // apply batch ops in the given key order and return how many removes found their key,
+    // caller must hold _mtx
+    size_t apply_batch(const WriteBatch<K, V>&, const std::vector<size_t>& order);
+    // last node of the list, nullptr if empty
+    Node<K, V>* find_last();
+    // batch readers used by Iterator, a null from means start at the first/last key
+    void read_forward(const K* from, bool inclusive, size_t max, std::vector<std::pair<K, V>>& out);
+    void read_backward(const K* from, bool inclusive, size_t max, std::vector<std::pair<K, V>>& out);
+    // level for the position-th appended key (1-based) when building a balanced list
+    int sequential_level(long position);
+    // release every node, including the header, on teardown
+    void clear();
+    // wait until the log record with sequence seq is written, 0 means nothing was logged
+    void commit_wal(uint64_t seq);
+    // write every node to STORE_FILE without printing, caller must hold _mtx or be the
+    // child forked by background_save()
+    bool write_snapshot(std::string* error);
 
 private:    
-    // Maximum level of the skip list 
+    // Maximum level of the skip list, grows with the element count
     int _max_level;
 
+    // upper bound for _max_level, the header is allocated with this many levels
+    int _level_limit;
+
     // current level of skip list 
     int _skip_list_level;
 
     // pointer to header node 
     Node<K, V> *_header;
 
-    // file operator
-    std::ofstream _file_writer;
+    // reader for dump files still in the old key:value text format
     std::ifstream _file_reader;
 
     // skiplist current element count
     int _element_count;
+
+    // memory pool that nodes and their forward towers are carved from
+    NodeArena _arena;
+
+    // per-thread latency histograms and counters
+    StatsCollector _stats;
+
+    // mutex for critical section, one per skip list instance; records wait and hold time
+    StatsMutex _mtx;
+
+    // number of nodes at each level, maintained under _mtx
+    std::vector<long> _level_counts;
+
+    // random level distribution, p = 1/2 unless set_level_probability is called
+    LevelGenerator _levels;
+
+    // element count above which _max_level goes up by one
+    size_t _grow_at;
+
+    // write-ahead log, records are appended under _mtx so the log order is the list order
+    WriteAheadLog _wal;
+
+    // background_save state: _save_mtx serialises starting a save against dump_file,
+    // _save_thread waits for the child, _saving is set until it has exited
+    std::mutex _save_mtx;
+    std::thread _save_thread;
+    std::atomic<bool> _saving;
 };
 
-// create new node 
+// create new node, the forward tower is allocated together with the node
 template<typename K, typename V>
 Node<K, V>* SkipList<K, V>::create_node(const K k, const V v, int level) {
-    Node<K, V> *n = new Node<K, V>(k, v, level);
+    size_t bytes = sizeof(Node<K, V>) + sizeof(Node<K, V>*) * level;
+    Node<K, V> *n = new (_arena.allocate(bytes, level)) Node<K, V>(k, v, level);
     return n;
 }
 
+// destroy node and hand its memory back to the arena
+template<typename K, typename V>
+void SkipList<K, V>::destroy_node(Node<K, V>* node) {
+    int level = node->node_level;
+    node->~Node<K, V>();
+    _arena.deallocate(node, level);
+}
+
 // Insert given key and value in skip list 
 // return 1 means element exists  
 // return 0 means insert successfully
@@ -144,21 +300,27 @@ level 0         1    4   9 10         30   40  | 50 |  60      70       100
 template<typename K, typename V>
 int SkipList<K, V>::insert_element(const K key, const V value) {
     
-    mtx.lock();
+    StatsScope scope(_stats, STATS_INSERT);
+    uint64_t seq = 0;
+    _mtx.lock();
     Node<K, V> *current = this->_header;
 
     // create update array and initialize it 
     // update is array which put node that the node->forward[i] should be operated later
-    Node<K, V> *update[_max_level+1];
-    memset(update, 0, sizeof(Node<K, V>*)*(_max_level+1));  
+    Node<K, V> *update[_level_limit+1];
+    memset(update, 0, sizeof(Node<K, V>*)*(_level_limit+1));  
 
     // start form highest level of skip list 
+    size_t hops = 0;
     for(int i = _skip_list_level; i >= 0; i--) {
         while(current->forward[i] != NULL && current->forward[i]->get_key() < key) {
             current = current->forward[i]; 
+            hops++;
         }
         update[i] = current;
     }
+    _stats.add(STATS_SEARCH_PATHS);
+    _stats.add(STATS_SEARCH_HOPS, hops);
 
     // reached level 0 and forward pointer to right node, which is desired to insert key.
     current = current->forward[0];
@@ -166,7 +328,7 @@ int SkipList<K, V>::insert_element(const K key, const V value) {
     // if current node have key equal to searched key, we get it
     if (current != NULL && current->get_key() == key) {
         std::cout << "key: " << key << ", exists" << std::endl;
-        mtx.unlock();
+        _mtx.unlock();
         return 1;
     }
 
@@ -195,8 +357,17 @@ int SkipList<K, V>::insert_element(const K key, const V value) {
         }
         std::cout << "Successfully inserted key:" << key << ", value:" << value << std::endl;
         _element_count ++;
+        _level_counts[random_level] ++;
+        grow_max_level();
+
+        if (_wal.is_open()) {
+            std::string record;
+            wal_encode_put(record, key, value);
+            seq = _wal.append(record);
+        }
     }
-    mtx.unlock();
+    _mtx.unlock();
+    commit_wal(seq);
     return 0;
 }
 
@@ -216,46 +387,295 @@ void SkipList<K, V>::display_list() {
     }
 }
 
-// Dump data in memory to file 
+// Dump data in memory to file in the binary snapshot format, see snapshot_format.h.
+// The new file replaces the old one only once it is completely written. Writers are
+// held off for the whole dump so the snapshot matches the point the log is emptied at.
 template<typename K, typename V> 
 void SkipList<K, V>::dump_file() {
 
+    StatsScope scope(_stats, STATS_DUMP);
     std::cout << "dump_file-----------------" << std::endl;
-    _file_writer.open(STORE_FILE);
+    std::lock_guard<std::mutex> save_lock(_save_mtx);
+    // a background save writes the same file
+    if (_save_thread.joinable()) {
+        _save_thread.join();
+    }
+    std::lock_guard<StatsMutex> lock(_mtx);
+    std::string error;
+    if (!write_snapshot(&error)) {
+        std::cout << "dump_file failed: " << error << std::endl;
+        return;
+    }
+    // every logged change is in the snapshot now
+    if (_wal.is_open() && !_wal.reset()) {
+        std::cout << "dump_file: " << _wal.error() << std::endl;
+    }
+}
+
+template<typename K, typename V> 
+bool SkipList<K, V>::write_snapshot(std::string* error) {
+
+    SnapshotWriter writer;
+    bool ok = writer.open(STORE_FILE);
     Node<K, V> *node = this->_header->forward[0]; 
 
-    while (node != NULL) {
-        _file_writer << node->get_key() << ":" << node->get_value() << "\n";
-        std::cout << node->get_key() << ":" << node->get_value() << ";\n";
+    while (ok && node != NULL) {
+        ok = writer.add(node->get_key(), node->get_value());
         node = node->forward[0];
     }
 
-    _file_writer.flush();
-    _file_writer.close();
-    return ;
+    if (!ok || !writer.finish()) {
+        *error = writer.error();
+        return false;
+    }
+    return true;
+}
+
+template<typename K, typename V> 
+bool SkipList<K, V>::background_save() {
+
+    std::lock_guard<std::mutex> save_lock(_save_mtx);
+    if (_saving) {
+        return false;
+    }
+    if (_save_thread.joinable()) {
+        _save_thread.join();
+    }
+
+    pid_t pid;
+    {
+        StatsScope scope(_stats, STATS_BGSAVE_FORK);
+        std::lock_guard<StatsMutex> lock(_mtx);
+        // records from here on go to a fresh log, the old one is dropped once the child succeeds
+        if (_wal.is_open() && !_wal.rotate()) {
+            std::cout << "background_save failed: " << _wal.error() << std::endl;
+            return false;
+        }
+        pid = fork();
+        if (pid == 0) {
+            // only the forking thread exists in the child: take no locks and stay off std::cout
+            std::string error;
+            if (write_snapshot(&error)) {
+                _exit(0);
+            }
+            error = "background_save failed: " + error + "\n";
+            ssize_t written = ::write(STDERR_FILENO, error.data(), error.size());
+            (void)written;
+            _exit(1);
+        }
+    }
+    if (pid < 0) {
+        std::cout << "background_save failed: fork: " << strerror(errno) << std::endl;
+        return false;
+    }
+
+    _saving = true;
+    _save_thread = std::thread([this, pid] {
+        int status = -1;
+        while (waitpid(pid, &status, 0) < 0 && errno == EINTR) {
+        }
+        if (WIFEXITED(status) && WEXITSTATUS(status) == 0) {
+            if (_wal.is_open()) {
+                _wal.drop_rotated();
+            }
+            std::cout << "background_save done" << std::endl;
+        } else {
+            // the rotated log is kept and the next save appends to it
+            std::cout << "background_save failed" << std::endl;
+        }
+        _saving = false;
+    });
+    return true;
 }
 
 // Load data from disk
 template<typename K, typename V> 
 void SkipList<K, V>::load_file() {
 
-    _file_reader.open(STORE_FILE);
     std::cout << "load_file-----------------" << std::endl;
+    if (!SnapshotReader::is_snapshot(STORE_FILE)) {
+        load_text_file();
+        return;
+    }
+
+    SnapshotReader reader;
+    if (!reader.open(STORE_FILE)) {
+        std::cout << "load_file failed: " << reader.error() << std::endl;
+        return;
+    }
+
+    // records are stored in key order, so the file can be linked in one pass
+    int64_t expire_time;
+    size_t loaded = bulk_load([&](K& k, V& v) {
+        return reader.next(k, v, expire_time);
+    });
+    if (!reader.error().empty()) {
+        std::cout << "load_file stopped early: " << reader.error() << std::endl;
+    }
+    std::cout << "loaded " << loaded << " keys" << std::endl;
+}
+
+template<typename K, typename V> 
+bool SkipList<K, V>::open_wal(const std::string& path, WalSyncPolicy policy, int interval_ms) {
+
+    // a log rotated by an unfinished background save comes first
+    WriteBatch<K, V> replayed;
+    size_t rotated_records;
+    size_t records;
+    std::string error;
+    if (!wal_replay(WriteAheadLog::rotated_path(path), replayed, &rotated_records, &error) ||
+        !wal_replay(path, replayed, &records, &error)) {
+        std::cout << "open_wal failed: " << error << std::endl;
+        return false;
+    }
+    records += rotated_records;
+    // log order is kept for equal keys, so the whole log applies as one batch
+    if (!replayed.empty()) {
+        std::lock_guard<StatsMutex> lock(_mtx);
+        apply_batch(replayed, replayed.sorted_order());
+    }
+    std::cout << "replayed " << records << " log records" << std::endl;
+
+    if (!_wal.open(path, policy, interval_ms)) {
+        std::cout << "open_wal failed: " << _wal.error() << std::endl;
+        return false;
+    }
+    return true;
+}
+
+template<typename K, typename V> 
+void SkipList<K, V>::commit_wal(uint64_t seq) {
+
+    if (seq == 0) {
+        return;
+    }
+    StatsScope scope(_stats, STATS_WAL_COMMIT);
+    if (!_wal.commit(seq)) {
+        std::cout << "wal commit failed: " << _wal.error() << std::endl;
+    }
+}
+
+template<typename K, typename V> 
+void SkipList<K, V>::load_text_file() {
+
+    _file_reader.open(STORE_FILE);
     std::string line;
-    std::string* key = new std::string();
-    std::string* value = new std::string();
-    while (getline(_file_reader, line)) {
-        get_key_value_from_string(line, key, value);
-        if (key->empty() || value->empty()) {
+    std::string key;
+    std::string value;
+
+    size_t loaded = bulk_load([&](K& k, V& v) {
+        while (getline(_file_reader, line)) {
+            get_key_value_from_string(line, &key, &value);
+            if (key.empty() || value.empty()) {
+                continue;
+            }
+            if (snapshot_parse_text(key, k) && snapshot_parse_text(value, v)) {
+                return true;
+            }
+        }
+        return false;
+    });
+    std::cout << "loaded " << loaded << " keys from text dump" << std::endl;
+    _file_reader.close();
+}
+
+template<typename K, typename V> 
+template<typename Source>
+size_t SkipList<K, V>::bulk_load(Source next, bool random_levels) {
+
+    StatsScope scope(_stats, STATS_BULK_LOAD);
+    std::lock_guard<StatsMutex> lock(_mtx);
+
+    // tail[i] is the last node on level i, found by one walk down the existing list
+    std::vector<Node<K, V>*> tail(_level_limit + 1, _header);
+    Node<K, V> *current = _header;
+    for (int i = _skip_list_level; i >= 0; i--) {
+        while (current->forward[i] != NULL) {
+            current = current->forward[i];
+        }
+        tail[i] = current;
+    }
+
+    std::vector<Node<K, V>*> update(_level_limit + 1, _header);
+    long position = _element_count;
+    size_t loaded = 0;
+    K key;
+    V value;
+    while (next(key, value)) {
+        if (tail[0] == _header || tail[0]->get_key() < key) {
+            // append: every level the new tower spans ends at tail[i]
+            int level = random_levels ? get_random_level() : sequential_level(++position);
+            if (level > _skip_list_level) {
+                _skip_list_level = level;
+            }
+            Node<K, V>* node = create_node(key, value, level);
+            for (int i = 0; i <= level; i++) {
+                tail[i]->forward[i] = node;
+                tail[i] = node;
+            }
+            _element_count ++;
+            _level_counts[level] ++;
+            grow_max_level();
+            loaded++;
             continue;
         }
-        // Define key as int type
-        insert_element(stoi(*key), *value);
-        std::cout << "key:" << *key << "value:" << *value << std::endl;
+
+        // out of order: same search as insert_element
+        current = _header;
+        for (int i = _skip_list_level; i >= 0; i--) {
+            while (current->forward[i] != NULL && current->forward[i]->get_key() < key) {
+                current = current->forward[i];
+            }
+            update[i] = current;
+        }
+        current = current->forward[0];
+        if (current != NULL && current->get_key() == key) {
+            continue;
+        }
+        int level = get_random_level();
+        if (level > _skip_list_level) {
+            for (int i = _skip_list_level+1; i < level+1; i++) {
+                update[i] = _header;
+            }
+            _skip_list_level = level;
+        }
+        Node<K, V>* node = create_node(key, value, level);
+        for (int i = 0; i <= level; i++) {
+            node->forward[i] = update[i]->forward[i];
+            update[i]->forward[i] = node;
+            // linked right after the old tail, so it is the new last node of this level
+            if (update[i] == tail[i]) {
+                tail[i] = node;
+            }
+        }
+        _element_count ++;
+        _level_counts[level] ++;
+        grow_max_level();
+        loaded++;
     }
-    delete key;
-    delete value;
-    _file_reader.close();
+    return loaded;
+}
+
+template<typename K, typename V> 
+size_t SkipList<K, V>::bulk_load(const std::vector<std::pair<K, V>>& items, bool random_levels) {
+    size_t i = 0;
+    return bulk_load([&items, &i](K& k, V& v) {
+        if (i == items.size()) {
+            return false;
+        }
+        k = items[i].first;
+        v = items[i].second;
+        i++;
+        return true;
+    }, random_levels);
+}
+
+// get_random_level gives level k with probability p^(k-1)(1-p); the position-th key gets
+// 1 + the number of times round(1/p) divides position, which hands out levels in the same
+// proportions (1 + ctz(position) for p = 1/2)
+template<typename K, typename V> 
+int SkipList<K, V>::sequential_level(long position) {
+    return _levels.sequential(position, _max_level);
 }
 
 // Get current SkipList size
@@ -264,6 +684,27 @@ int SkipList<K, V>::size() {
     return _element_count;
 }
 
+template<typename K, typename V> 
+SkipListStats SkipList<K, V>::stats() {
+
+    SkipListStats snapshot;
+    {
+        std::lock_guard<StatsMutex> lock(_mtx);
+        snapshot.element_count = _element_count;
+        snapshot.skip_list_level = _skip_list_level;
+        snapshot.max_level = _max_level;
+        snapshot.level_probability = _levels.probability();
+        snapshot.level_histogram.assign(_level_counts.begin(), _level_counts.begin() + _max_level + 1);
+    }
+    _stats.collect(snapshot);
+    return snapshot;
+}
+
+template<typename K, typename V> 
+bool SkipList<K, V>::dump_stats(const std::string& path) {
+    return stats().dump_prometheus(path);
+}
+
 template<typename K, typename V>
 void SkipList<K, V>::get_key_value_from_string(const std::string& str, std::string* key, std::string* value) {
 
@@ -290,18 +731,24 @@ bool SkipList<K, V>::is_valid_string(const std::string& str) {
 template<typename K, typename V> 
 void SkipList<K, V>::delete_element(K key) {
 
-    mtx.lock();
+    StatsScope scope(_stats, STATS_DELETE);
+    uint64_t seq = 0;
+    _mtx.lock();
     Node<K, V> *current = this->_header; 
-    Node<K, V> *update[_max_level+1];
-    memset(update, 0, sizeof(Node<K, V>*)*(_max_level+1));
+    Node<K, V> *update[_level_limit+1];
+    memset(update, 0, sizeof(Node<K, V>*)*(_level_limit+1));
 
     // start from highest level of skip list
+    size_t hops = 0;
     for (int i = _skip_list_level; i >= 0; i--) {
         while (current->forward[i] !=NULL && current->forward[i]->get_key() < key) {
             current = current->forward[i];
+            hops++;
         }
         update[i] = current;
     }
+    _stats.add(STATS_SEARCH_PATHS);
+    _stats.add(STATS_SEARCH_HOPS, hops);
 
     current = current->forward[0];
     if (current != NULL && current->get_key() == key) {
@@ -322,10 +769,18 @@ void SkipList<K, V>::delete_element(K key) {
         }
 
         std::cout << "Successfully deleted key "<< key << std::endl;
-        delete current;
+        _level_counts[current->node_level] --;
+        destroy_node(current);
         _element_count --;
+
+        if (_wal.is_open()) {
+            std::string record;
+            wal_encode_delete(record, key);
+            seq = _wal.append(record);
+        }
     }
-    mtx.unlock();
+    _mtx.unlock();
+    commit_wal(seq);
     return;
 }
 
@@ -351,32 +806,340 @@ level 0         1    4   9 10         30   40    50+-->60      70       100
 template<typename K, typename V> 
 bool SkipList<K, V>::search_element(K key) {
 
+    StatsScope scope(_stats, STATS_SEARCH);
     std::cout << "search_element-----------------" << std::endl;
+    std::lock_guard<StatsMutex> lock(_mtx);
+    Node<K, V> *current = find_node(key);
+
+    // if current node have key equal to searched key, we get it
+    if (current) {
+        std::cout << "Found key: " << key << ", value: " << current->get_value() << std::endl;
+        _stats.add(STATS_SEARCH_HIT);
+        return true;
+    }
+
+    std::cout << "Not Found Key:" << key << std::endl;
+    _stats.add(STATS_SEARCH_MISS);
+    return false;
+}
+
+template<typename K, typename V> 
+Node<K, V>* SkipList<K, V>::find_node(const K& key) {
+
     Node<K, V> *current = _header;
 
     // start from highest level of skip list
+    size_t hops = 0;
     for (int i = _skip_list_level; i >= 0; i--) {
         while (current->forward[i] && current->forward[i]->get_key() < key) {
             current = current->forward[i];
+            hops++;
         }
     }
+    _stats.add(STATS_SEARCH_PATHS);
+    _stats.add(STATS_SEARCH_HOPS, hops);
 
     //reached level 0 and advance pointer to right node, which we search
     current = current->forward[0];
-
-    // if current node have key equal to searched key, we get it
     if (current and current->get_key() == key) {
-        std::cout << "Found key: " << key << ", value: " << current->get_value() << std::endl;
-        return true;
+        return current;
     }
+    return nullptr;
+}
 
-    std::cout << "Not Found Key:" << key << std::endl;
-    return false;
+// Get a copy of the value, empty if key is not in the list
+template<typename K, typename V> 
+std::optional<V> SkipList<K, V>::get(const K& key) {
+
+    StatsScope scope(_stats, STATS_GET);
+    std::lock_guard<StatsMutex> lock(_mtx);
+    Node<K, V> *node = find_node(key);
+    if (node == nullptr) {
+        return std::nullopt;
+    }
+    return node->get_value();
+}
+
+// Copy the value into the out-parameter, returns false and leaves it untouched on miss
+template<typename K, typename V> 
+bool SkipList<K, V>::get(const K& key, V& value) {
+
+    StatsScope scope(_stats, STATS_GET);
+    std::lock_guard<StatsMutex> lock(_mtx);
+    Node<K, V> *node = find_node(key);
+    if (node == nullptr) {
+        return false;
+    }
+    value = node->get_value();
+    return true;
+}
+
+// The node cannot be deleted or modified while the visitor runs, so it must not call
+// back into this skip list
+template<typename K, typename V> 
+template<typename Visitor>
+bool SkipList<K, V>::get_with(const K& key, Visitor visitor) {
+
+    StatsScope scope(_stats, STATS_GET);
+    std::lock_guard<StatsMutex> lock(_mtx);
+    Node<K, V> *node = find_node(key);
+    if (node == nullptr) {
+        return false;
+    }
+    visitor(node->get_value());
+    return true;
+}
+
+template<typename K, typename V> 
+bool SkipList<K, V>::contains(const K& key) {
+
+    StatsScope scope(_stats, STATS_GET);
+    std::lock_guard<StatsMutex> lock(_mtx);
+    return find_node(key) != nullptr;
+}
+
+template<typename K, typename V> 
+Node<K, V>* SkipList<K, V>::finger_seek(const K& key, Node<K, V>** update) {
+
+    // the levels whose predecessor now lies behind key form a prefix: a node passed
+    // at level i is linked on every level below i as well
+    int stale = 0;
+    while (stale <= _skip_list_level && update[stale]->forward[stale] != NULL &&
+           update[stale]->forward[stale]->get_key() < key) {
+        stale++;
+    }
+
+    // re-walk just those levels, from whichever of the old predecessor and the node
+    // reached on the level above is further along
+    Node<K, V> *current = _header;
+    for (int i = stale - 1; i >= 0; i--) {
+        if (current == _header ||
+            (update[i] != _header && current->get_key() < update[i]->get_key())) {
+            current = update[i];
+        }
+        while (current->forward[i] != NULL && current->forward[i]->get_key() < key) {
+            current = current->forward[i];
+        }
+        update[i] = current;
+    }
+    return update[0]->forward[0];
+}
+
+template<typename K, typename V> 
+std::vector<std::optional<V>> SkipList<K, V>::multi_get(const std::vector<K>& keys) {
+
+    StatsScope scope(_stats, STATS_MULTI_GET);
+
+    // sort before taking the lock
+    std::vector<size_t> order(keys.size());
+    for (size_t i = 0; i < order.size(); i++) {
+        order[i] = i;
+    }
+    std::sort(order.begin(), order.end(), [&keys](size_t a, size_t b) { return keys[a] < keys[b]; });
+
+    std::vector<std::optional<V>> values(keys.size());
+    std::lock_guard<StatsMutex> lock(_mtx);
+    std::vector<Node<K, V>*> update(_level_limit + 1, _header);
+    for (size_t i : order) {
+        Node<K, V> *node = finger_seek(keys[i], update.data());
+        if (node != NULL && node->get_key() == keys[i]) {
+            values[i] = node->get_value();
+        }
+    }
+    return values;
+}
+
+template<typename K, typename V> 
+size_t SkipList<K, V>::write(const WriteBatch<K, V>& batch) {
+
+    StatsScope scope(_stats, STATS_WRITE_BATCH);
+    std::vector<size_t> order = batch.sorted_order();
+    uint64_t seq = 0;
+    size_t deleted;
+    {
+        std::lock_guard<StatsMutex> lock(_mtx);
+        deleted = apply_batch(batch, order);
+        if (_wal.is_open() && !batch.empty()) {
+            std::string record;
+            wal_encode_batch(record, batch);
+            seq = _wal.append(record);
+        }
+    }
+    commit_wal(seq);
+    return deleted;
+}
+
+// Same linking as insert_element/delete_element, except that a put overwrites an
+// existing value and nothing is printed per key. This list has no expiry, so
+// Op::expire_time is ignored.
+template<typename K, typename V> 
+size_t SkipList<K, V>::apply_batch(const WriteBatch<K, V>& batch, const std::vector<size_t>& order) {
+
+    std::vector<Node<K, V>*> update(_level_limit + 1, _header);
+    size_t deleted = 0;
+    for (size_t i : order) {
+        const typename WriteBatch<K, V>::Op& op = batch.ops()[i];
+        Node<K, V> *current = finger_seek(op.key, update.data());
+        bool found = current != NULL && current->get_key() == op.key;
+
+        if (op.is_delete) {
+            if (!found) {
+                continue;
+            }
+            for (int l = 0; l <= _skip_list_level; l++) {
+                if (update[l]->forward[l] != current) 
+                    break;
+                update[l]->forward[l] = current->forward[l];
+            }
+            while (_skip_list_level > 0 && _header->forward[_skip_list_level] == 0) {
+                _skip_list_level --; 
+            }
+            _level_counts[current->node_level] --;
+            destroy_node(current);
+            _element_count --;
+            deleted++;
+        } else if (found) {
+            current->set_value(op.value);
+        } else {
+            int random_level = get_random_level();
+            if (random_level > _skip_list_level) {
+                for (int l = _skip_list_level+1; l < random_level+1; l++) {
+                    update[l] = _header;
+                }
+                _skip_list_level = random_level;
+            }
+            // update[] keeps pointing at the predecessors, which stay valid for the next
+            // (larger or equal) key
+            Node<K, V>* inserted_node = create_node(op.key, op.value, random_level);
+            for (int l = 0; l <= random_level; l++) {
+                inserted_node->forward[l] = update[l]->forward[l];
+                update[l]->forward[l] = inserted_node;
+            }
+            _element_count ++;
+            _level_counts[random_level] ++;
+            grow_max_level();
+        }
+    }
+    return deleted;
+}
+
+template<typename K, typename V> 
+Node<K, V>* SkipList<K, V>::find_greater(const K& key, bool inclusive) {
+
+    Node<K, V> *current = _header;
+
+    // same descent as search_element, stopping before the first key >= key (or > key)
+    for (int i = _skip_list_level; i >= 0; i--) {
+        while (current->forward[i] &&
+               (current->forward[i]->get_key() < key ||
+                (!inclusive && current->forward[i]->get_key() == key))) {
+            current = current->forward[i];
+        }
+    }
+    return current->forward[0];
+}
+
+template<typename K, typename V> 
+Node<K, V>* SkipList<K, V>::find_less(const K& key, bool inclusive) {
+
+    Node<K, V> *current = _header;
+    for (int i = _skip_list_level; i >= 0; i--) {
+        while (current->forward[i] &&
+               (current->forward[i]->get_key() < key ||
+                (inclusive && current->forward[i]->get_key() == key))) {
+            current = current->forward[i];
+        }
+    }
+    return current == _header ? nullptr : current;
+}
+
+template<typename K, typename V> 
+Node<K, V>* SkipList<K, V>::find_last() {
+
+    Node<K, V> *current = _header;
+    for (int i = _skip_list_level; i >= 0; i--) {
+        while (current->forward[i]) {
+            current = current->forward[i];
+        }
+    }
+    return current == _header ? nullptr : current;
+}
+
+template<typename K, typename V> 
+void SkipList<K, V>::read_forward(const K* from, bool inclusive, size_t max,
+                                  std::vector<std::pair<K, V>>& out) {
+
+    std::lock_guard<StatsMutex> lock(_mtx);
+    Node<K, V> *node = from ? find_greater(*from, inclusive) : _header->forward[0];
+    while (node != nullptr && out.size() < max) {
+        out.push_back(std::make_pair(node->get_key(), node->get_value()));
+        node = node->forward[0];
+    }
+}
+
+// There are no backward links, so every step is a fresh descent for the predecessor
+template<typename K, typename V> 
+void SkipList<K, V>::read_backward(const K* from, bool inclusive, size_t max,
+                                   std::vector<std::pair<K, V>>& out) {
+
+    std::lock_guard<StatsMutex> lock(_mtx);
+    Node<K, V> *node = from ? find_less(*from, inclusive) : find_last();
+    while (node != nullptr && out.size() < max) {
+        out.push_back(std::make_pair(node->get_key(), node->get_value()));
+        node = find_less(node->get_key(), false);
+    }
+}
+
+template<typename K, typename V> 
+typename SkipList<K, V>::Iterator SkipList<K, V>::new_iterator() {
+    return Iterator(this);
+}
+
+template<typename K, typename V> 
+typename SkipList<K, V>::Iterator SkipList<K, V>::lower_bound(const K& key) {
+    Iterator it(this);
+    it.seek(key);
+    return it;
+}
+
+template<typename K, typename V> 
+typename SkipList<K, V>::Iterator SkipList<K, V>::upper_bound(const K& key) {
+    Iterator it(this);
+    it.seek_after(key);
+    return it;
+}
+
+template<typename K, typename V> 
+template<typename Callback>
+size_t SkipList<K, V>::scan(const K& begin, const K& end, size_t limit, Callback callback) {
+
+    size_t count = 0;
+    K from = begin;
+    bool inclusive = true;
+    while (true) {
+        std::lock_guard<StatsMutex> lock(_mtx);
+        Node<K, V> *node = find_greater(from, inclusive);
+        Node<K, V> *last = nullptr;
+        for (size_t visited = 0; visited < SCAN_CHUNK_SIZE; visited++) {
+            if (node == nullptr || !(node->get_key() < end) || (limit != 0 && count >= limit)) {
+                return count;
+            }
+            callback(node->get_key(), node->get_value());
+            count++;
+            last = node;
+            node = node->forward[0];
+        }
+        // chunk done: remember where we stopped and let writers run before re-seeking
+        from = last->get_key();
+        inclusive = false;
+    }
 }
 
 // construct skip list
 template<typename K, typename V> 
-SkipList<K, V>::SkipList(int max_level) {
+SkipList<K, V>::SkipList(int max_level)
+    : _level_limit(std::max(max_level, SKIPLIST_LEVEL_LIMIT)), _arena(_level_limit), _mtx(_stats),
+      _level_counts(_level_limit + 1, 0), _grow_at(_levels.capacity(max_level)), _saving(false) {
 
     this->_max_level = max_level;
     this->_skip_list_level = 0;
@@ -385,43 +1148,65 @@ SkipList<K, V>::SkipList(int max_level) {
     // create header node and initialize key and value to null
     K k;
     V v;
-    this->_header = new Node<K, V>(k, v, _max_level);
+    // allocated at the level limit so that growing _max_level never moves the header
+    this->_header = create_node(k, v, _level_limit);
 };
 
 template<typename K, typename V> 
 SkipList<K, V>::~SkipList() {
 
-    if (_file_writer.is_open()) {
-        _file_writer.close();
+    if (_save_thread.joinable()) {
+        _save_thread.join();
     }
     if (_file_reader.is_open()) {
         _file_reader.close();
     }
 
-    //递归删除跳表链条
-    if(_header->forward[0]!=nullptr){
-        clear(_header->forward[0]);
-    }
-    delete(_header);
-    
+    clear();
 }
+
 template <typename K, typename V>
-void SkipList<K, V>::clear(Node<K, V> * cur)
+void SkipList<K, V>::clear()
 {
-    if(cur->forward[0]!=nullptr){
-        clear(cur->forward[0]);
+    // Node memory goes away with the arena blocks; the list only has to be walked
+    // when keys or values own resources, or when nodes were allocated one by one.
+    if (!NodeArena::bulk_release() ||
+        !std::is_trivially_destructible<K>::value || !std::is_trivially_destructible<V>::value) {
+        Node<K, V> *cur = _header->forward[0];
+        while (cur != nullptr) {
+            Node<K, V> *next = cur->forward[0];
+            destroy_node(cur);
+            cur = next;
+        }
     }
-    delete(cur);
+    destroy_node(_header);
+    _header = nullptr;
 }
 
 template<typename K, typename V>
-int SkipList<K, V>::get_random_level(){
+void SkipList<K, V>::set_level_probability(double p) {
 
-    int k = 1;
-    while (rand() % 2) {
-        k++;
+    std::lock_guard<StatsMutex> lock(_mtx);
+    _levels.set_probability(p);
+    _grow_at = _levels.capacity(_max_level);
+    grow_max_level();
+}
+
+// the expected top level is log_{1/p}(n), so the cap follows the element count and a big
+// list does not pile its upper levels into one long chain at the old maximum
+template<typename K, typename V>
+void SkipList<K, V>::grow_max_level() {
+
+    while (static_cast<size_t>(_element_count) > _grow_at && _max_level < _level_limit) {
+        _max_level++;
+        _grow_at = _levels.capacity(_max_level);
     }
-    k = (k < _max_level) ? k : _max_level;
-    return k;
+}
+
+template<typename K, typename V>
+int SkipList<K, V>::get_random_level(){
+
+    // thread-local PRNG and one count-trailing-zeros instead of a rand() call per level
+    return _levels.next(_max_level);
 };
 // vim: et tw=100 ts=4 sw=4 cc=120
@@ -0,0 +1,85 @@
+#ifndef SKIPLIST_ITERATOR_H
+#define SKIPLIST_ITERATOR_H
+
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+#define ITERATOR_BATCH_SIZE 64 // 迭代器每次从跳表拷贝的键值对数量
+
+// 跳表的有序双向迭代器。
+// 每次持锁从跳表批量拷贝一段键值对，批次用完后以最后一个键为界重新定位，
+// 迭代器本身不持有锁也不持有节点指针，遍历期间其他线程可以正常读写；
+// 每个批次看到的是拷贝时刻的数据，不同批次之间可能看到并发写入的结果。
+// List 需提供（可设为友元访问的私有成员）：
+//   read_forward(const K* from, bool inclusive, size_t max, std::vector<std::pair<K, V>>& out)
+//   read_backward(const K* from, bool inclusive, size_t max, std::vector<std::pair<K, V>>& out)
+// from 为 nullptr 时分别表示从最小键/最大键开始，inclusive 表示是否包含 from 本身。
+template<typename List, typename K, typename V>
+class SkipListIterator {
+public:
+    explicit SkipListIterator(List* list) : _list(list), _pos(0), _forward(true) {}
+
+    // 是否指向一个有效元素
+    bool valid() const { return _pos < _batch.size(); }
+
+    // 当前元素的键和值，valid() 为 true 时才能调用
+    const K& key() const { return _batch[_pos].first; }
+    const V& value() const { return _batch[_pos].second; }
+
+    void seek(const K& key) { load(&key, true, true); } // 定位到第一个 >= key 的元素
+    void seek_after(const K& key) { load(&key, false, true); } // 定位到第一个 > key 的元素
+    void seek_for_prev(const K& key) { load(&key, true, false); } // 定位到最后一个 <= key 的元素
+    void seek_to_first() { load(nullptr, true, true); } // 定位到最小的元素
+    void seek_to_last() { load(nullptr, true, false); } // 定位到最大的元素
+
+    // 移动到下一个（更大的）元素
+    void next() {
+        if (!valid()) {
+            return;
+        }
+        if (!_forward) {
+            load(&key(), false, true);
+            return;
+        }
+        if (++_pos == _batch.size() && _batch.size() == ITERATOR_BATCH_SIZE) {
+            load(&_batch.back().first, false, true);
+        }
+    }
+
+    // 移动到上一个（更小的）元素
+    void prev() {
+        if (!valid()) {
+            return;
+        }
+        if (_forward) {
+            load(&key(), false, false);
+            return;
+        }
+        if (++_pos == _batch.size() && _batch.size() == ITERATOR_BATCH_SIZE) {
+            load(&_batch.back().first, false, false);
+        }
+    }
+
+private:
+    // 先读到新批次再替换，from 可以指向当前批次里的键
+    void load(const K* from, bool inclusive, bool forward) {
+        std::vector<std::pair<K, V>> batch;
+        batch.reserve(ITERATOR_BATCH_SIZE);
+        if (forward) {
+            _list->read_forward(from, inclusive, ITERATOR_BATCH_SIZE, batch);
+        } else {
+            _list->read_backward(from, inclusive, ITERATOR_BATCH_SIZE, batch);
+        }
+        _batch.swap(batch);
+        _pos = 0;
+        _forward = forward;
+    }
+
+    List* _list;
+    std::vector<std::pair<K, V>> _batch; // 当前批次，反向迭代时按键降序存放
+    size_t _pos; // 当前元素在批次中的下标
+    bool _forward; // 当前批次的方向
+};
+
+#endif
@@ -0,0 +1,368 @@
+#ifndef SKIPLIST_STATS_H
+#define SKIPLIST_STATS_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <vector>
+
+// 跳表运行时统计：每种操作的延迟直方图、锁等待/持有时间、命中计数。
+// 计数按线程分散到若干缓存行对齐的分片上，只做 relaxed 原子加，开销小到可以常开；
+// stats() 汇总所有分片得到快照，可以直接读分位数，也可以输出成 Prometheus 文本格式。
+
+#ifndef STATS_FILE
+#define STATS_FILE "store/stats.prom" // Prometheus 文本格式的统计输出文件
+#endif
+
+#define STATS_SHARDS 8 // 统计分片数，线程按编号轮流落在各分片上
+
+// 需要统计延迟的操作
+enum StatsOp {
+    STATS_INSERT,
+    STATS_DELETE,
+    STATS_SEARCH,
+    STATS_GET,
+    STATS_DUMP,
+    STATS_PERIODIC,
+    STATS_MULTI_GET,
+    STATS_WRITE_BATCH,
+    STATS_BULK_LOAD,
+    STATS_WAL_COMMIT,
+    STATS_BGSAVE_FORK,
+    STATS_CHECKPOINT,
+    STATS_EXPIRE,
+    STATS_LOCK_WAIT,
+    STATS_LOCK_HOLD,
+    STATS_OP_COUNT
+};
+
+// 只需要计数的事件
+enum StatsCounter {
+    STATS_SEARCH_HIT,
+    STATS_SEARCH_MISS,
+    STATS_LRU_HIT,
+    STATS_LRU_MISS,
+    STATS_SEARCH_PATHS, // 从头节点（或 finger）下降的查找次数
+    STATS_SEARCH_HOPS, // 这些查找在各层上向后走的总步数
+    STATS_COUNTER_COUNT
+};
+
+inline const char* stats_op_name(int op) {
+    static const char* const names[STATS_OP_COUNT] = {
+        "insert", "delete", "search", "get", "dump_file", "periodic_task", "multi_get", "write_batch", "bulk_load", "wal_commit", "bgsave_fork", "checkpoint", "expire", "lock_wait", "lock_hold"
+    };
+    return names[op];
+}
+
+inline uint64_t stats_now_ns() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// HDR 风格的对数-线性分桶：每个 2 的幂区间再等分 4 份，相对误差不超过 25%，上限约 1100 秒
+class LatencyBuckets {
+public:
+    static const int kSubBits = 2;
+    static const int kMaxBits = 40;
+    static const int kCount = (kMaxBits - kSubBits + 1) << kSubBits;
+
+    static int index(uint64_t ns) {
+        if (ns >= (1ULL << kMaxBits)) {
+            ns = (1ULL << kMaxBits) - 1;
+        }
+        if (ns < (1ULL << kSubBits)) {
+            return static_cast<int>(ns);
+        }
+        int msb = 63 - __builtin_clzll(ns);
+        int sub = static_cast<int>((ns >> (msb - kSubBits)) & ((1 << kSubBits) - 1));
+        return ((msb - kSubBits + 1) << kSubBits) + sub;
+    }
+
+    // 桶内最大值，用作分位数的估计
+    static uint64_t upper_bound(int index) {
+        if (index < (1 << kSubBits)) {
+            return index;
+        }
+        int msb = (index >> kSubBits) + kSubBits - 1;
+        uint64_t sub = index & ((1 << kSubBits) - 1);
+        uint64_t lower = ((1ULL << kSubBits) + sub) << (msb - kSubBits);
+        return lower + (1ULL << (msb - kSubBits)) - 1;
+    }
+};
+
+// 一个操作的延迟直方图快照
+struct LatencySummary {
+    uint64_t count = 0;
+    uint64_t sum_ns = 0;
+    uint64_t max_ns = 0;
+    std::vector<uint64_t> buckets = std::vector<uint64_t>(LatencyBuckets::kCount, 0);
+
+    // 分位数（纳秒），q 取值 0~1
+    uint64_t percentile(double q) const {
+        if (count == 0) {
+            return 0;
+        }
+        uint64_t rank = static_cast<uint64_t>(q * count);
+        if (rank >= count) {
+            rank = count - 1;
+        }
+        uint64_t seen = 0;
+        for (int i = 0; i < LatencyBuckets::kCount; i++) {
+            seen += buckets[i];
+            if (seen > rank) {
+                uint64_t v = LatencyBuckets::upper_bound(i);
+                return v < max_ns ? v : max_ns;
+            }
+        }
+        return max_ns;
+    }
+
+    double mean_ns() const {
+        return count == 0 ? 0.0 : static_cast<double>(sum_ns) / count;
+    }
+
+    void merge(const LatencySummary& other) {
+        count += other.count;
+        sum_ns += other.sum_ns;
+        if (other.max_ns > max_ns) {
+            max_ns = other.max_ns;
+        }
+        for (int i = 0; i < LatencyBuckets::kCount; i++) {
+            buckets[i] += other.buckets[i];
+        }
+    }
+};
+
+// stats() 返回的统计快照
+struct SkipListStats {
+    LatencySummary ops[STATS_OP_COUNT]; // 各操作延迟，下标为 StatsOp
+    uint64_t counters[STATS_COUNTER_COUNT] = {}; // 事件计数，下标为 StatsCounter
+    uint64_t lru_evictions = 0; // LRU 容量淘汰次数
+    uint64_t lru_expired = 0; // LRU 过期清理次数
+    uint64_t expired_reclaimed = 0; // 因过期从跳表中删除的节点数（读时发现和过期索引清理）
+    long element_count = 0; // 元素数量
+    int skip_list_level = 0; // 当前层级
+    int max_level = 0; // 最大层级（随元素数增长）
+    double level_probability = 0; // 节点出现在上一层的概率 p
+    std::vector<long> level_histogram; // level_histogram[i] 为层级为 i 的节点数
+
+    double lru_hit_ratio() const {
+        uint64_t total = counters[STATS_LRU_HIT] + counters[STATS_LRU_MISS];
+        return total == 0 ? 0.0 : static_cast<double>(counters[STATS_LRU_HIT]) / total;
+    }
+
+    // 每次查找平均向后走的步数，与每节点的平均指针数 1 + 层级分布的均值一起用来权衡 p
+    double mean_hops() const {
+        uint64_t paths = counters[STATS_SEARCH_PATHS];
+        return paths == 0 ? 0.0 : static_cast<double>(counters[STATS_SEARCH_HOPS]) / paths;
+    }
+
+    // 合并另一个快照（用于分片跳表汇总）
+    void merge(const SkipListStats& other) {
+        for (int i = 0; i < STATS_OP_COUNT; i++) {
+            ops[i].merge(other.ops[i]);
+        }
+        for (int i = 0; i < STATS_COUNTER_COUNT; i++) {
+            counters[i] += other.counters[i];
+        }
+        lru_evictions += other.lru_evictions;
+        lru_expired += other.lru_expired;
+        expired_reclaimed += other.expired_reclaimed;
+        element_count += other.element_count;
+        if (other.skip_list_level > skip_list_level) {
+            skip_list_level = other.skip_list_level;
+        }
+        if (other.max_level > max_level) {
+            max_level = other.max_level;
+        }
+        level_probability = other.level_probability;
+        if (other.level_histogram.size() > level_histogram.size()) {
+            level_histogram.resize(other.level_histogram.size(), 0);
+        }
+        for (size_t i = 0; i < other.level_histogram.size(); i++) {
+            level_histogram[i] += other.level_histogram[i];
+        }
+    }
+
+    // 输出 Prometheus 文本格式
+    void write_prometheus(std::ostream& out) const {
+        static const double quantiles[] = {0.5, 0.9, 0.99, 0.999};
+        char buf[64];
+
+        out << "# HELP skiplist_op_latency_seconds Latency of skiplist operations and lock wait/hold.\n";
+        out << "# TYPE skiplist_op_latency_seconds summary\n";
+        for (int op = 0; op < STATS_OP_COUNT; op++) {
+            const LatencySummary& s = ops[op];
+            for (double q : quantiles) {
+                snprintf(buf, sizeof(buf), "%.9f", s.percentile(q) / 1e9);
+                out << "skiplist_op_latency_seconds{op=\"" << stats_op_name(op) << "\",quantile=\"" << q << "\"} "
+                    << buf << "\n";
+            }
+            snprintf(buf, sizeof(buf), "%.9f", s.sum_ns / 1e9);
+            out << "skiplist_op_latency_seconds_sum{op=\"" << stats_op_name(op) << "\"} " << buf << "\n";
+            out << "skiplist_op_latency_seconds_count{op=\"" << stats_op_name(op) << "\"} " << s.count << "\n";
+        }
+
+        out << "# TYPE skiplist_search_total counter\n";
+        out << "skiplist_search_total{result=\"hit\"} " << counters[STATS_SEARCH_HIT] << "\n";
+        out << "skiplist_search_total{result=\"miss\"} " << counters[STATS_SEARCH_MISS] << "\n";
+        out << "# TYPE skiplist_lru_requests_total counter\n";
+        out << "skiplist_lru_requests_total{result=\"hit\"} " << counters[STATS_LRU_HIT] << "\n";
+        out << "skiplist_lru_requests_total{result=\"miss\"} " << counters[STATS_LRU_MISS] << "\n";
+        out << "# TYPE skiplist_lru_evictions_total counter\n";
+        out << "skiplist_lru_evictions_total{reason=\"capacity\"} " << lru_evictions << "\n";
+        out << "skiplist_lru_evictions_total{reason=\"expired\"} " << lru_expired << "\n";
+        out << "# TYPE skiplist_expired_reclaimed_total counter\n";
+        out << "skiplist_expired_reclaimed_total " << expired_reclaimed << "\n";
+        out << "# TYPE skiplist_elements gauge\n";
+        out << "skiplist_elements " << element_count << "\n";
+        out << "# TYPE skiplist_level gauge\n";
+        out << "skiplist_level " << skip_list_level << "\n";
+        out << "# TYPE skiplist_max_level gauge\n";
+        out << "skiplist_max_level " << max_level << "\n";
+        out << "# TYPE skiplist_level_probability gauge\n";
+        out << "skiplist_level_probability " << level_probability << "\n";
+        out << "# TYPE skiplist_search_paths_total counter\n";
+        out << "skiplist_search_paths_total " << counters[STATS_SEARCH_PATHS] << "\n";
+        out << "# TYPE skiplist_search_hops_total counter\n";
+        out << "skiplist_search_hops_total " << counters[STATS_SEARCH_HOPS] << "\n";
+        out << "# TYPE skiplist_level_nodes gauge\n";
+        for (size_t i = 0; i < level_histogram.size(); i++) {
+            out << "skiplist_level_nodes{level=\"" << i << "\"} " << level_histogram[i] << "\n";
+        }
+    }
+
+    // 写入文件：先写临时文件再改名，抓取方不会读到写了一半的内容
+    bool dump_prometheus(const std::string& path = STATS_FILE) const {
+        std::string tmp = path + ".tmp";
+        std::ofstream out(tmp.c_str());
+        if (!out) {
+            return false;
+        }
+        write_prometheus(out);
+        out.close();
+        if (!out) {
+            return false;
+        }
+        return std::rename(tmp.c_str(), path.c_str()) == 0;
+    }
+};
+
+// 运行中的统计收集器，每个跳表实例一个
+class StatsCollector {
+public:
+    // 记录一次操作耗时
+    void record(StatsOp op, uint64_t ns) {
+        Shard& s = shard();
+        Histogram& h = s.hist[op];
+        h.buckets[LatencyBuckets::index(ns)].fetch_add(1, std::memory_order_relaxed);
+        h.count.fetch_add(1, std::memory_order_relaxed);
+        h.sum_ns.fetch_add(ns, std::memory_order_relaxed);
+        uint64_t max = h.max_ns.load(std::memory_order_relaxed);
+        while (ns > max && !h.max_ns.compare_exchange_weak(max, ns, std::memory_order_relaxed)) {
+        }
+    }
+
+    // 事件计数加 n
+    void add(StatsCounter counter, uint64_t n = 1) {
+        shard().counters[counter].fetch_add(n, std::memory_order_relaxed);
+    }
+
+    // 汇总所有分片的直方图和计数到快照中
+    void collect(SkipListStats& out) const {
+        for (int i = 0; i < STATS_SHARDS; i++) {
+            const Shard& s = _shards[i];
+            for (int op = 0; op < STATS_OP_COUNT; op++) {
+                const Histogram& h = s.hist[op];
+                LatencySummary& sum = out.ops[op];
+                sum.count += h.count.load(std::memory_order_relaxed);
+                sum.sum_ns += h.sum_ns.load(std::memory_order_relaxed);
+                uint64_t max = h.max_ns.load(std::memory_order_relaxed);
+                if (max > sum.max_ns) {
+                    sum.max_ns = max;
+                }
+                for (int b = 0; b < LatencyBuckets::kCount; b++) {
+                    sum.buckets[b] += h.buckets[b].load(std::memory_order_relaxed);
+                }
+            }
+            for (int c = 0; c < STATS_COUNTER_COUNT; c++) {
+                out.counters[c] += s.counters[c].load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+private:
+    struct Histogram {
+        std::atomic<uint64_t> count{0};
+        std::atomic<uint64_t> sum_ns{0};
+        std::atomic<uint64_t> max_ns{0};
+        std::atomic<uint64_t> buckets[LatencyBuckets::kCount] = {};
+    };
+
+    struct alignas(64) Shard {
+        Histogram hist[STATS_OP_COUNT];
+        std::atomic<uint64_t> counters[STATS_COUNTER_COUNT] = {};
+    };
+
+    Shard& shard() {
+        static std::atomic<unsigned> next_thread(0);
+        thread_local unsigned index = next_thread.fetch_add(1, std::memory_order_relaxed) % STATS_SHARDS;
+        return _shards[index];
+    }
+
+    Shard _shards[STATS_SHARDS];
+};
+
+// 在作用域结束时记录操作耗时
+class StatsScope {
+public:
+    StatsScope(StatsCollector& stats, StatsOp op) : _stats(stats), _op(op), _start(stats_now_ns()) {}
+    ~StatsScope() { _stats.record(_op, stats_now_ns() - _start); }
+
+private:
+    StatsCollector& _stats;
+    StatsOp _op;
+    uint64_t _start;
+};
+
+// 带统计的读写锁：记录等待加锁和持有锁的时间，可直接替换 std::mutex 用于 lock_guard，
+// 也可用于 shared_lock（只读路径）。共享持有的时间因持有者可以有多个而不计入 LOCK_HOLD
+class StatsMutex {
+public:
+    explicit StatsMutex(StatsCollector& stats) : _stats(stats), _locked_at(0) {}
+
+    void lock() {
+        uint64_t start = stats_now_ns();
+        _mtx.lock();
+        _locked_at = stats_now_ns();
+        _stats.record(STATS_LOCK_WAIT, _locked_at - start);
+    }
+
+    void unlock() {
+        uint64_t held = stats_now_ns() - _locked_at;
+        _mtx.unlock();
+        _stats.record(STATS_LOCK_HOLD, held);
+    }
+
+    void lock_shared() {
+        uint64_t start = stats_now_ns();
+        _mtx.lock_shared();
+        _stats.record(STATS_LOCK_WAIT, stats_now_ns() - start);
+    }
+
+    void unlock_shared() {
+        _mtx.unlock_shared();
+    }
+
+private:
+    StatsCollector& _stats;
+    std::shared_mutex _mtx;
+    uint64_t _locked_at; // 只由持锁线程读写
+};
+
+#endif
@@ -0,0 +1,526 @@
+#ifndef SNAPSHOT_FORMAT_H
+#define SNAPSHOT_FORMAT_H
+
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <sstream>
+#include <type_traits>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "async_io.h"
+
+// 跳表快照的二进制格式，取代 key:value 文本格式：
+//
+//   文件头  magic "SKLSNAP\0"(8) | version u32 | sequence u32（增量检查点的序号，见 checkpoint.h，普通快照为 0）
+//   数据块  block_size u32 | record_count u32 | 记录... | crc32c u32（校验块头和全部记录）
+//           记录：key_len u32 | value_len u32 | expire_time i64 | key | value
+//           expire_time 为过期时间的 Unix 毫秒（0 表示永不过期）；version 1 的文件以秒为单位，读取时换算成毫秒
+//           expire_time 为 SNAPSHOT_TOMBSTONE 的记录表示删除（只出现在增量检查点中），没有值
+//   索引    每个数据块一项：offset u64 | block_size u32 | record_count u32 | first_key_len u32 | first_key
+//   文件尾  index_offset u64 | index_size u64 | block_count u64 | record_count u64 | index_crc u32 | reserved u32 | magic(8)
+//
+// 整数按本机字节序写入。键和值用 SnapshotCodec<T> 编码，内置算术类型和 std::string，其他类型特化即可。
+// 写入先拼好整块再交给 AsyncFileWriter（io_uring 或 pwrite，见 async_io.h）写到临时文件，fsync 后 rename 覆盖旧快照；
+// 读取时默认 mmap 整个文件（指定了 I/O 后端时读入内存），逐块校验后解码。
+
+#define SNAPSHOT_VERSION 2
+#define SNAPSHOT_VERSION_SECONDS 1 // 过期时间以秒为单位的旧版本，仍可读取
+#define SNAPSHOT_BLOCK_SIZE (64 << 10) // 数据块达到这个大小就结束，单条记录可以超过
+
+static const char SNAPSHOT_MAGIC[8] = {'S', 'K', 'L', 'S', 'N', 'A', 'P', '\0'};
+static const size_t SNAPSHOT_HEADER_SIZE = 16;
+static const size_t SNAPSHOT_FOOTER_SIZE = 48;
+static const size_t SNAPSHOT_BLOCK_HEADER_SIZE = 8;
+static const size_t SNAPSHOT_RECORD_HEADER_SIZE = 16;
+static const int64_t SNAPSHOT_TOMBSTONE = -1; // 删除记录的 expire_time
+
+// CRC32C（Castagnoli），slicing-by-8 查表
+inline uint32_t snapshot_crc32c(const char* data, size_t len, uint32_t crc = 0) {
+    static uint32_t table[8][256];
+    static bool initialized = [] {
+        for (uint32_t i = 0; i < 256; i++) {
+            uint32_t c = i;
+            for (int k = 0; k < 8; k++) {
+                c = (c & 1) ? (c >> 1) ^ 0x82F63B78u : c >> 1;
+            }
+            table[0][i] = c;
+        }
+        for (uint32_t i = 0; i < 256; i++) {
+            for (int t = 1; t < 8; t++) {
+                table[t][i] = (table[t - 1][i] >> 8) ^ table[0][table[t - 1][i] & 0xFF];
+            }
+        }
+        return true;
+    }();
+    (void)initialized;
+
+    const unsigned char* p = reinterpret_cast<const unsigned char*>(data);
+    crc = ~crc;
+    while (len >= 8) {
+        uint32_t lo;
+        uint32_t hi;
+        memcpy(&lo, p, 4);
+        memcpy(&hi, p + 4, 4);
+        lo ^= crc;
+        crc = table[7][lo & 0xFF] ^ table[6][(lo >> 8) & 0xFF] ^
+              table[5][(lo >> 16) & 0xFF] ^ table[4][lo >> 24] ^
+              table[3][hi & 0xFF] ^ table[2][(hi >> 8) & 0xFF] ^
+              table[1][(hi >> 16) & 0xFF] ^ table[0][hi >> 24];
+        p += 8;
+        len -= 8;
+    }
+    while (len-- > 0) {
+        crc = table[0][(crc ^ *p++) & 0xFF] ^ (crc >> 8);
+    }
+    return ~crc;
+}
+
+// 键值的二进制编码：算术类型按内存表示原样写入
+template<typename T, typename Enable = void>
+struct SnapshotCodec;
+
+template<typename T>
+struct SnapshotCodec<T, typename std::enable_if<std::is_arithmetic<T>::value>::type> {
+    static void encode(const T& value, std::string& out) {
+        out.append(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+    static bool decode(const char* data, size_t len, T& value) {
+        if (len != sizeof(T)) {
+            return false;
+        }
+        memcpy(&value, data, sizeof(T));
+        return true;
+    }
+};
+
+template<>
+struct SnapshotCodec<std::string> {
+    static void encode(const std::string& value, std::string& out) {
+        out.append(value);
+    }
+    static bool decode(const char* data, size_t len, std::string& value) {
+        value.assign(data, len);
+        return true;
+    }
+};
+
+// 旧的文本格式 dumpFile 中的字段解析，用于从文本快照迁移
+template<typename T>
+inline bool snapshot_parse_text(const std::string& text, T& value) {
+    std::istringstream in(text);
+    in >> value;
+    return !in.fail();
+}
+
+template<>
+inline bool snapshot_parse_text<std::string>(const std::string& text, std::string& value) {
+    value = text;
+    return true;
+}
+
+template<typename T>
+inline void snapshot_put(std::string& out, T value) {
+    out.append(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+template<typename T>
+inline T snapshot_get(const char* p) {
+    T value;
+    memcpy(&value, p, sizeof(T));
+    return value;
+}
+
+// 快照写入器：open 后按键序 add，最后 finish；没有 finish 就析构时删除临时文件，旧快照保持不变
+class SnapshotWriter {
+public:
+    SnapshotWriter();
+
+    ~SnapshotWriter();
+
+    void set_io_options(const IoOptions& options) { _io = options; } // 在 open 之前调用
+
+    bool open(const std::string& path, uint32_t sequence = 0); // 写到 path.tmp，finish 时 rename 成 path
+
+    template<typename K, typename V>
+    bool add(const K& key, const V& value, int64_t expire_time = 0); // 追加一条记录
+
+    template<typename K>
+    bool add_tombstone(const K& key); // 追加一条删除记录
+
+    bool finish(); // 写出最后一块、索引和文件尾，fsync 后 rename
+
+    const std::string& error() const { return _error; }
+
+    uint64_t bytes_written() const { return _offset; } // 已写出的字节数（含缓冲区中的）
+
+    uint64_t record_count() const { return _record_count; }
+
+    const AsyncFileWriter& file() const { return _file; } // 实际使用的 I/O 后端和系统调用次数
+
+private:
+    bool flush_block(); // 补全块头和校验码，把当前块交给 _file
+
+    bool append(const char* data, size_t len);
+
+    bool fail(const std::string& message);
+
+    IoOptions _io;
+    AsyncFileWriter _file;
+    std::string _path;
+    std::string _tmp_path;
+    std::string _block; // 正在拼装的数据块，开头预留块头
+    uint32_t _block_records;
+    std::string _key_buf; // 当前记录键的编码
+    std::string _first_key; // 当前块第一个键的编码，写入索引
+    std::string _index; // 索引区
+    uint64_t _offset; // 下一个字节在文件中的偏移
+    uint64_t _block_count;
+    uint64_t _record_count;
+    std::string _error;
+};
+
+inline SnapshotWriter::SnapshotWriter()
+    : _block_records(0), _offset(0), _block_count(0), _record_count(0) {}
+
+inline SnapshotWriter::~SnapshotWriter() {
+    if (_file.is_open()) {
+        _file.close(false);
+        ::unlink(_tmp_path.c_str());
+    }
+}
+
+inline bool SnapshotWriter::fail(const std::string& message) {
+    if (_error.empty()) {
+        _error = message + ": " + strerror(errno);
+    }
+    return false;
+}
+
+inline bool SnapshotWriter::open(const std::string& path, uint32_t sequence) {
+    _path = path;
+    _tmp_path = path + ".tmp";
+    if (!_file.open(_tmp_path, _io)) {
+        _error = _file.error();
+        return false;
+    }
+    _block.reserve(SNAPSHOT_BLOCK_SIZE * 2);
+
+    std::string header(SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC));
+    snapshot_put<uint32_t>(header, SNAPSHOT_VERSION);
+    snapshot_put<uint32_t>(header, sequence);
+    _block.assign(SNAPSHOT_BLOCK_HEADER_SIZE, '\0');
+    return append(header.data(), header.size());
+}
+
+template<typename K, typename V>
+bool SnapshotWriter::add(const K& key, const V& value, int64_t expire_time) {
+    if (!_file.is_open()) {
+        return false;
+    }
+    _key_buf.clear();
+    SnapshotCodec<K>::encode(key, _key_buf);
+    if (_block_records == 0) {
+        _first_key = _key_buf;
+    }
+
+    // 值直接编码到块尾，编码完再回填长度
+    size_t record_start = _block.size();
+    _block.append(SNAPSHOT_RECORD_HEADER_SIZE, '\0');
+    _block.append(_key_buf);
+    size_t value_start = _block.size();
+    SnapshotCodec<V>::encode(value, _block);
+    uint32_t key_len = static_cast<uint32_t>(_key_buf.size());
+    uint32_t value_len = static_cast<uint32_t>(_block.size() - value_start);
+    memcpy(&_block[record_start], &key_len, 4);
+    memcpy(&_block[record_start + 4], &value_len, 4);
+    memcpy(&_block[record_start + 8], &expire_time, 8);
+
+    _block_records++;
+    _record_count++;
+    if (_block.size() >= SNAPSHOT_BLOCK_SIZE) {
+        return flush_block();
+    }
+    return true;
+}
+
+template<typename K>
+bool SnapshotWriter::add_tombstone(const K& key) {
+    return add(key, std::string(), SNAPSHOT_TOMBSTONE);
+}
+
+inline bool SnapshotWriter::flush_block() {
+    if (_block_records == 0) {
+        return true;
+    }
+    uint32_t block_size = static_cast<uint32_t>(_block.size() - SNAPSHOT_BLOCK_HEADER_SIZE);
+    memcpy(&_block[0], &block_size, 4);
+    memcpy(&_block[4], &_block_records, 4);
+    uint32_t crc = snapshot_crc32c(_block.data(), _block.size());
+    snapshot_put<uint32_t>(_block, crc);
+
+    snapshot_put<uint64_t>(_index, _offset);
+    snapshot_put<uint32_t>(_index, block_size);
+    snapshot_put<uint32_t>(_index, _block_records);
+    snapshot_put<uint32_t>(_index, static_cast<uint32_t>(_first_key.size()));
+    _index.append(_first_key);
+
+    bool ok = append(_block.data(), _block.size());
+    _block.assign(SNAPSHOT_BLOCK_HEADER_SIZE, '\0');
+    _block_records = 0;
+    _block_count++;
+    return ok;
+}
+
+inline bool SnapshotWriter::append(const char* data, size_t len) {
+    _offset += len;
+    if (!_file.write(data, len)) {
+        if (_error.empty()) {
+            _error = _file.error();
+        }
+        return false;
+    }
+    return true;
+}
+
+inline bool SnapshotWriter::finish() {
+    if (!_file.is_open() || !flush_block()) {
+        return false;
+    }
+    uint64_t index_offset = _offset;
+    if (!append(_index.data(), _index.size())) {
+        return false;
+    }
+
+    std::string footer;
+    snapshot_put<uint64_t>(footer, index_offset);
+    snapshot_put<uint64_t>(footer, _index.size());
+    snapshot_put<uint64_t>(footer, _block_count);
+    snapshot_put<uint64_t>(footer, _record_count);
+    snapshot_put<uint32_t>(footer, snapshot_crc32c(_index.data(), _index.size()));
+    snapshot_put<uint32_t>(footer, 0);
+    footer.append(SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC));
+    if (!append(footer.data(), footer.size())) {
+        return false;
+    }
+    if (!_file.close(true)) { // 写出剩余数据并 fsync
+        _error = _file.error();
+        ::unlink(_tmp_path.c_str());
+        return false;
+    }
+    if (std::rename(_tmp_path.c_str(), _path.c_str()) != 0) {
+        ::unlink(_tmp_path.c_str());
+        return fail("rename " + _tmp_path);
+    }
+    return true;
+}
+
+// 快照读取器：open 时 mmap 整个文件（或按 IoOptions 读入内存）并校验文件头、文件尾和索引，
+// 之后用 next 按键序逐条取出记录，每进入一个数据块先校验它的 crc
+class SnapshotReader {
+public:
+    SnapshotReader();
+
+    ~SnapshotReader();
+
+    static bool is_snapshot(const std::string& path); // 文件是否以快照 magic 开头（否则按旧文本格式处理）
+
+    // options 为 AUTO 且不 direct 时 mmap，否则用 io_read_file 读入内存（见 async_io.h）
+    bool open(const std::string& path, const IoOptions& options = IoOptions());
+
+    // 取下一条记录，读完或出错时返回 false，出错时 error() 非空；删除记录的 expire_time 为 SNAPSHOT_TOMBSTONE，value 不变
+    template<typename K, typename V>
+    bool next(K& key, V& value, int64_t& expire_time);
+
+    uint32_t sequence() const { return _sequence; } // 文件头中的检查点序号
+
+    const std::string& error() const { return _error; }
+
+    uint64_t record_count() const { return _record_count; }
+
+    uint64_t file_size() const { return _size; }
+
+private:
+    bool corrupt(const std::string& message);
+
+    bool enter_block(); // 定位到下一个数据块并校验
+
+    const char* _data; // mmap 的起始地址或读入的内存
+    size_t _size;
+    bool _mapped; // _data 是否为 mmap
+    const char* _index; // 索引区中下一项
+    const char* _index_end;
+    const char* _cursor; // 当前块中下一条记录
+    const char* _block_end;
+    uint64_t _block_count;
+    uint64_t _record_count;
+    uint32_t _sequence;
+    uint32_t _version;
+    std::string _error;
+};
+
+inline SnapshotReader::SnapshotReader()
+    : _data(nullptr), _size(0), _mapped(false), _index(nullptr), _index_end(nullptr), _cursor(nullptr), _block_end(nullptr),
+      _block_count(0), _record_count(0), _sequence(0), _version(0) {}
+
+inline SnapshotReader::~SnapshotReader() {
+    if (_data != nullptr && _mapped) {
+        munmap(const_cast<char*>(_data), _size);
+    } else {
+        free(const_cast<char*>(_data));
+    }
+}
+
+inline bool SnapshotReader::is_snapshot(const std::string& path) {
+    FILE* f = fopen(path.c_str(), "rb");
+    if (f == nullptr) {
+        return false;
+    }
+    char magic[sizeof(SNAPSHOT_MAGIC)];
+    bool match = fread(magic, 1, sizeof(magic), f) == sizeof(magic) &&
+                 memcmp(magic, SNAPSHOT_MAGIC, sizeof(magic)) == 0;
+    fclose(f);
+    return match;
+}
+
+inline bool SnapshotReader::corrupt(const std::string& message) {
+    if (_error.empty()) {
+        _error = message;
+    }
+    return false;
+}
+
+inline bool SnapshotReader::open(const std::string& path, const IoOptions& options) {
+    if (options.backend != IO_BACKEND_AUTO || options.direct) {
+        char* data;
+        std::string error;
+        if (!io_read_file(path, options, data, _size, &error)) {
+            return corrupt(error);
+        }
+        _data = data;
+        if (_size < SNAPSHOT_HEADER_SIZE + SNAPSHOT_FOOTER_SIZE) {
+            return corrupt(path + ": file too short");
+        }
+    } else {
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            return corrupt("open " + path + ": " + strerror(errno));
+        }
+        struct stat st;
+        if (fstat(fd, &st) != 0) {
+            ::close(fd);
+            return corrupt("stat " + path + ": " + strerror(errno));
+        }
+        _size = st.st_size;
+        if (_size < SNAPSHOT_HEADER_SIZE + SNAPSHOT_FOOTER_SIZE) {
+            ::close(fd);
+            return corrupt(path + ": file too short");
+        }
+        void* addr = mmap(nullptr, _size, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (addr == MAP_FAILED) {
+            return corrupt("mmap " + path + ": " + strerror(errno));
+        }
+        _data = static_cast<const char*>(addr);
+        _mapped = true;
+        madvise(addr, _size, MADV_SEQUENTIAL);
+    }
+
+    if (memcmp(_data, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC)) != 0) {
+        return corrupt(path + ": bad magic");
+    }
+    _version = snapshot_get<uint32_t>(_data + 8);
+    if (_version != SNAPSHOT_VERSION && _version != SNAPSHOT_VERSION_SECONDS) {
+        return corrupt(path + ": unsupported version " + std::to_string(_version));
+    }
+    _sequence = snapshot_get<uint32_t>(_data + 12);
+
+    const char* footer = _data + _size - SNAPSHOT_FOOTER_SIZE;
+    if (memcmp(footer + 40, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC)) != 0) {
+        return corrupt(path + ": missing footer, file truncated?");
+    }
+    uint64_t index_offset = snapshot_get<uint64_t>(footer);
+    uint64_t index_size = snapshot_get<uint64_t>(footer + 8);
+    _block_count = snapshot_get<uint64_t>(footer + 16);
+    _record_count = snapshot_get<uint64_t>(footer + 24);
+    uint32_t index_crc = snapshot_get<uint32_t>(footer + 32);
+    if (index_offset < SNAPSHOT_HEADER_SIZE || index_offset + index_size != _size - SNAPSHOT_FOOTER_SIZE) {
+        return corrupt(path + ": bad index position");
+    }
+    _index = _data + index_offset;
+    _index_end = _index + index_size;
+    if (snapshot_crc32c(_index, index_size) != index_crc) {
+        return corrupt(path + ": index checksum mismatch");
+    }
+    _cursor = _block_end = nullptr;
+    return true;
+}
+
+inline bool SnapshotReader::enter_block() {
+    if (_index == _index_end) {
+        return false;
+    }
+    if (_index_end - _index < 20) {
+        return corrupt("truncated index entry");
+    }
+    uint64_t offset = snapshot_get<uint64_t>(_index);
+    uint32_t block_size = snapshot_get<uint32_t>(_index + 8);
+    uint32_t first_key_len = snapshot_get<uint32_t>(_index + 16);
+    _index += 20 + first_key_len;
+    if (_index > _index_end) {
+        return corrupt("truncated index entry");
+    }
+
+    uint64_t total = SNAPSHOT_BLOCK_HEADER_SIZE + static_cast<uint64_t>(block_size) + 4;
+    if (offset < SNAPSHOT_HEADER_SIZE || offset + total > _size - SNAPSHOT_FOOTER_SIZE) {
+        return corrupt("block out of range at offset " + std::to_string(offset));
+    }
+    const char* block = _data + offset;
+    if (snapshot_get<uint32_t>(block) != block_size) {
+        return corrupt("block size mismatch at offset " + std::to_string(offset));
+    }
+    uint32_t crc = snapshot_get<uint32_t>(block + SNAPSHOT_BLOCK_HEADER_SIZE + block_size);
+    if (snapshot_crc32c(block, SNAPSHOT_BLOCK_HEADER_SIZE + block_size) != crc) {
+        return corrupt("block checksum mismatch at offset " + std::to_string(offset));
+    }
+    _cursor = block + SNAPSHOT_BLOCK_HEADER_SIZE;
+    _block_end = _cursor + block_size;
+    return true;
+}
+
+template<typename K, typename V>
+bool SnapshotReader::next(K& key, V& value, int64_t& expire_time) {
+    if (_data == nullptr || !_error.empty()) {
+        return false;
+    }
+    while (_cursor == _block_end) {
+        if (!enter_block()) {
+            return false;
+        }
+    }
+    if (_block_end - _cursor < (ptrdiff_t)SNAPSHOT_RECORD_HEADER_SIZE) {
+        return corrupt("truncated record");
+    }
+    uint32_t key_len = snapshot_get<uint32_t>(_cursor);
+    uint32_t value_len = snapshot_get<uint32_t>(_cursor + 4);
+    expire_time = snapshot_get<int64_t>(_cursor + 8);
+    if (_version == SNAPSHOT_VERSION_SECONDS && expire_time > 0) {
+        expire_time *= 1000;
+    }
+    const char* p = _cursor + SNAPSHOT_RECORD_HEADER_SIZE;
+    if ((uint64_t)(_block_end - p) < (uint64_t)key_len + value_len) {
+        return corrupt("truncated record");
+    }
+    if (!SnapshotCodec<K>::decode(p, key_len, key) ||
+        (expire_time != SNAPSHOT_TOMBSTONE && !SnapshotCodec<V>::decode(p + key_len, value_len, value))) {
+        return corrupt("record does not decode as the requested key/value types");
+    }
+    _cursor = p + key_len + value_len;
+    return true;
+}
+
+#endif
@@ -0,0 +1,101 @@
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include <sys/resource.h>
+#include "../skiplist.h"
+
+// 节点内存池基准：插入、随机查找（每跳一次缓存未命中的代价）、析构的耗时，以及堆分配次数和峰值内存。
+// make arena_bench 使用内存池；make arena_bench_malloc 定义 SKIPLIST_MALLOC_NODES，每个节点单独分配。
+// 用法：./bin/arena_bench [key_count]，默认 1000000
+
+static std::atomic<long> g_alloc_count(0);
+
+void* operator new(size_t size) {
+    g_alloc_count.fetch_add(1, std::memory_order_relaxed);
+    void* p = std::malloc(size);
+    if (p == nullptr) {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, size_t) noexcept {
+    std::free(p);
+}
+
+double seconds_since(std::chrono::high_resolution_clock::time_point start) {
+    std::chrono::duration<double> elapsed = std::chrono::high_resolution_clock::now() - start;
+    return elapsed.count();
+}
+
+int main(int argc, char* argv[]) {
+    int key_count = argc > 1 ? atoi(argv[1]) : 1000000;
+
+    std::vector<int> keys(key_count);
+    for (int i = 0; i < key_count; i++) {
+        keys[i] = i;
+    }
+    std::mt19937 gen(42);
+    std::shuffle(keys.begin(), keys.end(), gen);
+
+    double insert_time, search_time, teardown_time;
+    long insert_allocs;
+    {
+        SkipList<int, int>* list = new SkipList<int, int>(24);
+
+        // 跳表每次操作都会打印日志，测量期间关闭 std::cout
+        std::cout.setstate(std::ios_base::badbit);
+
+        long allocs_before = g_alloc_count.load();
+        auto start = std::chrono::high_resolution_clock::now();
+        for (int i = 0; i < key_count; i++) {
+            list->insert_element(keys[i], i);
+        }
+        insert_time = seconds_since(start);
+        insert_allocs = g_alloc_count.load() - allocs_before;
+
+        std::shuffle(keys.begin(), keys.end(), gen);
+        start = std::chrono::high_resolution_clock::now();
+        for (int i = 0; i < key_count; i++) {
+            list->search_element(keys[i]);
+        }
+        search_time = seconds_since(start);
+
+        std::cout.clear();
+
+        start = std::chrono::high_resolution_clock::now();
+        delete list;
+        teardown_time = seconds_since(start);
+    }
+
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+
+#ifdef SKIPLIST_MALLOC_NODES
+    std::cout << "node allocation: operator new per node" << std::endl;
+#else
+    std::cout << "node allocation: arena" << std::endl;
+#endif
+    std::cout << std::fixed << std::setprecision(3)
+              << "keys:            " << key_count << "\n"
+              << "insert:          " << insert_time << " s ("
+              << std::setprecision(0) << key_count / insert_time << " ops/sec)\n"
+              << std::setprecision(3)
+              << "search:          " << search_time << " s ("
+              << std::setprecision(0) << key_count / search_time << " ops/sec)\n"
+              << std::setprecision(3)
+              << "teardown:        " << teardown_time << " s\n"
+              << "heap allocs:     " << insert_allocs << " during insert\n"
+              << "peak rss:        " << usage.ru_maxrss / 1024 << " MB" << std::endl;
+    return 0;
+}
@@ -0,0 +1,133 @@
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include <cstdlib>
+#include "../skiplist.h"
+
+// 批量接口基准：每批 BATCH_SIZE 个键，比较逐个调用（每个键一次加锁、一次从头节点开始的查找）
+// 和 multi_get / write（整批一次加锁、finger search）的每键耗时。
+// 键分两种分布：clustered 为随机起点后的一段连续键，random 为整个键空间上均匀随机。
+// 跳表预先装入 key_count 个偶数键；写入测试先插入一批奇数键再把它们删除，跳表大小保持不变。
+// 用法：./bin/batch_bench [key_count]，默认 1000000
+
+#define MAX_LEVEL 24
+#define BATCH_SIZE 256
+#define ROUNDS 2000
+
+double seconds_since(std::chrono::high_resolution_clock::time_point start) {
+    std::chrono::duration<double> elapsed = std::chrono::high_resolution_clock::now() - start;
+    return elapsed.count();
+}
+
+// 生成 ROUNDS 批键，clustered 时每批是同一段内相邻的键
+std::vector<std::vector<int>> make_batches(int key_count, bool clustered, bool odd) {
+    std::mt19937 gen(clustered ? 1 : 2);
+    std::vector<std::vector<int>> batches(ROUNDS);
+    for (int r = 0; r < ROUNDS; r++) {
+        int base = gen() % (key_count - BATCH_SIZE);
+        for (int i = 0; i < BATCH_SIZE; i++) {
+            int slot = clustered ? base + i : gen() % key_count;
+            batches[r].push_back(slot * 2 + (odd ? 1 : 0));
+        }
+        std::shuffle(batches[r].begin(), batches[r].end(), gen);
+        // 随机分布下同一批可能抽到重复的键，插入/删除测试需要去重
+        std::sort(batches[r].begin(), batches[r].end());
+        batches[r].erase(std::unique(batches[r].begin(), batches[r].end()), batches[r].end());
+        std::shuffle(batches[r].begin(), batches[r].end(), gen);
+    }
+    return batches;
+}
+
+long count_keys(const std::vector<std::vector<int>>& batches) {
+    long n = 0;
+    for (size_t i = 0; i < batches.size(); i++) {
+        n += batches[i].size();
+    }
+    return n;
+}
+
+void run(SkipList<int, int>& list, int key_count, bool clustered) {
+    std::vector<std::vector<int>> reads = make_batches(key_count, clustered, false);
+    std::vector<std::vector<int>> writes = make_batches(key_count, clustered, true);
+    long read_keys = count_keys(reads);
+    long write_keys = count_keys(writes);
+    long found = 0;
+
+    auto start = std::chrono::high_resolution_clock::now();
+    for (size_t r = 0; r < reads.size(); r++) {
+        for (int key : reads[r]) {
+            found += list.get(key).has_value();
+        }
+    }
+    double get_single = seconds_since(start);
+
+    start = std::chrono::high_resolution_clock::now();
+    for (size_t r = 0; r < reads.size(); r++) {
+        std::vector<std::optional<int>> values = list.multi_get(reads[r]);
+        for (size_t i = 0; i < values.size(); i++) {
+            found += values[i].has_value();
+        }
+    }
+    double get_batch = seconds_since(start);
+
+    // 逐个调用会为每个键打印日志，测量期间关闭 std::cout
+    std::cout.setstate(std::ios_base::badbit);
+    start = std::chrono::high_resolution_clock::now();
+    for (size_t r = 0; r < writes.size(); r++) {
+        for (int key : writes[r]) {
+            list.insert_element(key, key);
+        }
+        for (int key : writes[r]) {
+            list.delete_element(key);
+        }
+    }
+    double write_single = seconds_since(start);
+    std::cout.clear();
+
+    start = std::chrono::high_resolution_clock::now();
+    for (size_t r = 0; r < writes.size(); r++) {
+        WriteBatch<int, int> puts;
+        WriteBatch<int, int> removes;
+        for (int key : writes[r]) {
+            puts.put(key, key);
+            removes.remove(key);
+        }
+        list.write(puts);
+        list.write(removes);
+    }
+    double write_batch = seconds_since(start);
+
+    std::cout << std::setw(10) << (clustered ? "clustered" : "random")
+              << std::fixed << std::setprecision(1)
+              << std::setw(14) << get_single * 1e9 / read_keys
+              << std::setw(14) << get_batch * 1e9 / read_keys
+              << std::setw(14) << write_single * 1e9 / (write_keys * 2)
+              << std::setw(14) << write_batch * 1e9 / (write_keys * 2) << std::endl;
+    if (found != read_keys * 2) {
+        std::cout << "unexpected misses: " << read_keys * 2 - found << std::endl;
+    }
+}
+
+int main(int argc, char* argv[]) {
+    int key_count = argc > 1 ? atoi(argv[1]) : 1000000;
+
+    SkipList<int, int> list(MAX_LEVEL);
+    WriteBatch<int, int> load;
+    for (int i = 0; i < key_count; i++) {
+        load.put(i * 2, i * 2);
+    }
+    list.write(load);
+
+    std::cout << "keys: " << list.size() << ", batch size: " << BATCH_SIZE << std::endl;
+    std::cout << std::setw(10) << "keys"
+              << std::setw(14) << "get ns/key"
+              << std::setw(14) << "multi_get"
+              << std::setw(14) << "write ns/key"
+              << std::setw(14) << "WriteBatch" << std::endl;
+    run(list, key_count, true);
+    run(list, key_count, false);
+    return 0;
+}
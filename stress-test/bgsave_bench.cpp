@@ -0,0 +1,147 @@
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <sstream>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+
+// 使用单独的文件，不覆盖 store/dumpFile
+#define STORE_FILE "store/bgsave_bench_dump"
+#include "../Timer_LRU_SkipList.h"
+
+// 保存期间的写延迟基准：预先装入 key_count 个键（值为 value_size 字节），writer 个线程按固定速率
+// （每个线程 RATE 次/秒）插入并删除新键，期间保存一次快照，比较两种方式下计划在保存期间开始的写操作的延迟。
+// 延迟从计划开始时间算起，被锁挡住期间本该发出的请求都计入等待时间，不会因为线程卡住而少算。
+//   blocking   dump_file，与原来的 periodic_task 一样整个保存过程持锁
+//   background background_save，只在轮换日志和 fork 时持锁，子进程写快照
+// 另给出没有保存时的基线。pause 为保存时写线程被挡住的时间（blocking 为整个 dump，background 为 fork）。
+// 用法：./bin/bgsave_bench [key_count] [value_size] [writers]，默认 2000000 100 2
+
+#define MAX_LEVEL 22
+#define QUIET_MS 300 // 保存前后各运行一段时间
+#define RATE 20000 // 每个写线程每秒的操作数
+
+typedef SkipList<int, std::string> Store;
+typedef std::chrono::steady_clock Clock;
+
+struct Sample {
+    Clock::time_point start;
+    double latency_us;
+};
+
+double percentile(std::vector<double>& v, double q) {
+    if (v.empty()) {
+        return 0;
+    }
+    size_t rank = std::min(v.size() - 1, static_cast<size_t>(q * v.size()));
+    std::nth_element(v.begin(), v.begin() + rank, v.end());
+    return v[rank];
+}
+
+// mode: 0 不保存，1 blocking，2 background
+void run(Store& store, int mode, int writers, int key_count, std::ostream& out) {
+    std::atomic<bool> stop(false);
+    std::vector<std::vector<Sample>> samples(writers);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < writers; t++) {
+        threads.emplace_back([&, t] {
+            unsigned int seed = mode * 100 + t + 1;
+            Clock::time_point begin = Clock::now();
+            std::chrono::nanoseconds period(1000000000L / RATE);
+            for (long i = 0; !stop; i++) {
+                Clock::time_point start = begin + period * i;
+                while (Clock::now() < start) {
+                    std::this_thread::yield();
+                }
+                // 新键都大于已装入的键，插入后立即删除，跳表大小不变
+                int key = key_count + (rand_r(&seed) % key_count);
+                store.insert_element(key, "v");
+                store.delete_element(key);
+                std::chrono::duration<double, std::micro> elapsed = Clock::now() - start;
+                samples[t].push_back(Sample{start, elapsed.count()});
+            }
+        });
+    }
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(QUIET_MS));
+    auto save_start = Clock::now();
+    if (mode == 1) {
+        store.dump_file();
+    } else if (mode == 2) {
+        store.background_save();
+        while (store.saving()) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    } else {
+        std::this_thread::sleep_for(std::chrono::milliseconds(QUIET_MS));
+    }
+    auto save_end = Clock::now();
+    std::this_thread::sleep_for(std::chrono::milliseconds(QUIET_MS));
+    stop = true;
+    for (size_t t = 0; t < threads.size(); t++) {
+        threads[t].join();
+    }
+
+    // 只统计保存期间开始的写操作
+    std::vector<double> window;
+    for (int t = 0; t < writers; t++) {
+        for (const Sample& s : samples[t]) {
+            if (s.start >= save_start && s.start < save_end) {
+                window.push_back(s.latency_us);
+            }
+        }
+    }
+    std::chrono::duration<double> save_time = save_end - save_start;
+    const char* names[] = {"none", "blocking", "background"};
+    double max_us = window.empty() ? 0 : *std::max_element(window.begin(), window.end());
+    out << std::setw(12) << names[mode] << std::fixed
+        << std::setw(10) << std::setprecision(3) << save_time.count()
+        << std::setw(10) << std::setprecision(1) << percentile(window, 0.5)
+        << std::setw(12) << percentile(window, 0.99)
+        << std::setw(12) << percentile(window, 0.999)
+        << std::setw(12) << max_us / 1000 << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+    int key_count = argc > 1 ? atoi(argv[1]) : 2000000;
+    int value_size = argc > 2 ? atoi(argv[2]) : 100;
+    int writers = argc > 3 ? atoi(argv[3]) : 2;
+
+    // 定时器周期设得足够长，保存由本程序触发
+    Store store(MAX_LEVEL, 1024, 3600 * 1000);
+    std::string value(value_size, 'v');
+    int next = 0;
+    store.bulk_load([&](int& k, std::string& v, int64_t& expire_time) {
+        if (next == key_count) {
+            return false;
+        }
+        k = next++;
+        v = value;
+        expire_time = 0;
+        return true;
+    });
+    std::cout << "keys: " << key_count << ", value size: " << value_size << ", writers: " << writers << std::endl;
+    std::cout << std::setw(12) << "save" << std::setw(10) << "save s"
+              << std::setw(10) << "p50 us" << std::setw(12) << "p99 us" << std::setw(12) << "p999 us"
+              << std::setw(12) << "max ms" << std::endl;
+
+    // 插入、删除和保存都会打印日志，测量期间关闭 std::cout，结果先写入 rows
+    std::ostringstream rows;
+    std::cout.setstate(std::ios_base::badbit);
+    for (int mode = 0; mode < 3; mode++) {
+        run(store, mode, writers, key_count, rows);
+    }
+    std::cout.clear();
+    std::cout << rows.str();
+    SkipListStats stats = store.stats();
+    std::cout << "pause: blocking " << std::fixed << std::setprecision(1)
+              << stats.ops[STATS_DUMP].max_ns / 1e6 << " ms, background (fork) "
+              << stats.ops[STATS_BGSAVE_FORK].max_ns / 1e6 << " ms" << std::endl;
+    std::remove(STORE_FILE);
+    return 0;
+}
@@ -0,0 +1,85 @@
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <thread>
+#include <chrono>
+#include <random>
+#include <cmath>
+#include <cstdlib>
+#include "../LRU_skiplist.h"
+
+// 缓存并发基准：多个线程同时 search_element（读多写少，每 WRITE_EVERY 次读夹一次 insert_element 覆盖不存在的键），
+// 比较 LRUCache（命中移动链表，整个查找持写锁）与 ClockCache（命中只原子置位，查找持共享锁）随线程数的吞吐。
+// 键按 zipf 近似分布（热键为小编号），跳表装入 key_count 个键，缓存容量为 capacity。
+// 用法：./bin/cache_concurrency_bench [key_count] [capacity] [ops_per_thread]，默认 1000000 100000 500000
+
+#define MAX_LEVEL 22
+#define WRITE_EVERY 20
+
+// 每个线程预先生成自己的访问序列：rank = key_count^u - 1 近似 zipf(1)，不需要累积分布表
+std::vector<int> make_trace(int key_count, int ops, int seed) {
+    std::mt19937_64 gen(seed);
+    std::uniform_real_distribution<double> dist(0, 1);
+    std::vector<int> trace(ops);
+    for (int i = 0; i < ops; i++) {
+        trace[i] = static_cast<int>(std::pow(static_cast<double>(key_count), dist(gen))) - 1;
+    }
+    return trace;
+}
+
+template<template<typename, typename> class Cache>
+void run(const char* policy, int key_count, int capacity, int ops, int threads) {
+    SkipList<int, int, Cache> store(MAX_LEVEL, capacity);
+    std::vector<std::pair<int, int>> data(key_count);
+    for (int i = 0; i < key_count; i++) {
+        data[i] = std::make_pair(i * 2, i); // 偶数键，写入奇数键不会和读的键冲突
+    }
+    store.bulk_load(data);
+    std::vector<std::vector<int>> traces;
+    for (int t = 0; t < threads; t++) {
+        traces.push_back(make_trace(key_count, ops, t + 1));
+    }
+
+    std::cout.setstate(std::ios_base::badbit);
+    auto start = std::chrono::high_resolution_clock::now();
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; t++) {
+        workers.emplace_back([&, t] {
+            const std::vector<int>& trace = traces[t];
+            for (int i = 0; i < ops; i++) {
+                if (i % WRITE_EVERY == WRITE_EVERY - 1) {
+                    store.insert_element(trace[i] * 2 + 1, i);
+                } else {
+                    store.search_element(trace[i] * 2);
+                }
+            }
+        });
+    }
+    for (std::thread& w : workers) {
+        w.join();
+    }
+    std::chrono::duration<double> elapsed = std::chrono::high_resolution_clock::now() - start;
+    std::cout.clear();
+
+    SkipListStats stats = store.stats();
+    std::cout << std::setw(10) << policy << std::setw(9) << threads << std::fixed
+              << std::setw(14) << std::setprecision(0) << static_cast<double>(ops) * threads / elapsed.count()
+              << std::setw(10) << std::setprecision(2) << stats.lru_hit_ratio() * 100
+              << std::setw(18) << std::setprecision(0) << stats.ops[STATS_LOCK_WAIT].percentile(0.99) << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+    int key_count = argc > 1 ? atoi(argv[1]) : 1000000;
+    int capacity = argc > 2 ? atoi(argv[2]) : 100000;
+    int ops = argc > 3 ? atoi(argv[3]) : 500000;
+
+    std::cout << "keys: " << key_count << ", capacity: " << capacity << ", ops per thread: " << ops
+              << ", hardware threads: " << std::thread::hardware_concurrency() << std::endl;
+    std::cout << std::setw(10) << "policy" << std::setw(9) << "threads" << std::setw(14) << "ops/s"
+              << std::setw(10) << "hit %" << std::setw(18) << "lock wait p99 ns" << std::endl;
+    for (int threads : {1, 2, 4, 8}) {
+        run<LRUCache>("lru", key_count, capacity, ops, threads);
+        run<ClockCache>("clock", key_count, capacity, ops, threads);
+    }
+    return 0;
+}
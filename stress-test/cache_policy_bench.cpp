@@ -0,0 +1,115 @@
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <random>
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include "../LRU_skiplist.h"
+
+// 缓存策略基准：同一组访问序列分别在 LRUCache、TinyLFUCache 和 ClockCache 的跳表上执行 search_element，比较命中率和吞吐。
+//   zipf      键按 zipf(ZIPF_THETA) 分布，排名靠前的键最热
+//   scan      zipf 访问中每 SCAN_EVERY 次插入一段长度为缓存容量的顺序扫描，扫描的键只访问一次
+//   uniform   均匀随机（与 stress_test 的 rand() % TEST_COUNT 相同），命中率的上限约为 容量/键数
+// 跳表装入 [0, key_count) 的全部键，缓存容量为 capacity。
+// 用法：./bin/cache_policy_bench [key_count] [capacity] [ops]，默认 1000000 10000 2000000
+
+#define MAX_LEVEL 22
+#define ZIPF_THETA 0.99
+#define SCAN_EVERY 100000
+
+// 按累积分布表抽样的 zipf 生成器，返回 [0, n) 中的排名
+class Zipf {
+public:
+    Zipf(int n, double theta) : _cdf(n) {
+        double sum = 0;
+        for (int i = 0; i < n; i++) {
+            sum += 1.0 / std::pow(i + 1, theta);
+            _cdf[i] = sum;
+        }
+        for (int i = 0; i < n; i++) {
+            _cdf[i] /= sum;
+        }
+    }
+
+    int operator()(std::mt19937_64& gen) {
+        double u = std::uniform_real_distribution<double>(0, 1)(gen);
+        return static_cast<int>(std::lower_bound(_cdf.begin(), _cdf.end(), u) - _cdf.begin());
+    }
+
+private:
+    std::vector<double> _cdf;
+};
+
+std::vector<int> make_trace(const std::string& name, int key_count, int capacity, int ops) {
+    std::mt19937_64 gen(42);
+    Zipf zipf(key_count, ZIPF_THETA);
+    // 排名打乱后映射到键，热键不集中在跳表的一端
+    std::vector<int> rank_to_key(key_count);
+    for (int i = 0; i < key_count; i++) {
+        rank_to_key[i] = i;
+    }
+    std::shuffle(rank_to_key.begin(), rank_to_key.end(), gen);
+
+    std::vector<int> trace;
+    trace.reserve(ops);
+    int scan_cursor = 0;
+    while (static_cast<int>(trace.size()) < ops) {
+        if (name == "uniform") {
+            trace.push_back(gen() % key_count);
+            continue;
+        }
+        trace.push_back(rank_to_key[zipf(gen)]);
+        if (name == "scan" && trace.size() % SCAN_EVERY == 0) {
+            for (int i = 0; i < capacity && static_cast<int>(trace.size()) < ops; i++) {
+                trace.push_back(scan_cursor);
+                scan_cursor = (scan_cursor + 1) % key_count;
+            }
+        }
+    }
+    return trace;
+}
+
+template<template<typename, typename> class Cache>
+void run(const char* policy, const std::vector<int>& trace, int key_count, int capacity) {
+    SkipList<int, int, Cache> store(MAX_LEVEL, capacity);
+    std::vector<std::pair<int, int>> data(key_count);
+    for (int i = 0; i < key_count; i++) {
+        data[i] = std::make_pair(i, i);
+    }
+    store.bulk_load(data);
+
+    std::cout.setstate(std::ios_base::badbit);
+    auto start = std::chrono::high_resolution_clock::now();
+    for (int key : trace) {
+        store.search_element(key);
+    }
+    std::chrono::duration<double> elapsed = std::chrono::high_resolution_clock::now() - start;
+    std::cout.clear();
+
+    SkipListStats stats = store.stats();
+    std::cout << std::setw(10) << policy << std::fixed
+              << std::setw(12) << std::setprecision(2) << stats.lru_hit_ratio() * 100
+              << std::setw(14) << std::setprecision(0) << trace.size() / elapsed.count()
+              << std::setw(14) << stats.lru_evictions << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+    int key_count = argc > 1 ? atoi(argv[1]) : 1000000;
+    int capacity = argc > 2 ? atoi(argv[2]) : 10000;
+    int ops = argc > 3 ? atoi(argv[3]) : 2000000;
+
+    std::cout << "keys: " << key_count << ", capacity: " << capacity << ", ops: " << ops << std::endl;
+    for (const char* name : {"zipf", "scan", "uniform"}) {
+        std::vector<int> trace = make_trace(name, key_count, capacity, ops);
+        std::cout << name << std::endl;
+        std::cout << std::setw(10) << "policy" << std::setw(12) << "hit %" << std::setw(14) << "ops/s"
+                  << std::setw(14) << "evictions" << std::endl;
+        run<LRUCache>("lru", trace, key_count, capacity);
+        run<TinyLFUCache>("tinylfu", trace, key_count, capacity);
+        run<ClockCache>("clock", trace, key_count, capacity);
+    }
+    return 0;
+}
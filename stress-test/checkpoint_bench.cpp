@@ -0,0 +1,145 @@
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <string>
+#include <chrono>
+#include <random>
+#include <vector>
+#include <cstdio>
+#include <cstdlib>
+
+// 使用单独的文件，不覆盖 store/dumpFile
+#define STORE_FILE "store/checkpoint_bench_dump"
+#include "../Timer_LRU_SkipList.h"
+
+// 增量检查点基准：装入 key_count 个键（值为 value_size 字节）并写一次全量快照，之后每轮随机改写
+// updates 个键、删除 updates/10 个键，再保存一次，比较每轮全量 dump_file 和增量 checkpoint 写出的字节数和耗时。
+// 增量模式每 ROUNDS 个 delta 合并一次 base，最后一轮包含这次合并。写出字节数取自 /proc/self/io 的 wchar。
+// 两种方式依次运行（共用 STORE_FILE），最后比较两种文件的加载耗时，并检查加载结果与跳表一致。
+// 用法：./bin/checkpoint_bench [key_count] [value_size] [updates]，默认 1000000 1000 1000
+
+#define MAX_LEVEL 22
+#define ROUNDS 8
+
+typedef SkipList<int, std::string> Store;
+
+double seconds_since(std::chrono::high_resolution_clock::time_point start) {
+    std::chrono::duration<double> elapsed = std::chrono::high_resolution_clock::now() - start;
+    return elapsed.count();
+}
+
+// 本进程累计传给 write 系列调用的字节数。io_uring 的写不计入，所以 makefile 为本基准指定 pwrite 后端
+long long written_bytes() {
+    std::ifstream io("/proc/self/io");
+    std::string name;
+    long long value;
+    while (io >> name >> value) {
+        if (name == "wchar:") {
+            return value;
+        }
+    }
+    return 0;
+}
+
+void fill(Store& store, int key_count, int value_size) {
+    std::string value(value_size, 'v');
+    int next = 0;
+    store.bulk_load([&](int& k, std::string& v, int64_t& expire_time) {
+        if (next == key_count) {
+            return false;
+        }
+        k = next++;
+        v = value;
+        expire_time = 0;
+        return true;
+    });
+}
+
+void update(Store& store, std::mt19937& gen, int key_count, int updates, int round) {
+    WriteBatch<int, std::string> batch;
+    for (int i = 0; i < updates; i++) {
+        batch.put(gen() % key_count, "round" + std::to_string(round));
+    }
+    for (int i = 0; i < updates / 10; i++) {
+        batch.remove(gen() % key_count);
+    }
+    store.write(batch);
+}
+
+double load_time(int* size) {
+    Store loaded(MAX_LEVEL, 1024, 3600 * 1000);
+    auto start = std::chrono::high_resolution_clock::now();
+    loaded.load_file();
+    double elapsed = seconds_since(start);
+    *size = loaded.size();
+    return elapsed;
+}
+
+// 每轮改动后保存一次，返回每轮写出的 MB 和耗时（秒）；incremental 为 false 时每轮 dump_file
+void run(bool incremental, int key_count, int value_size, int updates,
+         std::vector<double>& mb, std::vector<double>& seconds, double* load_seconds) {
+    Store store(MAX_LEVEL, 1024, 3600 * 1000);
+    fill(store, key_count, value_size);
+    if (incremental) {
+        store.enable_incremental_checkpoints(ROUNDS);
+        store.dump_file(); // 初始 base
+    }
+    std::mt19937 gen(7);
+    for (int round = 1; round <= ROUNDS; round++) {
+        update(store, gen, key_count, updates, round);
+        long long before = written_bytes();
+        auto start = std::chrono::high_resolution_clock::now();
+        if (incremental) {
+            store.checkpoint();
+        } else {
+            store.dump_file();
+        }
+        seconds.push_back(seconds_since(start));
+        mb.push_back((written_bytes() - before) / (1024.0 * 1024.0));
+    }
+    if (incremental) {
+        // 合并后再写一轮 delta，加载时需要 base + delta
+        update(store, gen, key_count, updates, ROUNDS + 1);
+        store.checkpoint();
+    }
+    int loaded_size;
+    *load_seconds = load_time(&loaded_size);
+    if (loaded_size != store.size()) {
+        std::cerr << "load mismatch: " << loaded_size << " != " << store.size() << std::endl;
+    }
+    std::remove(STORE_FILE);
+    std::remove(checkpoint_delta_path(STORE_FILE, ROUNDS + 2).c_str());
+}
+
+int main(int argc, char* argv[]) {
+    int key_count = argc > 1 ? atoi(argv[1]) : 1000000;
+    int value_size = argc > 2 ? atoi(argv[2]) : 1000;
+    int updates = argc > 3 ? atoi(argv[3]) : 1000;
+
+    // 两种方式依次运行，改动序列相同
+    std::vector<double> full_mb, full_seconds, delta_mb, delta_seconds;
+    double full_load, delta_load;
+    std::cout.setstate(std::ios_base::badbit);
+    run(false, key_count, value_size, updates, full_mb, full_seconds, &full_load);
+    run(true, key_count, value_size, updates, delta_mb, delta_seconds, &delta_load);
+    std::cout.clear();
+
+    std::cout << "keys: " << key_count << ", value size: " << value_size
+              << ", updates per round: " << updates << " + " << updates / 10 << " deletes" << std::endl;
+    std::cout << std::setw(6) << "round" << std::setw(14) << "full MB" << std::setw(12) << "full ms"
+              << std::setw(14) << "delta MB" << std::setw(12) << "delta ms" << std::endl;
+    double full_total = 0, delta_total = 0;
+    for (int i = 0; i < ROUNDS; i++) {
+        full_total += full_mb[i];
+        delta_total += delta_mb[i];
+        std::cout << std::setw(6) << i + 1 << std::fixed
+                  << std::setw(14) << std::setprecision(3) << full_mb[i]
+                  << std::setw(12) << std::setprecision(1) << full_seconds[i] * 1000
+                  << std::setw(14) << std::setprecision(3) << delta_mb[i]
+                  << std::setw(12) << std::setprecision(1) << delta_seconds[i] * 1000
+                  << (i == ROUNDS - 1 ? "  (delta + compaction)" : "") << std::endl;
+    }
+    std::cout << std::setprecision(3) << "total MB: full " << full_total << ", incremental " << delta_total << std::endl;
+    std::cout << "load: full " << full_load << " s, base + 1 delta " << delta_load << " s" << std::endl;
+    return 0;
+}
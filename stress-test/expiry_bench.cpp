@@ -0,0 +1,157 @@
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <thread>
+#include <atomic>
+#include <algorithm>
+#include <cstdlib>
+
+#include "../LRU_skiplist.h"
+
+// 过期基准，两部分：
+//   steady  装入 key_count 个带过期时间的键，过期时间（毫秒）均匀分布在之后的 spread 秒内，运行 seconds 秒，
+//           每 TICK_MS 毫秒调用一次 evict_expired_items。给出每次清理的平均/最大耗时和删除的节点数，
+//           并与遍历整个跳表（原来全量扫描方式的最低代价）对比，最后检查剩下的正好是还没过期的键。
+//   burst   同样的键中 1/5 在同一时刻过期，一个读线程不停地随机 get，比较一次 evict_expired_items 全部删除
+//           与每 TICK_MS 毫秒一次、每次最多 BUDGET_US 微秒的 active_expire_cycle 两种方式下读的 p99/最大延迟。
+// 用法：./bin/expiry_bench [key_count] [spread] [seconds]，默认 2000000 1000 5
+
+#define MAX_LEVEL 22
+#define TICK_MS 100
+#define BUDGET_US 2000
+
+typedef SkipList<int, std::string> Store;
+
+double ms_since(std::chrono::high_resolution_clock::time_point start) {
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::high_resolution_clock::now() - start;
+    return elapsed.count();
+}
+
+// 装入 [0, key_count)，expire(k) 给出每个键的过期时间
+template<typename Expire>
+void fill(Store& store, int key_count, Expire expire) {
+    int next = 0;
+    store.bulk_load([&](int& k, std::string& v, int64_t& expire_time) {
+        if (next == key_count) {
+            return false;
+        }
+        k = next++;
+        v = "value";
+        expire_time = expire(k);
+        return true;
+    });
+}
+
+void steady(int key_count, int spread, int seconds) {
+    Store store(MAX_LEVEL, 1024);
+    int64_t base = expiry_now_ms();
+    auto expire = [&](int k) { return base + 1000 + (static_cast<int64_t>(k) * 7919) % (spread * 1000L); };
+    auto start = std::chrono::high_resolution_clock::now();
+    fill(store, key_count, expire);
+    std::cout << "steady: keys " << key_count << ", expiring per second " << key_count / spread
+              << ", load " << std::fixed << std::setprecision(1) << ms_since(start) << " ms" << std::endl;
+
+    // 全量扫描：scan 访问每个节点并检查过期时间
+    start = std::chrono::high_resolution_clock::now();
+    size_t live = store.scan(0, key_count, 0, [](const int&, const std::string&) {});
+    double scan_ms = ms_since(start);
+
+    int ticks = 0;
+    double total_ms = 0, max_ms = 0;
+    int before = store.size();
+    int64_t tick_begin = 0, tick_end = 0;
+    auto end = std::chrono::steady_clock::now() + std::chrono::seconds(seconds);
+    while (std::chrono::steady_clock::now() < end) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(TICK_MS));
+        start = std::chrono::high_resolution_clock::now();
+        tick_begin = expiry_now_ms();
+        store.evict_expired_items();
+        tick_end = expiry_now_ms();
+        double elapsed = ms_since(start);
+        total_ms += elapsed;
+        max_ms = std::max(max_ms, elapsed);
+        ticks++;
+    }
+    int reclaimed = before - store.size();
+
+    std::cout << std::setprecision(3) << "  full scan: " << scan_ms << " ms per pass (" << live << " live keys)" << std::endl;
+    std::cout << "  expiry index: " << ticks << " ticks, reclaimed " << reclaimed << " nodes, avg "
+              << total_ms / ticks << " ms, max " << max_ms << " ms per tick" << std::endl;
+
+    // 最后一次清理之后，跳表中应只剩下清理时还没过期的键（时间轮按刻度取整，最多晚一个刻度）
+    int remaining_max = 0, remaining_min = 0;
+    for (int k = 0; k < key_count; k++) {
+        remaining_max += expire(k) > tick_begin - EXPIRY_WHEEL_TICK_MS;
+        remaining_min += expire(k) > tick_end;
+    }
+    if (store.size() < remaining_min || store.size() > remaining_max) {
+        std::cout << "  size mismatch: " << store.size() << " not in [" << remaining_min << ", " << remaining_max << "]" << std::endl;
+    }
+}
+
+// active 为 false 时一次 evict_expired_items，否则每 TICK_MS 毫秒一次有时间上限的 active_expire_cycle
+void burst(int key_count, bool active) {
+    Store store(MAX_LEVEL, 1024);
+    int64_t at = expiry_now_ms() + 1000;
+    fill(store, key_count, [&](int k) { return k % 5 == 0 ? at : 0; });
+
+    std::atomic<bool> stop(false);
+    std::vector<double> latencies;
+    std::thread reader([&] {
+        unsigned int seed = 1;
+        while (!stop) {
+            int k = rand_r(&seed) % key_count;
+            if (k % 5 == 0) {
+                k++; // 只读不过期的键，读时过期不会替清理做掉工作
+            }
+            auto start = std::chrono::high_resolution_clock::now();
+            store.get(k);
+            latencies.push_back(ms_since(start) * 1000);
+        }
+    });
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(at - expiry_now_ms() + 10));
+    size_t before = latencies.size(); // 只统计清理期间的读
+    auto start = std::chrono::high_resolution_clock::now();
+    int cycles = 0;
+    if (active) {
+        while (store.size() > key_count - key_count / 5) {
+            store.active_expire_cycle(BUDGET_US);
+            cycles++;
+            if (store.size() > key_count - key_count / 5) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(TICK_MS));
+            }
+        }
+    } else {
+        store.evict_expired_items();
+        cycles = 1;
+    }
+    double reclaim_ms = ms_since(start);
+    stop = true;
+    reader.join();
+
+    std::vector<double> window(latencies.begin() + before, latencies.end());
+    std::sort(window.begin(), window.end());
+    double p99 = window.empty() ? 0 : window[window.size() * 99 / 100];
+    double max = window.empty() ? 0 : window.back();
+    std::cout << "  " << std::setw(8) << (active ? "active" : "evict") << std::setw(10) << cycles
+              << std::setw(14) << std::setprecision(1) << reclaim_ms
+              << std::setw(12) << p99 << std::setw(12) << max << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+    int key_count = argc > 1 ? atoi(argv[1]) : 2000000;
+    int spread = argc > 2 ? atoi(argv[2]) : 1000;
+    int seconds = argc > 3 ? atoi(argv[3]) : 5;
+
+    steady(key_count, spread, seconds);
+
+    std::cout << "burst: " << key_count / 5 << " keys expire at once, active budget " << BUDGET_US << " us" << std::endl;
+    std::cout << "  " << std::setw(8) << "mode" << std::setw(10) << "cycles" << std::setw(14) << "reclaim ms"
+              << std::setw(12) << "read p99 us" << std::setw(12) << "read max us" << std::endl;
+    burst(key_count, false);
+    burst(key_count, true);
+    return 0;
+}
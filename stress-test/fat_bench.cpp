@@ -0,0 +1,120 @@
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <random>
+#include <algorithm>
+#include <cstdlib>
+#include <unistd.h>
+#include <malloc.h>
+#include "../skiplist.h"
+#include "../fat_skiplist.h"
+
+// 胖节点布局基准：按随机顺序插入 [0, n) 的 n 个 int 键，之后随机查找 lookups 个存在的键，
+// 比较 skiplist.h 的 SkipList（每个节点一个键）和 fat_skiplist.h 的 FatSkipList 的插入、查找吞吐和每个键占用的堆内存。
+// FatSkipList 的查找分别用 CPU 支持的 SIMD 和标量循环各跑一次。n 取 1M、10M、100M 中不超过 max_keys 的值；
+// 估计的内存超过可用物理内存时跳过该布局。
+// 用法：./bin/fat_bench [max_keys] [lookups]，默认 10000000 2000000
+
+#define MAX_LEVEL 26
+#define CLASSIC_BYTES_PER_KEY 48 // 估算内存用，实测 SkipList<int, int> 约 43 字节/键，FatSkipList<int, int> 约 18 字节/键
+#define FAT_BYTES_PER_KEY 24
+
+size_t heap_in_use() {
+    struct mallinfo2 info = mallinfo2();
+    return info.uordblks + info.hblkhd;
+}
+
+size_t available_memory() {
+    return static_cast<size_t>(sysconf(_SC_AVPHYS_PAGES)) * sysconf(_SC_PAGESIZE);
+}
+
+void print_row(const char* name, double insert_seconds, double lookup_seconds, size_t keys, size_t lookups,
+               size_t heap) {
+    std::cout << std::setw(14) << name << std::fixed << std::setprecision(0)
+              << std::setw(14) << keys / insert_seconds << std::setw(14) << lookups / lookup_seconds
+              << std::setprecision(1) << std::setw(12) << static_cast<double>(heap) / keys << std::endl;
+}
+
+template<typename List>
+double timed_lookups(List& list, const std::vector<int>& trace) {
+    size_t found = 0;
+    auto start = std::chrono::high_resolution_clock::now();
+    for (int key : trace) {
+        found += list.search_element(key) ? 1 : 0;
+    }
+    std::chrono::duration<double> elapsed = std::chrono::high_resolution_clock::now() - start;
+    if (found != trace.size()) {
+        std::cout << "lookup failed" << std::endl;
+    }
+    return elapsed.count();
+}
+
+template<typename List>
+double timed_inserts(List& list, const std::vector<int>& keys) {
+    auto start = std::chrono::high_resolution_clock::now();
+    for (int key : keys) {
+        list.insert_element(key, key);
+    }
+    std::chrono::duration<double> elapsed = std::chrono::high_resolution_clock::now() - start;
+    return elapsed.count();
+}
+
+int main(int argc, char* argv[]) {
+    size_t max_keys = argc > 1 ? strtoul(argv[1], nullptr, 10) : 10000000;
+    size_t lookups = argc > 2 ? strtoul(argv[2], nullptr, 10) : 2000000;
+
+    std::cout << "node capacity: " << FatSkipList<int, int>::kCapacity << " keys, in-node search: "
+              << fat_search_mode_name(fat_search_mode()) << std::endl;
+    std::mt19937_64 gen(11);
+    for (size_t n = 1000000; n <= max_keys; n *= 10) {
+        std::vector<int> keys(n);
+        for (size_t i = 0; i < n; i++) {
+            keys[i] = static_cast<int>(i);
+        }
+        std::shuffle(keys.begin(), keys.end(), gen);
+        std::vector<int> trace(lookups);
+        for (int& key : trace) {
+            key = static_cast<int>(gen() % n);
+        }
+
+        std::cout << "keys: " << n << std::endl;
+        std::cout << std::setw(14) << "layout" << std::setw(14) << "inserts/s" << std::setw(14) << "lookups/s"
+                  << std::setw(12) << "heap B/key" << std::endl;
+
+        if (n * CLASSIC_BYTES_PER_KEY < available_memory()) {
+            size_t heap_before = heap_in_use();
+            SkipList<int, int>* classic = new SkipList<int, int>(MAX_LEVEL);
+            std::cout.setstate(std::ios_base::badbit);
+            double insert_seconds = timed_inserts(*classic, keys);
+            double lookup_seconds = timed_lookups(*classic, trace);
+            std::cout.clear();
+            print_row("classic", insert_seconds, lookup_seconds, n, lookups, heap_in_use() - heap_before);
+            delete classic;
+        } else {
+            std::cout << std::setw(14) << "classic" << "  skipped, needs ~"
+                      << n * CLASSIC_BYTES_PER_KEY / (1 << 20) << " MB" << std::endl;
+        }
+
+        if (n * FAT_BYTES_PER_KEY < available_memory()) {
+            FatSearchMode simd = fat_search_mode();
+            size_t heap_before = heap_in_use();
+            FatSkipList<int, int>* fat = new FatSkipList<int, int>(MAX_LEVEL);
+            double insert_seconds = timed_inserts(*fat, keys);
+            double lookup_seconds = timed_lookups(*fat, trace);
+            size_t heap = heap_in_use() - heap_before;
+            print_row("fat", insert_seconds, lookup_seconds, n, lookups, heap);
+            fat_search_mode() = FAT_SEARCH_SCALAR;
+            print_row("fat scalar", insert_seconds, timed_lookups(*fat, trace), n, lookups, heap);
+            fat_search_mode() = simd;
+            std::cout << std::setw(14) << "" << "  nodes: " << fat->node_count() << ", fill: " << std::setprecision(2)
+                      << static_cast<double>(n) / (fat->node_count() * FatSkipList<int, int>::kCapacity) << std::endl;
+            delete fat;
+        } else {
+            std::cout << std::setw(14) << "fat" << "  skipped, needs ~" << n * FAT_BYTES_PER_KEY / (1 << 20) << " MB"
+                      << std::endl;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,82 @@
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <random>
+#include <algorithm>
+#include <cstdlib>
+#include "../LRU_skiplist.h"
+
+// finger search 基准：同一组键按三种顺序依次 insert_element、search_element、delete_element，
+// 比较关闭和开启 set_finger 时的吞吐。
+//   sequential  0, 1, 2, ...（main.cpp 插入 1..100、按时间递增的键都是这种）
+//   clustered   键按 CLUSTER_SIZE 个一组，组的顺序随机，组内顺序随机
+//   random      完全随机
+// 编译时加 -DSKIPLIST_NO_PREFETCH 可以关闭查找时的软件预取做对比。
+// 用法：./bin/finger_bench [key_count]，默认 1000000
+
+#define MAX_LEVEL 22
+#define CLUSTER_SIZE 64
+
+std::vector<int> make_stream(const std::string& name, int key_count, std::mt19937_64& gen) {
+    std::vector<int> keys(key_count);
+    for (int i = 0; i < key_count; i++) {
+        keys[i] = i;
+    }
+    if (name == "random") {
+        std::shuffle(keys.begin(), keys.end(), gen);
+    } else if (name == "clustered") {
+        std::vector<int> clusters((key_count + CLUSTER_SIZE - 1) / CLUSTER_SIZE);
+        for (size_t i = 0; i < clusters.size(); i++) {
+            clusters[i] = static_cast<int>(i);
+        }
+        std::shuffle(clusters.begin(), clusters.end(), gen);
+        keys.clear();
+        for (int cluster : clusters) {
+            size_t begin = keys.size();
+            for (int k = cluster * CLUSTER_SIZE; k < std::min(key_count, (cluster + 1) * CLUSTER_SIZE); k++) {
+                keys.push_back(k);
+            }
+            std::shuffle(keys.begin() + begin, keys.end(), gen);
+        }
+    }
+    return keys;
+}
+
+template<typename Op>
+double ops_per_second(const std::vector<int>& keys, Op op) {
+    auto start = std::chrono::high_resolution_clock::now();
+    for (int key : keys) {
+        op(key);
+    }
+    std::chrono::duration<double> elapsed = std::chrono::high_resolution_clock::now() - start;
+    return keys.size() / elapsed.count();
+}
+
+void run(const char* name, const std::vector<int>& keys, bool finger) {
+    SkipList<int, int> store(MAX_LEVEL, 1024);
+    store.set_finger(finger);
+    std::cout.setstate(std::ios_base::badbit);
+    double inserts = ops_per_second(keys, [&](int key) { store.insert_element(key, key); });
+    double searches = ops_per_second(keys, [&](int key) { store.search_element(key); });
+    double deletes = ops_per_second(keys, [&](int key) { store.delete_element(key); });
+    std::cout.clear();
+    std::cout << std::setw(12) << name << std::setw(8) << (finger ? "on" : "off") << std::fixed << std::setprecision(0)
+              << std::setw(14) << inserts << std::setw(14) << searches << std::setw(14) << deletes << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+    int key_count = argc > 1 ? atoi(argv[1]) : 1000000;
+    std::mt19937_64 gen(5);
+
+    std::cout << "keys: " << key_count << std::endl;
+    std::cout << std::setw(12) << "stream" << std::setw(8) << "finger" << std::setw(14) << "inserts/s"
+              << std::setw(14) << "searches/s" << std::setw(14) << "deletes/s" << std::endl;
+    for (const char* name : {"sequential", "clustered", "random"}) {
+        std::vector<int> keys = make_stream(name, key_count, gen);
+        run(name, keys, false);
+        run(name, keys, true);
+    }
+    return 0;
+}
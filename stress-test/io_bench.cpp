@@ -0,0 +1,228 @@
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include "../snapshot_format.h"
+
+// 快照 I/O 后端基准：同一组记录（键 16 字节，值 value_size 字节）用不同的方式保存和加载，比较吞吐和每 GB 的 CPU 时间。
+//
+//   stream          旧的文本格式，ofstream 写（之后单独 fsync）、ifstream getline 读，即原来 dump_file/load_file 的写法
+//   pwrite          二进制快照，AsyncFileWriter 的 pwrite 后端（与改动前 SnapshotWriter 的缓冲 write 相同）；加载为逐块 pread
+//   io_uring        二进制快照，注册缓冲区 + 批量提交 + 随最后的写一起提交的 fsync；加载为并发读请求
+//   mmap            二进制快照的默认加载方式
+//   +direct         O_DIRECT，绕过页缓存
+//
+// 每次保存前删除旧文件，每次加载前把文件从页缓存中清掉（fdatasync 后 POSIX_FADV_DONTNEED），读到的都是磁盘。
+// 加载只解码出键和值（std::string），不建跳表，差别只在 I/O 路径上。
+// CPU 为进程的 user + sys 时间（io_uring 的内核工作线程属于本进程，也计算在内），除以文件大小换算成 s/GB。
+// 每种方式运行 repeat 次取最快的一次。
+// 用法：./bin/io_bench [records] [value_size] [path] [repeat]，默认 2000000、100、store/io_bench_dump、3
+
+struct Record {
+    std::string key;
+    std::string value;
+    int64_t expire_time;
+};
+
+struct Result {
+    double seconds = 0;
+    double cpu_seconds = 0;
+    uint64_t bytes = 0;
+    uint64_t calls = 0; // 保存时 io_uring_enter 或 pwrite/fsync 的次数
+    bool ok = true;
+};
+
+double cpu_time() {
+    rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_utime.tv_sec + usage.ru_utime.tv_usec / 1e6 + usage.ru_stime.tv_sec + usage.ru_stime.tv_usec / 1e6;
+}
+
+uint64_t file_size(const std::string& path) {
+    struct stat st;
+    return stat(path.c_str(), &st) == 0 ? static_cast<uint64_t>(st.st_size) : 0;
+}
+
+// 让下一次读取从磁盘读
+void drop_cache(const std::string& path) {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd >= 0) {
+        fdatasync(fd);
+        posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+        ::close(fd);
+    }
+}
+
+Result stream_save(const std::vector<Record>& records, const std::string& path) {
+    Result result;
+    std::ofstream out(path);
+    for (const Record& r : records) {
+        out << r.key << ":" << r.value << ":" << r.expire_time << "\n";
+    }
+    out.close();
+    result.ok = !out.fail();
+    int fd = ::open(path.c_str(), O_WRONLY);
+    result.ok = result.ok && fd >= 0 && ::fsync(fd) == 0;
+    if (fd >= 0) {
+        ::close(fd);
+    }
+    return result;
+}
+
+Result stream_load(const std::string& path, size_t expected) {
+    Result result;
+    std::ifstream in(path);
+    std::string line;
+    std::string key;
+    std::string value;
+    size_t count = 0;
+    while (std::getline(in, line)) {
+        size_t first = line.find(':');
+        size_t last = line.rfind(':');
+        key.assign(line, 0, first);
+        value.assign(line, first + 1, last - first - 1);
+        int64_t expire_time = atoll(line.c_str() + last + 1);
+        (void)expire_time;
+        count++;
+    }
+    result.ok = count == expected;
+    return result;
+}
+
+Result snapshot_save(const std::vector<Record>& records, const std::string& path, const IoOptions& options) {
+    Result result;
+    SnapshotWriter writer;
+    writer.set_io_options(options);
+    result.ok = writer.open(path);
+    for (size_t i = 0; result.ok && i < records.size(); i++) {
+        result.ok = writer.add(records[i].key, records[i].value, records[i].expire_time);
+    }
+    result.ok = result.ok && writer.finish();
+    result.calls = writer.file().submit_calls();
+    if (!result.ok) {
+        std::cerr << "save failed: " << writer.error() << std::endl;
+    }
+    return result;
+}
+
+Result snapshot_load(const std::string& path, const IoOptions& options, size_t expected) {
+    Result result;
+    SnapshotReader reader;
+    std::string key;
+    std::string value;
+    int64_t expire_time;
+    size_t count = 0;
+    result.ok = reader.open(path, options);
+    while (result.ok && reader.next(key, value, expire_time)) {
+        count++;
+    }
+    if (!reader.error().empty()) {
+        std::cerr << "load failed: " << reader.error() << std::endl;
+    }
+    result.ok = reader.error().empty() && count == expected;
+    return result;
+}
+
+template<typename Run>
+Result measure(Run run, const std::string& path, bool save, int repeat) {
+    Result best;
+    for (int i = 0; i < repeat; i++) {
+        if (save) {
+            std::remove(path.c_str());
+        } else {
+            drop_cache(path);
+        }
+        double cpu_start = cpu_time();
+        auto start = std::chrono::steady_clock::now();
+        Result result = run();
+        result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        result.cpu_seconds = cpu_time() - cpu_start;
+        result.bytes = file_size(path);
+        if (!result.ok) {
+            return result;
+        }
+        if (i == 0 || result.seconds < best.seconds) {
+            best = result;
+        }
+    }
+    return best;
+}
+
+void print(const char* op, const char* method, const Result& result) {
+    double mb = result.bytes / (1024.0 * 1024.0);
+    double gb = result.bytes / (1024.0 * 1024.0 * 1024.0);
+    std::cout << std::setw(6) << op << std::setw(18) << method;
+    if (!result.ok) {
+        std::cout << "  failed" << std::endl;
+        return;
+    }
+    std::cout << std::fixed << std::setprecision(0) << std::setw(8) << mb << std::setprecision(3) << std::setw(10)
+              << result.seconds << std::setprecision(0) << std::setw(10) << mb / result.seconds << std::setprecision(2)
+              << std::setw(12) << (gb > 0 ? result.cpu_seconds / gb : 0.0) << std::setw(10) << result.calls
+              << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+    size_t count = argc > 1 ? strtoul(argv[1], nullptr, 10) : 2000000;
+    int value_size = argc > 2 ? atoi(argv[2]) : 100;
+    std::string path = argc > 3 ? argv[3] : "store/io_bench_dump";
+    int repeat = argc > 4 ? atoi(argv[4]) : 3;
+
+    std::vector<Record> records(count);
+    char key[32];
+    for (size_t i = 0; i < count; i++) {
+        snprintf(key, sizeof(key), "key:%012zu", i);
+        records[i].key = key;
+        records[i].value.assign(value_size, static_cast<char>('a' + i % 26));
+        records[i].expire_time = i % 4 == 0 ? 1700000000000LL + static_cast<int64_t>(i) : 0;
+    }
+
+    struct Method {
+        const char* name;
+        IoBackend backend;
+        bool direct;
+    };
+    const Method savers[] = {
+        {"pwrite", IO_BACKEND_PWRITE, false},
+        {"io_uring", IO_BACKEND_URING, false},
+        {"pwrite+direct", IO_BACKEND_PWRITE, true},
+        {"io_uring+direct", IO_BACKEND_URING, true},
+    };
+    const Method loaders[] = {
+        {"mmap", IO_BACKEND_AUTO, false},
+        {"pread", IO_BACKEND_PWRITE, false},
+        {"io_uring", IO_BACKEND_URING, false},
+        {"pread+direct", IO_BACKEND_PWRITE, true},
+        {"io_uring+direct", IO_BACKEND_URING, true},
+    };
+
+    std::cout << "records: " << count << ", value size: " << value_size << ", io_uring "
+              << (io_resolve_backend(IO_BACKEND_URING, false) == IO_BACKEND_URING ? "available" : "unavailable, uses pwrite")
+              << std::endl;
+    std::cout << std::setw(6) << "op" << std::setw(18) << "method" << std::setw(8) << "MB" << std::setw(10) << "s"
+              << std::setw(10) << "MB/s" << std::setw(12) << "cpu s/GB" << std::setw(10) << "calls" << std::endl;
+
+    print("save", "stream", measure([&] { return stream_save(records, path); }, path, true, repeat));
+    print("load", "stream", measure([&] { return stream_load(path, count); }, path, false, repeat));
+    for (const Method& m : savers) {
+        IoOptions options;
+        options.backend = m.backend;
+        options.direct = m.direct;
+        print("save", m.name, measure([&] { return snapshot_save(records, path, options); }, path, true, repeat));
+    }
+    for (const Method& m : loaders) {
+        IoOptions options;
+        options.backend = m.backend;
+        options.direct = m.direct;
+        print("load", m.name, measure([&] { return snapshot_load(path, options, count); }, path, false, repeat));
+    }
+    std::remove(path.c_str());
+    return 0;
+}
@@ -0,0 +1,73 @@
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <chrono>
+#include <random>
+#include <algorithm>
+#include <cstdlib>
+#include "../LRU_skiplist.h"
+
+// 层级生成基准：p 取 1/2、1/e、1/4，从 main.cpp 的最大层级 10 开始插入 key_count 个随机键（最大层级随元素数增长），
+// 再逐个查找，输出吞吐、最终的最大层级、每节点的指针数和字节数、每次查找平均走的步数，以及各层级的节点数。
+// 用法：./bin/level_bench [key_count]，默认 1000000
+
+#define INITIAL_MAX_LEVEL 10
+
+template<typename Op>
+double ops_per_second(const std::vector<int>& keys, Op op) {
+    auto start = std::chrono::high_resolution_clock::now();
+    for (int key : keys) {
+        op(key);
+    }
+    std::chrono::duration<double> elapsed = std::chrono::high_resolution_clock::now() - start;
+    return keys.size() / elapsed.count();
+}
+
+void run(const char* name, double p, const std::vector<int>& keys) {
+    SkipList<int, int> store(INITIAL_MAX_LEVEL, 1024);
+    store.set_level_probability(p);
+    std::cout.setstate(std::ios_base::badbit);
+    double inserts = ops_per_second(keys, [&](int key) { store.insert_element(key, key); });
+    SkipListStats before = store.stats();
+    double searches = ops_per_second(keys, [&](int key) { store.search_element(key); });
+    SkipListStats after = store.stats();
+    std::cout.clear();
+
+    // 只算查找阶段的步数
+    uint64_t paths = after.counters[STATS_SEARCH_PATHS] - before.counters[STATS_SEARCH_PATHS];
+    uint64_t hops = after.counters[STATS_SEARCH_HOPS] - before.counters[STATS_SEARCH_HOPS];
+    double pointers = 0;
+    for (size_t level = 0; level < after.level_histogram.size(); level++) {
+        pointers += after.level_histogram[level] * (level + 1.0);
+    }
+    MemoryUsage memory = store.memory_usage();
+    std::cout << std::setw(6) << name << std::fixed << std::setprecision(0) << std::setw(12) << inserts
+              << std::setw(12) << searches << std::setw(8) << after.max_level << std::setprecision(2)
+              << std::setw(10) << pointers / after.element_count
+              << std::setw(12) << static_cast<double>(memory.nodes + memory.towers) / after.element_count
+              << std::setw(10) << static_cast<double>(hops) / paths << std::endl;
+    std::cout << "        levels:";
+    for (long count : after.level_histogram) {
+        std::cout << " " << count;
+    }
+    std::cout << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+    int key_count = argc > 1 ? atoi(argv[1]) : 1000000;
+    std::vector<int> keys(key_count);
+    for (int i = 0; i < key_count; i++) {
+        keys[i] = i;
+    }
+    std::mt19937_64 gen(7);
+    std::shuffle(keys.begin(), keys.end(), gen);
+
+    std::cout << "keys: " << key_count << ", initial max level: " << INITIAL_MAX_LEVEL << std::endl;
+    std::cout << std::setw(6) << "p" << std::setw(12) << "inserts/s" << std::setw(12) << "searches/s"
+              << std::setw(8) << "max_lv" << std::setw(10) << "ptrs/node" << std::setw(12) << "bytes/node"
+              << std::setw(10) << "hops" << std::endl;
+    run("1/2", SKIPLIST_P_HALF, keys);
+    run("1/e", SKIPLIST_P_E, keys);
+    run("1/4", SKIPLIST_P_QUARTER, keys);
+    return 0;
+}
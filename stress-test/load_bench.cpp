@@ -0,0 +1,102 @@
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <random>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+
+// 使用单独的文件，不覆盖 store/dumpFile
+#define STORE_FILE "store/load_bench_dump"
+#include "../skiplist.h"
+
+// 重启加载基准：先写出 key_count 个键的 dump 文件，再分别用旧的加载方式（逐行 insert_element）
+// 和新的 load_file（bulk_load 一遍链接）重建跳表，比较加载耗时，并比较两种结果上的随机查找耗时。
+// 用法：./bin/load_bench [key_count]，默认 1000000
+
+#define MAX_LEVEL 24
+
+double seconds_since(std::chrono::high_resolution_clock::time_point start) {
+    std::chrono::duration<double> elapsed = std::chrono::high_resolution_clock::now() - start;
+    return elapsed.count();
+}
+
+// 改动前 load_file 的做法：每一行都走一次 insert_element（查找、加锁、随机层级、打印）
+void legacy_load(SkipList<int, std::string>& list) {
+    std::ifstream reader(STORE_FILE);
+    std::string line;
+    while (getline(reader, line)) {
+        size_t pos = line.find(delimiter);
+        if (line.empty() || pos == std::string::npos) {
+            continue;
+        }
+        list.insert_element(stoi(line.substr(0, pos)), line.substr(pos + 1));
+    }
+}
+
+double search_time(SkipList<int, std::string>& list, const std::vector<int>& keys) {
+    auto start = std::chrono::high_resolution_clock::now();
+    long found = 0;
+    for (size_t i = 0; i < keys.size(); i++) {
+        found += list.contains(keys[i]);
+    }
+    double elapsed = seconds_since(start);
+    if (found != (long)keys.size()) {
+        std::cout << "unexpected misses: " << keys.size() - found << std::endl;
+    }
+    return elapsed;
+}
+
+int main(int argc, char* argv[]) {
+    int key_count = argc > 1 ? atoi(argv[1]) : 1000000;
+
+    {
+        std::ofstream writer(STORE_FILE);
+        for (int i = 0; i < key_count; i++) {
+            writer << i << ":value" << i << "\n";
+        }
+    }
+    std::vector<int> keys(key_count);
+    for (int i = 0; i < key_count; i++) {
+        keys[i] = i;
+    }
+    std::shuffle(keys.begin(), keys.end(), std::mt19937(42));
+
+    // 逐行插入和 load_file 都会打印日志，测量期间关闭 std::cout
+    SkipList<int, std::string> legacy(MAX_LEVEL);
+    std::cout.setstate(std::ios_base::badbit);
+    auto start = std::chrono::high_resolution_clock::now();
+    legacy_load(legacy);
+    double legacy_time = seconds_since(start);
+    std::cout.clear();
+    double legacy_search = search_time(legacy, keys);
+
+    SkipList<int, std::string> bulk(MAX_LEVEL);
+    std::cout.setstate(std::ios_base::badbit);
+    start = std::chrono::high_resolution_clock::now();
+    bulk.load_file();
+    double bulk_time = seconds_since(start);
+    std::cout.clear();
+    double bulk_search = search_time(bulk, keys);
+
+    std::remove(STORE_FILE);
+
+    std::cout << "keys: " << key_count << std::endl;
+    std::cout << std::setw(22) << "loader"
+              << std::setw(12) << "load s"
+              << std::setw(14) << "keys/sec"
+              << std::setw(16) << "search ns/key" << std::endl;
+    std::cout << std::fixed
+              << std::setw(22) << "insert_element/line"
+              << std::setw(12) << std::setprecision(3) << legacy_time
+              << std::setw(14) << std::setprecision(0) << key_count / legacy_time
+              << std::setw(16) << std::setprecision(1) << legacy_search * 1e9 / key_count << "\n"
+              << std::setw(22) << "load_file (bulk)"
+              << std::setw(12) << std::setprecision(3) << bulk_time
+              << std::setw(14) << std::setprecision(0) << key_count / bulk_time
+              << std::setw(16) << std::setprecision(1) << bulk_search * 1e9 / key_count << std::endl;
+    return 0;
+}
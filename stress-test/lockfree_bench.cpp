@@ -0,0 +1,101 @@
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include <random>
+#include "../skiplist.h"
+#include "../lockfree_skiplist.h"
+
+// 对比互斥锁版本（skiplist.h）与无锁版本（lockfree_skiplist.h）在 1~32 线程下的吞吐量
+// 负载：50% 查找，25% 插入，25% 删除，键均匀分布在 [0, KEY_RANGE)
+
+#define KEY_RANGE 100000
+#define OPS_PER_RUN 400000
+#define MAX_LEVEL 18
+
+template<typename List>
+void prefill(List& list) {
+    for (int i = 0; i < KEY_RANGE; i += 2) {
+        list.insert_element(i, "a");
+    }
+}
+
+void mutex_worker(SkipList<int, std::string>* list, int ops, unsigned seed) {
+    std::mt19937 gen(seed);
+    std::uniform_int_distribution<int> key_dist(0, KEY_RANGE - 1);
+    std::uniform_int_distribution<int> op_dist(0, 3);
+    for (int i = 0; i < ops; i++) {
+        int key = key_dist(gen);
+        int op = op_dist(gen);
+        if (op == 0) {
+            list->insert_element(key, "a");
+        } else if (op == 1) {
+            list->delete_element(key);
+        } else {
+            list->search_element(key);
+        }
+    }
+}
+
+void lockfree_worker(LockFreeSkipList<int, std::string>* list, int ops, unsigned seed) {
+    std::mt19937 gen(seed);
+    std::uniform_int_distribution<int> key_dist(0, KEY_RANGE - 1);
+    std::uniform_int_distribution<int> op_dist(0, 3);
+    for (int i = 0; i < ops; i++) {
+        int key = key_dist(gen);
+        int op = op_dist(gen);
+        if (op == 0) {
+            list->insert_element(key, "a");
+        } else if (op == 1) {
+            list->delete_element(key);
+        } else {
+            list->search_element(key);
+        }
+    }
+}
+
+template<typename List, typename Worker>
+double run(List& list, int num_threads, Worker worker) {
+    std::vector<std::thread> threads;
+    int ops = OPS_PER_RUN / num_threads;
+    auto start = std::chrono::high_resolution_clock::now();
+    for (int i = 0; i < num_threads; i++) {
+        threads.push_back(std::thread(worker, &list, ops, (unsigned)(i + 1)));
+    }
+    for (size_t i = 0; i < threads.size(); i++) {
+        threads[i].join();
+    }
+    auto finish = std::chrono::high_resolution_clock::now();
+    std::chrono::duration<double> elapsed = finish - start;
+    return (double)ops * num_threads / elapsed.count();
+}
+
+int main() {
+    int thread_counts[] = {1, 2, 4, 8, 16, 32};
+
+    std::cout << std::setw(8) << "threads"
+              << std::setw(18) << "mutex ops/sec"
+              << std::setw(18) << "lockfree ops/sec" << std::endl;
+
+    for (int n : thread_counts) {
+        double mutex_ops, lockfree_ops;
+        {
+            // skiplist.h 每次写操作都会打印日志，测量期间关闭 std::cout
+            SkipList<int, std::string> list(MAX_LEVEL);
+            std::cout.setstate(std::ios_base::badbit);
+            prefill(list);
+            mutex_ops = run(list, n, mutex_worker);
+            std::cout.clear();
+        }
+        {
+            LockFreeSkipList<int, std::string> list(MAX_LEVEL);
+            prefill(list);
+            lockfree_ops = run(list, n, lockfree_worker);
+        }
+        std::cout << std::setw(8) << n
+                  << std::setw(18) << std::fixed << std::setprecision(0) << mutex_ops
+                  << std::setw(18) << lockfree_ops << std::endl;
+    }
+    return 0;
+}
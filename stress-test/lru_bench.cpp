@@ -0,0 +1,94 @@
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <random>
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include <malloc.h>
+#include "../LRU_skiplist.h"
+
+// LRU缓存内存基准：插入 key_count 个键（值为 value_size 字节），LRU 容量分别为 1（几乎不缓存）和 key_count（全部缓存），
+// 比较每个键占用的堆内存（mallinfo2 统计的已分配字节，包括节点内存池）和存活的堆分配数，两者之差即缓存每个键的开销。
+// 之后随机 search_element，给出平均耗时和 LRU 命中率。
+// 用法：./bin/lru_bench [key_count] [value_size]，默认 1000000 64
+
+#define MAX_LEVEL 22
+
+static std::atomic<long> g_live_allocs(0); // 还没释放的 operator new 分配数
+
+void* operator new(size_t size) {
+    g_live_allocs.fetch_add(1, std::memory_order_relaxed);
+    void* p = std::malloc(size);
+    if (p == nullptr) {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+void operator delete(void* p) noexcept {
+    if (p != nullptr) {
+        g_live_allocs.fetch_sub(1, std::memory_order_relaxed);
+    }
+    std::free(p);
+}
+
+void operator delete(void* p, size_t) noexcept {
+    operator delete(p);
+}
+
+size_t heap_bytes() {
+    struct mallinfo2 info = mallinfo2();
+    return info.uordblks + info.hblkhd;
+}
+
+void run(int key_count, int value_size, size_t lru_capacity) {
+    std::mt19937 gen(1);
+    std::vector<int> keys(key_count);
+    for (int i = 0; i < key_count; i++) {
+        keys[i] = i;
+    }
+    std::shuffle(keys.begin(), keys.end(), gen);
+    std::string value(value_size, 'v');
+
+    size_t bytes_before = heap_bytes();
+    long allocs_before = g_live_allocs.load();
+    SkipList<int, std::string>* store = new SkipList<int, std::string>(MAX_LEVEL, lru_capacity);
+    std::cout.setstate(std::ios_base::badbit);
+    for (int k : keys) {
+        store->insert_element(k, value);
+    }
+    std::cout.clear();
+    double bytes = static_cast<double>(heap_bytes() - bytes_before) / key_count;
+    double allocs = static_cast<double>(g_live_allocs.load() - allocs_before) / key_count;
+
+    int searches = key_count;
+    std::cout.setstate(std::ios_base::badbit);
+    auto start = std::chrono::high_resolution_clock::now();
+    for (int i = 0; i < searches; i++) {
+        store->search_element(keys[gen() % key_count]);
+    }
+    std::chrono::duration<double, std::nano> elapsed = std::chrono::high_resolution_clock::now() - start;
+    std::cout.clear();
+    SkipListStats stats = store->stats();
+    double hit_rate = 100.0 * stats.lru_hit_ratio();
+
+    std::cout << std::setw(14) << lru_capacity << std::fixed << std::setprecision(1)
+              << std::setw(16) << bytes << std::setw(14) << allocs
+              << std::setw(14) << elapsed.count() / searches << std::setw(12) << hit_rate << std::endl;
+    delete store;
+}
+
+int main(int argc, char* argv[]) {
+    int key_count = argc > 1 ? atoi(argv[1]) : 1000000;
+    int value_size = argc > 2 ? atoi(argv[2]) : 64;
+
+    std::cout << "keys: " << key_count << ", value size: " << value_size << std::endl;
+    std::cout << std::setw(14) << "lru capacity" << std::setw(16) << "heap bytes/key" << std::setw(14) << "allocs/key"
+              << std::setw(14) << "search ns" << std::setw(12) << "hit %" << std::endl;
+    run(key_count, value_size, 1);
+    run(key_count, value_size, key_count);
+    return 0;
+}
@@ -0,0 +1,107 @@
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <random>
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <malloc.h>
+#include "../LRU_skiplist.h"
+
+// 内存基准：插入 key_count 个键，值的长度在 [MIN_VALUE, MAX_VALUE] 上按对数均匀分布（短值多、长值少），
+// 之后按 zipf 分布 search_element。缓存容量分别按节点数和按字节计，两者的平均节点数相同。
+// 每种容量给出 memory_usage() 的分项、与 mallinfo2 统计的堆增量的对比，以及缓存实际占用的字节数与预算的对比：
+// 按节点数限制时缓存占用的字节数随值的长度波动，按字节限制时不超过预算。
+// 用法：./bin/memory_bench [key_count] [cache_mb] [ops]，默认 50000 16 1000000
+
+#define MAX_LEVEL 18
+#define MIN_VALUE 10
+#define MAX_VALUE 16384
+#define ZIPF_THETA 0.99
+
+size_t heap_in_use() {
+    struct mallinfo2 info = mallinfo2();
+    return info.uordblks + info.hblkhd;
+}
+
+double mb(size_t bytes) {
+    return bytes / (1024.0 * 1024.0);
+}
+
+void run(const char* name, CacheCapacity capacity, const std::vector<std::string>& values,
+         const std::vector<int>& trace) {
+    size_t heap_before = heap_in_use();
+    SkipList<int, std::string>* store = new SkipList<int, std::string>(MAX_LEVEL, capacity);
+    std::cout.setstate(std::ios_base::badbit);
+    for (size_t i = 0; i < values.size(); i++) {
+        store->insert_element(static_cast<int>(i), values[i]);
+    }
+    auto start = std::chrono::high_resolution_clock::now();
+    for (int key : trace) {
+        store->search_element(key);
+    }
+    std::chrono::duration<double> elapsed = std::chrono::high_resolution_clock::now() - start;
+    std::cout.clear();
+    size_t heap = heap_in_use() - heap_before;
+
+    MemoryUsage usage = store->memory_usage();
+    SkipListStats stats = store->stats();
+    std::cout << name << std::fixed << std::setprecision(2) << std::endl;
+    std::cout << "  nodes " << mb(usage.nodes) << " MB, towers " << mb(usage.towers) << " MB, keys "
+              << mb(usage.keys) << " MB, values " << mb(usage.values) << " MB, cache overhead "
+              << mb(usage.cache_overhead) << " MB, arena reserved " << mb(usage.arena_reserved) << " MB" << std::endl;
+    std::cout << "  total " << mb(usage.total()) << " MB, mallinfo2 heap " << mb(heap) << " MB" << std::endl;
+    std::cout << "  cache bytes " << mb(usage.cache) << " MB";
+    if (capacity.in_bytes) {
+        std::cout << " of " << mb(capacity.amount) << " MB budget";
+    }
+    std::cout << ", hit " << stats.lru_hit_ratio() * 100 << " %, "
+              << std::setprecision(0) << trace.size() / elapsed.count() << " ops/s" << std::endl;
+    delete store;
+}
+
+int main(int argc, char* argv[]) {
+    int key_count = argc > 1 ? atoi(argv[1]) : 50000;
+    size_t budget = (argc > 2 ? atoi(argv[2]) : 16) * 1024UL * 1024UL;
+    int ops = argc > 3 ? atoi(argv[3]) : 1000000;
+
+    std::mt19937_64 gen(7);
+    std::vector<std::string> values(key_count);
+    double log_min = std::log(MIN_VALUE);
+    double log_max = std::log(MAX_VALUE);
+    size_t value_bytes = 0;
+    for (int i = 0; i < key_count; i++) {
+        double u = std::uniform_real_distribution<double>(log_min, log_max)(gen);
+        values[i].assign(static_cast<size_t>(std::exp(u)), 'v');
+        value_bytes += values[i].size();
+    }
+
+    // zipf 排名打乱后映射到键，热键的长度与冷键相同分布
+    std::vector<double> cdf(key_count);
+    double sum = 0;
+    for (int i = 0; i < key_count; i++) {
+        sum += 1.0 / std::pow(i + 1, ZIPF_THETA);
+        cdf[i] = sum;
+    }
+    std::vector<int> rank_to_key(key_count);
+    for (int i = 0; i < key_count; i++) {
+        cdf[i] /= sum;
+        rank_to_key[i] = i;
+    }
+    std::shuffle(rank_to_key.begin(), rank_to_key.end(), gen);
+    std::vector<int> trace(ops);
+    for (int i = 0; i < ops; i++) {
+        double u = std::uniform_real_distribution<double>(0, 1)(gen);
+        trace[i] = rank_to_key[std::lower_bound(cdf.begin(), cdf.end(), u) - cdf.begin()];
+    }
+
+    size_t average = value_bytes / key_count;
+    size_t items = budget / (average + sizeof(Node<int, std::string>));
+    std::cout << "keys: " << key_count << ", value bytes: " << std::fixed << std::setprecision(2) << mb(value_bytes)
+              << " MB (avg " << average << " B), ops: " << ops << std::endl;
+    run("items", CacheCapacity(items), values, trace);
+    run("bytes", CacheCapacity::bytes(budget), values, trace);
+    return 0;
+}
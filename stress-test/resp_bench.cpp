@@ -0,0 +1,377 @@
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <thread>
+#include <chrono>
+#include <random>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include "../skiplist_stats.h"
+
+// server.cpp 的压测客户端，做法与 redis-benchmark 相同（本机没有 redis-benchmark 时用它，参数含义一致）：
+// --clients 个连接各自一次发出 --pipeline 条命令，收齐这一批回复后再发下一批，直到一共完成 --requests 条。
+// 每条命令的延迟从这一批发出到收到它的回复，所以 pipeline 越深吞吐越高、单条延迟越大。
+// 连接平均分给 --threads 个线程，每个线程一个 epoll。
+//
+// 键为 "key:" + 12 位编号，编号在 [0, --keyspace) 内均匀随机；值为 --data-size 字节。
+// --pipeline 可以给多个深度（逗号分隔），对每个深度依次跑 --tests 里的每种命令，每个组合输出一行：
+//   test,pipeline,clients,requests,seconds,ops_per_sec,p50_us,p99_us,p999_us,max_us,errors
+//
+// 用法：./bin/server &
+//       ./bin/resp_bench [--host=127.0.0.1] [--port=6379] [--clients=50] [--requests=100000] [--pipeline=1,16]
+//       [--data-size=3] [--keyspace=100000] [--tests=set,get] [--threads=1] [--no-header]
+
+#define BENCH_KEY_DIGITS 12
+
+struct Options {
+    std::string host = "127.0.0.1";
+    int port = 6379;
+    int clients = 50;
+    long requests = 100000;
+    std::vector<int> pipelines = {1, 16};
+    int data_size = 3;
+    long keyspace = 100000;
+    std::vector<std::string> tests = {"set", "get"};
+    int threads = 1;
+    bool header = true;
+};
+
+struct Client {
+    int fd = -1;
+    std::string out; // 这一批命令，从 out_pos 开始还没发出
+    size_t out_pos = 0;
+    std::string in; // 收到还没解析完的回复
+    int outstanding = 0; // 这一批还没收到回复的命令数
+    bool watching_output = false; // 是否在等 EPOLLOUT
+    std::chrono::steady_clock::time_point sent;
+};
+
+struct ThreadResult {
+    LatencySummary latency;
+    uint64_t errors = 0;
+    bool failed = false;
+};
+
+static void record_latency(LatencySummary& summary, uint64_t ns) {
+    summary.buckets[LatencyBuckets::index(ns)]++;
+    summary.count++;
+    summary.sum_ns += ns;
+    if (ns > summary.max_ns) {
+        summary.max_ns = ns;
+    }
+}
+
+static std::vector<std::string> split(const std::string& text) {
+    std::vector<std::string> parts;
+    std::stringstream stream(text);
+    std::string part;
+    while (std::getline(stream, part, ',')) {
+        if (!part.empty()) {
+            parts.push_back(part);
+        }
+    }
+    return parts;
+}
+
+static void append_bulk(std::string& out, const char* data, size_t size) {
+    out += '$';
+    out += std::to_string(size);
+    out.append("\r\n", 2);
+    out.append(data, size);
+    out.append("\r\n", 2);
+}
+
+// data[0, len) 开头一条完整回复的字节数，不完整时返回 0；error 表示是错误回复
+static size_t reply_length(const char* data, size_t len, bool& error) {
+    const char* newline = static_cast<const char*>(memchr(data, '\n', len));
+    if (newline == nullptr) {
+        return 0;
+    }
+    size_t line = newline + 1 - data;
+    error = data[0] == '-';
+    if (data[0] != '$') {
+        return line;
+    }
+    long size = atol(data + 1);
+    if (size < 0) {
+        return line; // $-1 不存在的键
+    }
+    return len >= line + size + 2 ? line + size + 2 : 0;
+}
+
+class Worker {
+public:
+    Worker(const Options& options, const std::string& test, int pipeline, int clients, long requests, unsigned seed)
+        : _options(options), _test(test), _pipeline(pipeline), _clients(clients), _remaining(requests), _rng(seed),
+          _value(options.data_size, 'x') {}
+
+    void run(ThreadResult& result) {
+        _epoll_fd = epoll_create1(0);
+        std::vector<Client> clients(_clients);
+        for (Client& c : clients) {
+            if (!connect_client(c)) {
+                result.failed = true;
+                break;
+            }
+        }
+        long finished_target = _remaining;
+        long finished = 0;
+        for (Client& c : clients) {
+            if (!result.failed && !next_batch(c)) {
+                result.failed = true;
+            }
+        }
+
+        std::vector<epoll_event> events(_clients > 0 ? _clients : 1);
+        while (!result.failed && finished < finished_target) {
+            int n = epoll_wait(_epoll_fd, events.data(), static_cast<int>(events.size()), 1000);
+            if (n < 0 && errno != EINTR) {
+                result.failed = true;
+                break;
+            }
+            for (int i = 0; i < n; i++) {
+                Client& c = *static_cast<Client*>(events[i].data.ptr);
+                if ((events[i].events & EPOLLOUT) && !send_pending(c)) {
+                    result.failed = true;
+                }
+                if ((events[i].events & (EPOLLIN | EPOLLERR | EPOLLHUP)) && !receive(c, result, finished)) {
+                    result.failed = true;
+                }
+            }
+        }
+        for (Client& c : clients) {
+            if (c.fd >= 0) {
+                close(c.fd);
+            }
+        }
+        close(_epoll_fd);
+    }
+
+private:
+    bool connect_client(Client& c) {
+        c.fd = socket(AF_INET, SOCK_STREAM, 0);
+        sockaddr_in addr;
+        memset(&addr, 0, sizeof(addr));
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(static_cast<uint16_t>(_options.port));
+        inet_pton(AF_INET, _options.host.c_str(), &addr.sin_addr);
+        if (c.fd < 0 || connect(c.fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+            std::cerr << "connect " << _options.host << ":" << _options.port << ": " << strerror(errno) << std::endl;
+            return false;
+        }
+        int one = 1; // 连接保持阻塞模式，收发都带 MSG_DONTWAIT
+        setsockopt(c.fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+        epoll_event event;
+        event.events = EPOLLIN;
+        event.data.ptr = &c;
+        return epoll_ctl(_epoll_fd, EPOLL_CTL_ADD, c.fd, &event) == 0;
+    }
+
+    bool next_batch(Client& c) {
+        if (_remaining <= 0) {
+            return true;
+        }
+        int count = _remaining < _pipeline ? static_cast<int>(_remaining) : _pipeline;
+        _remaining -= count;
+        c.out.clear();
+        c.out_pos = 0;
+        bool set = _test == "set";
+        char key[4 + BENCH_KEY_DIGITS + 1];
+        for (int i = 0; i < count; i++) {
+            long number = static_cast<long>(_rng() % static_cast<uint64_t>(_options.keyspace));
+            snprintf(key, sizeof(key), "key:%0*ld", BENCH_KEY_DIGITS, number);
+            c.out += set ? "*3\r\n$3\r\nSET\r\n" : "*2\r\n$3\r\nGET\r\n";
+            append_bulk(c.out, key, sizeof(key) - 1);
+            if (set) {
+                append_bulk(c.out, _value.data(), _value.size());
+            }
+        }
+        c.outstanding = count;
+        c.sent = std::chrono::steady_clock::now();
+        return send_pending(c);
+    }
+
+    bool send_pending(Client& c) {
+        while (c.out_pos < c.out.size()) {
+            ssize_t n = send(c.fd, c.out.data() + c.out_pos, c.out.size() - c.out_pos, MSG_NOSIGNAL | MSG_DONTWAIT);
+            if (n > 0) {
+                c.out_pos += n;
+                continue;
+            }
+            if (n < 0 && errno == EINTR) {
+                continue;
+            }
+            if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+                return watch(c, true); // 发不完时等可写
+            }
+            std::cerr << "send: " << strerror(errno) << std::endl;
+            return false;
+        }
+        return watch(c, false);
+    }
+
+    bool watch(Client& c, bool output) {
+        if (c.watching_output == output) {
+            return true;
+        }
+        c.watching_output = output;
+        epoll_event event;
+        event.events = output ? EPOLLIN | EPOLLOUT : EPOLLIN;
+        event.data.ptr = &c;
+        return epoll_ctl(_epoll_fd, EPOLL_CTL_MOD, c.fd, &event) == 0;
+    }
+
+    bool receive(Client& c, ThreadResult& result, long& finished) {
+        char buffer[64 << 10];
+        ssize_t n = recv(c.fd, buffer, sizeof(buffer), MSG_DONTWAIT);
+        if (n == 0) {
+            std::cerr << "server closed the connection" << std::endl;
+            return false;
+        }
+        if (n < 0) {
+            return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+        }
+        c.in.append(buffer, n);
+        size_t pos = 0;
+        auto now = std::chrono::steady_clock::now();
+        uint64_t ns = std::chrono::duration_cast<std::chrono::nanoseconds>(now - c.sent).count();
+        while (c.outstanding > 0 && pos < c.in.size()) {
+            bool error = false;
+            size_t length = reply_length(c.in.data() + pos, c.in.size() - pos, error);
+            if (length == 0) {
+                break;
+            }
+            pos += length;
+            result.errors += error;
+            record_latency(result.latency, ns);
+            c.outstanding--;
+            finished++;
+        }
+        c.in.erase(0, pos);
+        return c.outstanding > 0 || next_batch(c);
+    }
+
+    const Options& _options;
+    std::string _test;
+    int _pipeline;
+    int _clients;
+    long _remaining; // 还没发出的命令数
+    std::mt19937_64 _rng;
+    std::string _value;
+    int _epoll_fd = -1;
+};
+
+static bool parse_options(int argc, char* argv[], Options& options) {
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        size_t eq = arg.find('=');
+        std::string name = arg.substr(0, eq);
+        std::string value = eq == std::string::npos ? "" : arg.substr(eq + 1);
+        if (name == "--host") {
+            options.host = value;
+        } else if (name == "--port") {
+            options.port = atoi(value.c_str());
+        } else if (name == "--clients") {
+            options.clients = atoi(value.c_str());
+        } else if (name == "--requests") {
+            options.requests = atol(value.c_str());
+        } else if (name == "--pipeline") {
+            options.pipelines.clear();
+            for (const std::string& depth : split(value)) {
+                options.pipelines.push_back(atoi(depth.c_str()));
+            }
+        } else if (name == "--data-size") {
+            options.data_size = atoi(value.c_str());
+        } else if (name == "--keyspace") {
+            options.keyspace = atol(value.c_str());
+        } else if (name == "--tests") {
+            options.tests = split(value);
+        } else if (name == "--threads") {
+            options.threads = atoi(value.c_str());
+        } else if (name == "--no-header") {
+            options.header = false;
+        } else {
+            std::cerr << "unknown option " << arg << std::endl;
+            return false;
+        }
+    }
+    if (options.clients < 1 || options.threads < 1 || options.threads > options.clients || options.requests < 1 ||
+        options.keyspace < 1 || options.data_size < 0 || options.pipelines.empty()) {
+        std::cerr << "invalid options" << std::endl;
+        return false;
+    }
+    for (int depth : options.pipelines) {
+        if (depth < 1) {
+            std::cerr << "invalid pipeline depth" << std::endl;
+            return false;
+        }
+    }
+    for (const std::string& test : options.tests) {
+        if (test != "set" && test != "get") {
+            std::cerr << "unknown test " << test << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+int main(int argc, char* argv[]) {
+    Options options;
+    if (!parse_options(argc, argv, options)) {
+        return 1;
+    }
+    rlimit limit;
+    if (getrlimit(RLIMIT_NOFILE, &limit) == 0 && limit.rlim_cur < limit.rlim_max) {
+        limit.rlim_cur = limit.rlim_max;
+        setrlimit(RLIMIT_NOFILE, &limit);
+    }
+
+    if (options.header) {
+        std::cout << "test,pipeline,clients,requests,seconds,ops_per_sec,p50_us,p99_us,p999_us,max_us,errors" << std::endl;
+    }
+    for (int pipeline : options.pipelines) {
+        for (const std::string& test : options.tests) {
+            std::vector<ThreadResult> results(options.threads);
+            std::vector<std::thread> threads;
+            auto start = std::chrono::steady_clock::now();
+            for (int t = 0; t < options.threads; t++) {
+                int clients = options.clients / options.threads + (t < options.clients % options.threads ? 1 : 0);
+                long requests = options.requests / options.threads + (t < options.requests % options.threads ? 1 : 0);
+                threads.emplace_back([&, t, clients, requests] {
+                    Worker worker(options, test, pipeline, clients, requests, 12345u + t);
+                    worker.run(results[t]);
+                });
+            }
+            for (std::thread& thread : threads) {
+                thread.join();
+            }
+            double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+            LatencySummary latency;
+            uint64_t errors = 0;
+            for (const ThreadResult& result : results) {
+                if (result.failed) {
+                    return 1;
+                }
+                latency.merge(result.latency);
+                errors += result.errors;
+            }
+            std::cout << std::fixed << std::setprecision(3) << test << "," << pipeline << "," << options.clients << ","
+                      << latency.count << "," << seconds << "," << std::setprecision(0) << latency.count / seconds
+                      << std::setprecision(1) << "," << latency.percentile(0.5) / 1000.0 << ","
+                      << latency.percentile(0.99) / 1000.0 << "," << latency.percentile(0.999) / 1000.0 << ","
+                      << latency.max_ns / 1000.0 << "," << errors << std::endl;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,120 @@
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include <thread>
+#include <atomic>
+#include <cstdlib>
+#include <sstream>
+#include "../skiplist.h"
+
+// 范围扫描基准：分别用 scan() 回调和迭代器遍历 1K / 100K / 10M 个键的范围（超过键总数时截断），
+// 报告每秒访问的键数；再在另一个线程持续随机写入的情况下重复一遍，观察扫描与写入互相让锁的效果。
+// 用法：./bin/scan_bench [key_count]，默认 1000000
+
+#define MAX_LEVEL 24
+
+double seconds_since(std::chrono::high_resolution_clock::time_point start) {
+    std::chrono::duration<double> elapsed = std::chrono::high_resolution_clock::now() - start;
+    return elapsed.count();
+}
+
+// 写线程：在已有键的范围内随机覆盖写，直到 stop 被置位
+void writer(SkipList<int, int>* list, int key_count, std::atomic<bool>* stop, std::atomic<long>* writes) {
+    std::mt19937 gen(7);
+    long n = 0;
+    while (!stop->load(std::memory_order_relaxed)) {
+        int key = gen() % key_count;
+        list->insert_element(key, key);
+        n++;
+    }
+    writes->store(n);
+}
+
+// 对每种范围大小跑 scan 和迭代器，结果写入 out（写线程运行时 std::cout 处于关闭状态）
+void run_ranges(SkipList<int, int>* list, int key_count, const char* label, std::ostream& out) {
+    long ranges[] = {1000, 100000, 10000000};
+    std::mt19937 gen(42);
+    for (long range : ranges) {
+        long len = std::min<long>(range, key_count);
+        // 每种范围大小至少遍历约 key_count 个键，保证计时足够长
+        int rounds = std::max<long>(1, key_count / len);
+        long visited = 0;
+
+        auto start = std::chrono::high_resolution_clock::now();
+        for (int r = 0; r < rounds; r++) {
+            int begin = gen() % (key_count - len + 1);
+            long sum = 0;
+            visited += list->scan(begin, begin + len, 0, [&sum](const int& k, const int& v) {
+                sum += k + v;
+            });
+        }
+        double scan_time = seconds_since(start);
+        long scan_visited = visited;
+
+        visited = 0;
+        start = std::chrono::high_resolution_clock::now();
+        for (int r = 0; r < rounds; r++) {
+            int begin = gen() % (key_count - len + 1);
+            long sum = 0;
+            for (SkipList<int, int>::Iterator it = list->lower_bound(begin);
+                 it.valid() && it.key() < begin + len; it.next()) {
+                sum += it.key() + it.value();
+                visited++;
+            }
+        }
+        double iter_time = seconds_since(start);
+
+        out << std::setw(10) << label
+            << std::setw(12) << len
+            << std::setw(8) << rounds
+            << std::setw(18) << std::fixed << std::setprecision(0) << scan_visited / scan_time
+            << std::setw(18) << visited / iter_time << std::endl;
+    }
+}
+
+int main(int argc, char* argv[]) {
+    int key_count = argc > 1 ? atoi(argv[1]) : 1000000;
+
+    SkipList<int, int> list(MAX_LEVEL);
+    std::vector<int> keys(key_count);
+    for (int i = 0; i < key_count; i++) {
+        keys[i] = i;
+    }
+    std::shuffle(keys.begin(), keys.end(), std::mt19937(1));
+
+    // 跳表每次操作都会打印日志，测量期间关闭 std::cout
+    std::cout.setstate(std::ios_base::badbit);
+    for (int i = 0; i < key_count; i++) {
+        list.insert_element(keys[i], keys[i]);
+    }
+    std::cout.clear();
+
+    std::cout << "keys: " << key_count << std::endl;
+    std::cout << std::setw(10) << "writer"
+              << std::setw(12) << "range"
+              << std::setw(8) << "rounds"
+              << std::setw(18) << "scan keys/sec"
+              << std::setw(18) << "iter keys/sec" << std::endl;
+
+    run_ranges(&list, key_count, "idle", std::cout);
+
+    std::atomic<bool> stop(false);
+    std::atomic<long> writes(0);
+    std::ostringstream rows;
+    std::cout.setstate(std::ios_base::badbit);
+    std::thread t(writer, &list, key_count, &stop, &writes);
+    auto start = std::chrono::high_resolution_clock::now();
+    run_ranges(&list, key_count, "writing", rows);
+    double elapsed = seconds_since(start);
+    stop.store(true);
+    t.join();
+    std::cout.clear();
+
+    std::cout << rows.str();
+    std::cout << "concurrent writes: " << std::fixed << std::setprecision(0)
+              << writes.load() / elapsed << " ops/sec" << std::endl;
+    return 0;
+}
@@ -0,0 +1,70 @@
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include <random>
+#include "../sharded_skiplist.h"
+
+// 分片跳表压力测试：固定线程数，分别用 1~32 个分片跑相同的插入+查找负载，报告吞吐量随分片数的变化
+
+#define NUM_THREADS 8
+#define TEST_COUNT 100000
+#define MAX_LEVEL 18
+#define LRU_CAPACITY 10000
+
+typedef ShardedSkipList<int, std::string> Store;
+
+void insert_worker(Store* store, int ops, unsigned seed) {
+    std::mt19937 gen(seed);
+    for (int i = 0; i < ops; i++) {
+        store->insert_element(gen() % TEST_COUNT, "a");
+    }
+}
+
+void search_worker(Store* store, int ops, unsigned seed) {
+    std::mt19937 gen(seed);
+    for (int i = 0; i < ops; i++) {
+        store->search_element(gen() % TEST_COUNT);
+    }
+}
+
+template<typename Worker>
+double run(Store& store, Worker worker) {
+    std::vector<std::thread> threads;
+    int ops = TEST_COUNT / NUM_THREADS;
+    auto start = std::chrono::high_resolution_clock::now();
+    for (int i = 0; i < NUM_THREADS; i++) {
+        threads.push_back(std::thread(worker, &store, ops, (unsigned)(i + 1)));
+    }
+    for (size_t i = 0; i < threads.size(); i++) {
+        threads[i].join();
+    }
+    auto finish = std::chrono::high_resolution_clock::now();
+    std::chrono::duration<double> elapsed = finish - start;
+    return (double)ops * NUM_THREADS / elapsed.count();
+}
+
+int main() {
+    int shard_counts[] = {1, 2, 4, 8, 16, 32};
+
+    std::cout << "threads: " << NUM_THREADS << std::endl;
+    std::cout << std::setw(8) << "shards"
+              << std::setw(18) << "insert ops/sec"
+              << std::setw(18) << "search ops/sec" << std::endl;
+
+    for (int n : shard_counts) {
+        Store store(n, MAX_LEVEL, LRU_CAPACITY);
+
+        // 跳表每次操作都会打印日志，测量期间关闭 std::cout
+        std::cout.setstate(std::ios_base::badbit);
+        double insert_ops = run(store, insert_worker);
+        double search_ops = run(store, search_worker);
+        std::cout.clear();
+
+        std::cout << std::setw(8) << n
+                  << std::setw(18) << std::fixed << std::setprecision(0) << insert_ops
+                  << std::setw(18) << search_ops << std::endl;
+    }
+    return 0;
+}
@@ -0,0 +1,141 @@
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <string>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <sys/stat.h>
+
+// 使用单独的文件，不覆盖 store/dumpFile
+#define STORE_FILE "store/snapshot_bench_dump"
+#include "../skiplist.h"
+
+// 快照格式基准：构造约 total_mb 大小的数据（键为 int，值为 value_size 字节的字符串），
+// 分别用旧的 key:value 文本格式（ofstream 写，getline/substr/stoi 解析）和新的二进制快照
+// （dump_file 块写入 + load_file mmap 读取）保存和加载，比较耗时和吞吐。
+// 两种格式加载时都经过 bulk_load，差别只在文件格式和读写方式上。
+// 二进制保存包含 fsync，文本保存不含。文件刚写完就读，读取基本命中页缓存，测到的是解析和构建的开销。
+// 用法：./bin/snapshot_bench [total_mb] [value_size]，默认 1024 和 1000
+
+#define MAX_LEVEL 24
+#define TEXT_FILE STORE_FILE ".txt"
+
+typedef SkipList<int, std::string> Store;
+
+double seconds_since(std::chrono::high_resolution_clock::time_point start) {
+    std::chrono::duration<double> elapsed = std::chrono::high_resolution_clock::now() - start;
+    return elapsed.count();
+}
+
+double file_mb(const char* path) {
+    struct stat st;
+    if (stat(path, &st) != 0) {
+        return 0;
+    }
+    return st.st_size / (1024.0 * 1024.0);
+}
+
+// 改动前 dump_file 的写法（去掉了逐条打印）
+void text_save(Store& store) {
+    std::ofstream writer(TEXT_FILE);
+    Store::Iterator it = store.new_iterator();
+    for (it.seek_to_first(); it.valid(); it.next()) {
+        writer << it.key() << ":" << it.value() << "\n";
+    }
+    writer.flush();
+}
+
+// 改动前 load_file 的解析方式
+size_t text_load(Store& store) {
+    std::ifstream reader(TEXT_FILE);
+    std::string line;
+    return store.bulk_load([&](int& k, std::string& v) {
+        while (getline(reader, line)) {
+            size_t pos = line.find(delimiter);
+            if (line.empty() || pos == std::string::npos) {
+                continue;
+            }
+            k = stoi(line.substr(0, pos));
+            v = line.substr(pos + 1);
+            return true;
+        }
+        return false;
+    });
+}
+
+void report(const char* label, double save_time, double load_time, double mb) {
+    std::cout << std::setw(8) << label << std::fixed
+              << std::setw(10) << std::setprecision(0) << mb
+              << std::setw(10) << std::setprecision(2) << save_time
+              << std::setw(12) << std::setprecision(0) << mb / save_time
+              << std::setw(10) << std::setprecision(2) << load_time
+              << std::setw(12) << std::setprecision(0) << mb / load_time << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+    long total_mb = argc > 1 ? atol(argv[1]) : 1024;
+    int value_size = argc > 2 ? atoi(argv[2]) : 1000;
+    long key_count = total_mb * 1024 * 1024 / value_size;
+
+    Store store(MAX_LEVEL);
+    std::string value(value_size, 'v');
+    long i = 0;
+    store.bulk_load([&](int& k, std::string& v) {
+        if (i == key_count) {
+            return false;
+        }
+        k = static_cast<int>(i++);
+        v = value;
+        return true;
+    });
+    std::cout << "keys: " << key_count << ", value size: " << value_size << std::endl;
+
+    // dump_file / load_file 会打印提示，测量期间关闭 std::cout
+    std::cout.setstate(std::ios_base::badbit);
+
+    auto start = std::chrono::high_resolution_clock::now();
+    text_save(store);
+    double text_save_time = seconds_since(start);
+
+    start = std::chrono::high_resolution_clock::now();
+    store.dump_file();
+    double binary_save_time = seconds_since(start);
+
+    double text_load_time;
+    double binary_load_time;
+    size_t text_keys;
+    int binary_keys;
+    {
+        Store loaded(MAX_LEVEL);
+        start = std::chrono::high_resolution_clock::now();
+        text_keys = text_load(loaded);
+        text_load_time = seconds_since(start);
+    }
+    {
+        Store loaded(MAX_LEVEL);
+        start = std::chrono::high_resolution_clock::now();
+        loaded.load_file();
+        binary_load_time = seconds_since(start);
+        binary_keys = loaded.size();
+    }
+    std::cout.clear();
+
+    double text_mb = file_mb(TEXT_FILE);
+    double binary_mb = file_mb(STORE_FILE);
+    std::remove(TEXT_FILE);
+    std::remove(STORE_FILE);
+
+    std::cout << std::setw(8) << "format"
+              << std::setw(10) << "MB"
+              << std::setw(10) << "save s"
+              << std::setw(12) << "save MB/s"
+              << std::setw(10) << "load s"
+              << std::setw(12) << "load MB/s" << std::endl;
+    report("text", text_save_time, text_load_time, text_mb);
+    report("binary", binary_save_time, binary_load_time, binary_mb);
+    if ((long)text_keys != key_count || binary_keys != key_count) {
+        std::cout << "key count mismatch: text " << text_keys << ", binary " << binary_keys << std::endl;
+    }
+    return 0;
+}
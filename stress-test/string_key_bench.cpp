@@ -0,0 +1,84 @@
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <chrono>
+#include <random>
+#include <cstdlib>
+#include <malloc.h>
+#include "../LRU_skiplist.h"
+
+// 字符串键基准：key_count 个长度为 16、32、64 字节的键（"key:" 加随机字母数字），
+// 分别装入 SkipList<std::string, int> 和 SkipList<StringKey, int>，比较每个键占用的堆内存和随机查找的吞吐。
+// std::string 键用 std::string 查找，StringKey 键直接用指向同一份数据的 std::string_view 查找。
+// 用法：./bin/string_key_bench [key_count] [ops]，默认 200000 1000000
+
+#define MAX_LEVEL 18
+
+size_t heap_in_use() {
+    struct mallinfo2 info = mallinfo2();
+    return info.uordblks + info.hblkhd;
+}
+
+std::vector<std::string> make_keys(int key_count, size_t length, std::mt19937_64& gen) {
+    static const char alphabet[] = "abcdefghijklmnopqrstuvwxyz0123456789";
+    std::vector<std::string> keys(key_count);
+    for (std::string& key : keys) {
+        key = "key:";
+        while (key.size() < length) {
+            key.push_back(alphabet[gen() % (sizeof(alphabet) - 1)]);
+        }
+    }
+    return keys;
+}
+
+template<typename K, typename Lookup>
+void run(const char* name, const std::vector<std::string>& keys, const std::vector<int>& trace, Lookup lookup) {
+    size_t heap_before = heap_in_use();
+    SkipList<K, int>* store = new SkipList<K, int>(MAX_LEVEL, 1);
+    std::cout.setstate(std::ios_base::badbit);
+    for (size_t i = 0; i < keys.size(); i++) {
+        store->insert_element(keys[i], static_cast<int>(i));
+    }
+    std::cout.clear();
+    double bytes = static_cast<double>(heap_in_use() - heap_before) / keys.size();
+
+    size_t found = 0;
+    auto start = std::chrono::high_resolution_clock::now();
+    for (int i : trace) {
+        found += lookup(*store, keys[i]) ? 1 : 0;
+    }
+    std::chrono::duration<double> elapsed = std::chrono::high_resolution_clock::now() - start;
+    if (found != trace.size()) {
+        std::cout << "lookup failed" << std::endl;
+    }
+    std::cout << std::setw(14) << name << std::fixed << std::setprecision(1) << std::setw(14) << bytes
+              << std::setprecision(0) << std::setw(14) << trace.size() / elapsed.count() << std::endl;
+    delete store;
+}
+
+int main(int argc, char* argv[]) {
+    int key_count = argc > 1 ? atoi(argv[1]) : 200000;
+    int ops = argc > 2 ? atoi(argv[2]) : 1000000;
+
+    std::mt19937_64 gen(3);
+    std::cout << "keys: " << key_count << ", ops: " << ops << std::endl;
+    for (size_t length : {16, 32, 64}) {
+        std::vector<std::string> keys = make_keys(key_count, length, gen);
+        std::vector<int> trace(ops);
+        for (int& i : trace) {
+            i = gen() % key_count;
+        }
+        std::cout << "key length " << length << std::endl;
+        std::cout << std::setw(14) << "key type" << std::setw(14) << "heap B/key" << std::setw(14) << "lookups/s"
+                  << std::endl;
+        run<std::string>("std::string", keys, trace, [](SkipList<std::string, int>& store, const std::string& key) {
+            return store.contains(key);
+        });
+        run<StringKey>("StringKey", keys, trace, [](SkipList<StringKey, int>& store, const std::string& key) {
+            return store.contains(std::string_view(key));
+        });
+    }
+    return 0;
+}
@@ -0,0 +1,112 @@
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <thread>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+
+// 使用单独的文件，不覆盖 store/dumpFile 和 store/wal
+#define STORE_FILE "store/wal_bench_dump"
+#define WAL_FILE "store/wal_bench.log"
+#include "../skiplist.h"
+
+// 预写日志基准：与 stress_test 相同的负载（多个线程 insert_element 随机键，值为 "a"），
+// 分别在不写日志和三种 fsync 策略下运行，比较吞吐、insert 的 p99 延迟，以及 group commit 的效果
+// （records/write 为平均每次 write 合并的记录数）。ALWAYS 每次提交都要 fdatasync，操作数取 1/10。
+// 最后把日志重放到一个新跳表上，检查键数与写入时一致。
+// 用法：./bin/wal_bench [op_count]，默认 100000
+
+#define MAX_LEVEL 18
+
+double seconds_since(std::chrono::high_resolution_clock::time_point start) {
+    std::chrono::duration<double> elapsed = std::chrono::high_resolution_clock::now() - start;
+    return elapsed.count();
+}
+
+const char* policy_name(int policy) {
+    switch (policy) {
+    case WAL_SYNC_ALWAYS: return "always";
+    case WAL_SYNC_INTERVAL: return "interval";
+    case WAL_SYNC_NEVER: return "never";
+    default: return "off";
+    }
+}
+
+// policy 为 -1 时不打开日志
+void run(int policy, int threads, int op_count) {
+    std::remove(WAL_FILE);
+    int key_count = op_count;
+    if (policy == WAL_SYNC_ALWAYS) {
+        op_count /= 10;
+    }
+
+    int size;
+    double elapsed;
+    SkipListStats stats;
+    uint64_t records = 0, writes = 0, syncs = 0;
+    {
+        SkipList<int, std::string> list(MAX_LEVEL);
+        std::cout.setstate(std::ios_base::badbit);
+        if (policy >= 0) {
+            list.open_wal(WAL_FILE, static_cast<WalSyncPolicy>(policy), 1000);
+        }
+        auto start = std::chrono::high_resolution_clock::now();
+        std::vector<std::thread> workers;
+        for (int t = 0; t < threads; t++) {
+            workers.emplace_back([&list, t, threads, op_count, key_count] {
+                unsigned int seed = t + 1;
+                for (int i = 0; i < op_count / threads; i++) {
+                    list.insert_element(rand_r(&seed) % key_count, "a");
+                }
+            });
+        }
+        for (size_t t = 0; t < workers.size(); t++) {
+            workers[t].join();
+        }
+        elapsed = seconds_since(start);
+        std::cout.clear();
+        size = list.size();
+        stats = list.stats();
+        if (policy >= 0) {
+            records = list.wal().record_count();
+            writes = list.wal().write_count();
+            syncs = list.wal().sync_count();
+        }
+    }
+
+    std::cout << std::setw(10) << policy_name(policy) << std::setw(9) << threads << std::fixed
+              << std::setw(12) << std::setprecision(0) << op_count / elapsed
+              << std::setw(12) << std::setprecision(1) << stats.ops[STATS_INSERT].percentile(0.99) / 1000.0
+              << std::setw(15) << std::setprecision(2) << (writes == 0 ? 0.0 : (double)records / writes)
+              << std::setw(8) << syncs;
+
+    if (policy >= 0) {
+        SkipList<int, std::string> replayed(MAX_LEVEL);
+        std::cout.setstate(std::ios_base::badbit);
+        replayed.open_wal(WAL_FILE, WAL_SYNC_NEVER);
+        std::cout.clear();
+        if (replayed.size() != size) {
+            std::cout << "  replay mismatch: " << replayed.size() << " != " << size;
+        }
+    }
+    std::cout << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+    int op_count = argc > 1 ? atoi(argv[1]) : 100000;
+    int policies[] = {-1, WAL_SYNC_NEVER, WAL_SYNC_INTERVAL, WAL_SYNC_ALWAYS};
+    int thread_counts[] = {1, 4, 16};
+
+    std::cout << std::setw(10) << "policy" << std::setw(9) << "threads"
+              << std::setw(12) << "ops/sec" << std::setw(12) << "p99 us"
+              << std::setw(15) << "records/write" << std::setw(8) << "syncs" << std::endl;
+    for (int policy : policies) {
+        for (int threads : thread_counts) {
+            run(policy, threads, op_count);
+        }
+    }
+    std::remove(WAL_FILE);
+    return 0;
+}
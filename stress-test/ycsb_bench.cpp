@@ -0,0 +1,427 @@
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <thread>
+#include <memory>
+#include <atomic>
+#include <chrono>
+#include <random>
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+
+// YCSB 风格的基准：workload A~F，键分布 uniform / zipfian / latest，多线程，输出吞吐和 p50/p99/p999 延迟（CSV 或 JSON）。
+// 同一份源码按引擎编译三次（三个头文件都定义了 SkipList，不能放在一个程序里）：
+//   -DYCSB_ENGINE_LRU    LRU_skiplist.h       bin/ycsb_lru
+//   -DYCSB_ENGINE_TIMER  Timer_LRU_SkipList.h bin/ycsb_timer
+//   都不定义             skiplist.h           bin/ycsb_skiplist
+// ycsb_start.sh 依次运行三个引擎，结果拼成一张表。
+//
+//   workload  操作比例                              默认键分布
+//   A         50% read, 50% update                  zipfian
+//   B         95% read, 5% update                   zipfian
+//   C         100% read                             zipfian
+//   D         95% read, 5% insert                   latest
+//   E         95% scan（1~SCAN_MAX 条）, 5% insert   zipfian
+//   F         50% read, 50% read-modify-write       zipfian
+//
+// 每个 workload 先用 --threads 个线程按随机顺序插入 --records 条记录（结果中 op 为 load 的行），再执行 --operations 次操作。
+// 不同 workload 各用一个新的跳表，互不影响。
+// 键为 "user" + 补0的编号，总长 --key-size 字节；run 阶段 insert 的编号接在已有记录之后。
+// zipfian 的热键经过哈希打散到整个键空间（YCSB 的 scrambled zipfian），latest 偏向最近插入的编号。
+//
+// 用法：./bin/ycsb_lru [--workloads=ABCDEF] [--distribution=uniform|zipfian|latest] [--threads=1] [--records=100000]
+//       [--operations=100000] [--key-size=16] [--value-size=100] [--cache=记录数] [--max-level=18]
+//       [--format=csv|json] [--no-header]
+// --distribution 不指定时用各 workload 的默认分布；--cache 为 LRU 引擎的缓存容量（节点数）；
+// json 每行一个对象（JSON Lines），多个引擎的输出可以直接拼接。
+
+#if defined(YCSB_ENGINE_TIMER)
+#include "../Timer_LRU_SkipList.h"
+#define YCSB_ENGINE_NAME "timer_lru"
+#elif defined(YCSB_ENGINE_LRU)
+#include "../LRU_skiplist.h"
+#define YCSB_ENGINE_NAME "lru"
+#else
+#include "../skiplist.h"
+#define YCSB_ENGINE_NAME "skiplist"
+#endif
+
+#define SCAN_MAX 100 // workload E 每次 scan 的最大条数
+#define ZIPFIAN_THETA 0.99 // YCSB 的默认值
+
+typedef SkipList<std::string, std::string> Store;
+
+enum Op { OP_READ, OP_UPDATE, OP_INSERT, OP_SCAN, OP_RMW, OP_LOAD, OP_COUNT };
+static const char* const op_names[OP_COUNT] = {"read", "update", "insert", "scan", "read_modify_write", "load"};
+
+enum Distribution { UNIFORM, ZIPFIAN, LATEST };
+static const char* const distribution_names[] = {"uniform", "zipfian", "latest"};
+
+struct Workload {
+    char name;
+    double read, update, insert, scan, rmw; // 各操作的比例，和为 1
+    Distribution distribution;
+};
+
+static const Workload workloads[] = {
+    {'A', 0.50, 0.50, 0, 0, 0, ZIPFIAN},
+    {'B', 0.95, 0.05, 0, 0, 0, ZIPFIAN},
+    {'C', 1.00, 0, 0, 0, 0, ZIPFIAN},
+    {'D', 0.95, 0, 0.05, 0, 0, LATEST},
+    {'E', 0, 0, 0.05, 0.95, 0, ZIPFIAN},
+    {'F', 0.50, 0, 0, 0, 0.50, ZIPFIAN},
+};
+
+struct Options {
+    std::string workloads = "ABCDEF";
+    int distribution = -1; // -1 表示用 workload 的默认分布
+    int threads = 1;
+    long records = 100000;
+    long operations = 100000;
+    int key_size = 16;
+    int value_size = 100;
+    long cache = -1; // -1 表示等于记录数
+    int max_level = 18;
+    bool json = false;
+    bool header = true;
+};
+
+// YCSB 的 ZipfianGenerator（Gray 等人的算法）：返回 [0, n) 内的排名，0 最热
+class ZipfianGenerator {
+public:
+    explicit ZipfianGenerator(long n) : _n(n) {
+        _zetan = 0;
+        for (long i = 1; i <= n; i++) {
+            _zetan += 1.0 / std::pow(static_cast<double>(i), ZIPFIAN_THETA);
+        }
+        double zeta2 = 1.0 + 1.0 / std::pow(2.0, ZIPFIAN_THETA);
+        _alpha = 1.0 / (1.0 - ZIPFIAN_THETA);
+        _eta = (1.0 - std::pow(2.0 / n, 1.0 - ZIPFIAN_THETA)) / (1.0 - zeta2 / _zetan);
+        _half_pow_theta = 1.0 + std::pow(0.5, ZIPFIAN_THETA);
+    }
+
+    long next(double u) const {
+        double uz = u * _zetan;
+        if (uz < 1.0) {
+            return 0;
+        }
+        if (uz < _half_pow_theta) {
+            return 1;
+        }
+        long rank = static_cast<long>(_n * std::pow(_eta * u - _eta + 1.0, _alpha));
+        return rank < _n ? rank : _n - 1;
+    }
+
+private:
+    long _n;
+    double _zetan;
+    double _alpha;
+    double _eta;
+    double _half_pow_theta;
+};
+
+static uint64_t fnv_hash(uint64_t value) {
+    uint64_t hash = 0xCBF29CE484222325ULL;
+    for (int i = 0; i < 8; i++) {
+        hash ^= value & 0xff;
+        hash *= 0x100000001B3ULL;
+        value >>= 8;
+    }
+    return hash;
+}
+
+static std::string make_key(long number, int key_size) {
+    std::string digits = std::to_string(number);
+    return "user" + std::string(key_size - 4 - digits.size(), '0') + digits;
+}
+
+static void record_latency(LatencySummary& summary, uint64_t ns) {
+    summary.buckets[LatencyBuckets::index(ns)]++;
+    summary.count++;
+    summary.sum_ns += ns;
+    if (ns > summary.max_ns) {
+        summary.max_ns = ns;
+    }
+}
+
+static Store* make_store(const Options& options) {
+#if defined(YCSB_ENGINE_TIMER)
+    // 定时存盘的间隔设得足够长，测试期间不写 dumpFile
+    return new Store(options.max_level, options.cache, 1 << 30, false);
+#elif defined(YCSB_ENGINE_LRU)
+    return new Store(options.max_level, options.cache);
+#else
+    return new Store(options.max_level);
+#endif
+}
+
+// 用 update 覆盖已有的值：三个引擎中只有 write 会覆盖，insert_element 遇到已存在的键不修改
+static void update(Store& store, const std::string& key, const std::string& value) {
+    WriteBatch<std::string, std::string> batch;
+    batch.put(key, value);
+    store.write(batch);
+}
+
+class Runner {
+public:
+    Runner(const Options& options, const Workload& workload)
+        : _options(options), _workload(workload),
+          _distribution(options.distribution >= 0 ? static_cast<Distribution>(options.distribution) : workload.distribution),
+          _zipfian(options.records), _inserted(options.records), _next_insert(options.records) {}
+
+    void run() {
+        _order.resize(_options.records);
+        for (long i = 0; i < _options.records; i++) {
+            _order[i] = i;
+        }
+        std::shuffle(_order.begin(), _order.end(), std::mt19937_64(1));
+
+        std::unique_ptr<Store> store(make_store(_options));
+        _store = store.get();
+        std::cout.setstate(std::ios_base::badbit); // insert_element 会逐条打印
+        double load_seconds = parallel([this](int thread, std::vector<LatencySummary>& latency) { load(thread, latency); });
+        std::cout.clear();
+        report_load(load_seconds);
+
+        std::cout.setstate(std::ios_base::badbit);
+        double run_seconds = parallel([this](int thread, std::vector<LatencySummary>& latency) { execute(thread, latency); });
+        std::cout.clear();
+        report_run(run_seconds);
+
+        std::cout.setstate(std::ios_base::badbit); // 析构时可能打印
+        store.reset();
+        std::cout.clear();
+    }
+
+private:
+    template<typename Body>
+    double parallel(Body body) {
+        _latency.assign(_options.threads, std::vector<LatencySummary>(OP_COUNT));
+        std::vector<std::thread> threads;
+        auto start = std::chrono::steady_clock::now();
+        for (int t = 0; t < _options.threads; t++) {
+            threads.emplace_back([this, &body, t] { body(t, _latency[t]); });
+        }
+        for (std::thread& thread : threads) {
+            thread.join();
+        }
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        return elapsed.count();
+    }
+
+    // 记录按打乱的编号插入，线程 t 负责第 t 段
+    void load(int thread, std::vector<LatencySummary>& latency) {
+        std::string value(_options.value_size, 'v');
+        long begin = _options.records * thread / _options.threads;
+        long end = _options.records * (thread + 1) / _options.threads;
+        for (long i = begin; i < end; i++) {
+            std::string key = make_key(_order[i], _options.key_size);
+            uint64_t start = stats_now_ns();
+            _store->insert_element(key, value);
+            record_latency(latency[OP_LOAD], stats_now_ns() - start);
+        }
+    }
+
+    long choose_key(std::mt19937_64& gen, std::uniform_real_distribution<double>& uniform) {
+        long count = _inserted.load(std::memory_order_acquire);
+        if (_distribution == UNIFORM) {
+            return static_cast<long>(gen() % count);
+        }
+        long rank = _zipfian.next(uniform(gen));
+        if (_distribution == LATEST) {
+            return rank < count ? count - 1 - rank : 0;
+        }
+        return static_cast<long>(fnv_hash(rank) % count);
+    }
+
+    void execute(int thread, std::vector<LatencySummary>& latency) {
+        std::mt19937_64 gen(thread + 100);
+        std::uniform_real_distribution<double> uniform(0, 1);
+        std::uniform_int_distribution<int> scan_length(1, SCAN_MAX);
+        std::string value(_options.value_size, 'u');
+        std::string read_value;
+        static const std::string scan_end(1, '\xff'); // 大于所有 "user..." 键
+        long count = _options.operations * (thread + 1) / _options.threads - _options.operations * thread / _options.threads;
+        for (long i = 0; i < count; i++) {
+            double dice = uniform(gen);
+            Op op = dice < _workload.read ? OP_READ
+                  : (dice -= _workload.read) < _workload.update ? OP_UPDATE
+                  : (dice -= _workload.update) < _workload.insert ? OP_INSERT
+                  : (dice -= _workload.insert) < _workload.scan ? OP_SCAN : OP_RMW;
+            long number = op == OP_INSERT ? _next_insert.fetch_add(1) : choose_key(gen, uniform);
+            std::string key = make_key(number, _options.key_size);
+            uint64_t start = stats_now_ns();
+            switch (op) {
+            case OP_READ:
+                _store->get(key, read_value);
+                break;
+            case OP_UPDATE:
+                update(*_store, key, value);
+                break;
+            case OP_INSERT:
+                _store->insert_element(key, value);
+                break;
+            case OP_SCAN:
+                _store->scan(key, scan_end, scan_length(gen), [&read_value](const std::string&, const std::string& v) {
+                    read_value = v;
+                });
+                break;
+            default:
+                _store->get(key, read_value);
+                update(*_store, key, value);
+                break;
+            }
+            record_latency(latency[op], stats_now_ns() - start);
+            if (op == OP_INSERT) {
+                // 比自己编号小的插入都完成后才让读操作看到，读到的编号都已存在
+                long expected = number;
+                while (!_inserted.compare_exchange_weak(expected, number + 1, std::memory_order_release)) {
+                    expected = number;
+                    std::this_thread::yield();
+                }
+            }
+        }
+    }
+
+    std::vector<LatencySummary> merged_latency() const {
+        std::vector<LatencySummary> merged(OP_COUNT);
+        for (const std::vector<LatencySummary>& per_thread : _latency) {
+            for (int i = 0; i < OP_COUNT; i++) {
+                merged[i].merge(per_thread[i]);
+            }
+        }
+        return merged;
+    }
+
+    void report_load(double seconds) {
+        std::vector<LatencySummary> merged = merged_latency();
+        print_row(op_names[OP_LOAD], merged[OP_LOAD], _options.records / seconds);
+    }
+
+    // run 阶段每种操作一行，最后一行汇总（op 为 all）
+    void report_run(double seconds) {
+        std::vector<LatencySummary> merged = merged_latency();
+        LatencySummary all;
+        for (int i = 0; i < OP_LOAD; i++) {
+            if (merged[i].count > 0) {
+                print_row(op_names[i], merged[i], merged[i].count / seconds);
+                all.merge(merged[i]);
+            }
+        }
+        print_row("all", all, all.count / seconds);
+    }
+
+    void print_row(const char* op, const LatencySummary& latency, double throughput) {
+        std::ostringstream row;
+        row << std::fixed;
+        if (_options.json) {
+            row << "{\"engine\":\"" << YCSB_ENGINE_NAME << "\",\"workload\":\"" << _workload.name
+                << "\",\"distribution\":\"" << distribution_names[_distribution] << "\",\"threads\":" << _options.threads
+                << ",\"records\":" << _options.records << ",\"operations\":" << _options.operations
+                << ",\"key_size\":" << _options.key_size << ",\"value_size\":" << _options.value_size
+                << ",\"op\":\"" << op << "\",\"count\":" << latency.count << std::setprecision(0)
+                << ",\"ops_per_sec\":" << throughput << std::setprecision(2)
+                << ",\"mean_us\":" << latency.mean_ns() / 1000.0
+                << ",\"p50_us\":" << latency.percentile(0.5) / 1000.0
+                << ",\"p99_us\":" << latency.percentile(0.99) / 1000.0
+                << ",\"p999_us\":" << latency.percentile(0.999) / 1000.0
+                << ",\"max_us\":" << latency.max_ns / 1000.0 << "}";
+        } else {
+            row << YCSB_ENGINE_NAME << "," << _workload.name << "," << distribution_names[_distribution] << ","
+                << _options.threads << "," << _options.records << "," << _options.operations << ","
+                << _options.key_size << "," << _options.value_size << "," << op << "," << latency.count << ","
+                << std::setprecision(0) << throughput << std::setprecision(2) << ","
+                << latency.mean_ns() / 1000.0 << "," << latency.percentile(0.5) / 1000.0 << ","
+                << latency.percentile(0.99) / 1000.0 << "," << latency.percentile(0.999) / 1000.0 << ","
+                << latency.max_ns / 1000.0;
+        }
+        std::cout << row.str() << std::endl;
+    }
+
+    const Options& _options;
+    const Workload& _workload;
+    Distribution _distribution;
+    ZipfianGenerator _zipfian;
+    Store* _store;
+    std::vector<long> _order; // load 阶段的插入顺序
+    std::atomic<long> _inserted; // 编号小于它的记录都已插入，读操作从中选键
+    std::atomic<long> _next_insert; // 下一个 insert 的编号
+    std::vector<std::vector<LatencySummary>> _latency; // [线程][操作]
+};
+
+static bool parse_option(const char* arg, Options& options) {
+    const char* eq = strchr(arg, '=');
+    std::string name = eq ? std::string(arg, eq - arg) : std::string(arg);
+    std::string value = eq ? std::string(eq + 1) : std::string();
+    if (name == "--workloads") {
+        options.workloads = value;
+    } else if (name == "--distribution") {
+        options.distribution = value == "uniform" ? UNIFORM : value == "zipfian" ? ZIPFIAN : value == "latest" ? LATEST : -2;
+        return options.distribution != -2;
+    } else if (name == "--threads") {
+        options.threads = atoi(value.c_str());
+    } else if (name == "--records") {
+        options.records = atol(value.c_str());
+    } else if (name == "--operations") {
+        options.operations = atol(value.c_str());
+    } else if (name == "--key-size") {
+        options.key_size = atoi(value.c_str());
+    } else if (name == "--value-size") {
+        options.value_size = atoi(value.c_str());
+    } else if (name == "--cache") {
+        options.cache = atol(value.c_str());
+    } else if (name == "--max-level") {
+        options.max_level = atoi(value.c_str());
+    } else if (name == "--format") {
+        options.json = value == "json";
+        return value == "json" || value == "csv";
+    } else if (name == "--no-header") {
+        options.header = false;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+int main(int argc, char* argv[]) {
+    Options options;
+    for (int i = 1; i < argc; i++) {
+        if (!parse_option(argv[i], options)) {
+            std::cerr << "unknown option: " << argv[i] << std::endl;
+            return 1;
+        }
+    }
+    if (options.cache < 0) {
+        options.cache = options.records;
+    }
+    // run 阶段的 insert 最多新增 operations 条，编号要放得进键里
+    int digits = static_cast<int>(std::to_string(options.records + options.operations).size());
+    if (options.threads < 1 || options.records < 1 || options.operations < 0 || options.value_size < 0 ||
+        options.key_size < 4 + digits) {
+        std::cerr << "invalid options: need threads >= 1, records >= 1 and key-size >= " << 4 + digits << std::endl;
+        return 1;
+    }
+
+    if (options.header && !options.json) {
+        std::cout << "engine,workload,distribution,threads,records,operations,key_size,value_size,op,count,"
+                  << "ops_per_sec,mean_us,p50_us,p99_us,p999_us,max_us" << std::endl;
+    }
+    for (char name : options.workloads) {
+        const Workload* workload = nullptr;
+        for (const Workload& w : workloads) {
+            if (w.name == toupper(name)) {
+                workload = &w;
+            }
+        }
+        if (workload == nullptr) {
+            std::cerr << "unknown workload: " << name << std::endl;
+            return 1;
+        }
+        Runner(options, *workload).run();
+    }
+    return 0;
+}
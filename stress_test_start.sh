@@ -1,2 +1,2 @@
-g++ stress-test/stress_test.cpp -o ./bin/stress  --std=c++11 -pthread
+g++ stress-test/stress_test.cpp -o ./bin/stress  --std=c++17 -pthread
 ./bin/stress
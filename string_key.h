@@ -0,0 +1,199 @@
+#ifndef STRING_KEY_H
+#define STRING_KEY_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include "memory_usage.h"
+#include "snapshot_format.h"
+
+// 字节串键：SkipList<StringKey, V>。按字节（memcmp）比较，顺序与 std::string 相同。
+//
+// 不超过 STRING_KEY_INLINE 字节的键直接存在对象里（即节点里），不单独分配；更长的键放在堆上。
+// 前 8 字节按大端序拼成整数缓存在 _prefix 中，比较时先比这个整数，不同就不用访问键的数据，
+// 只有前 8 字节相同时才对剩下的部分 memcmp。
+//
+// 从 std::string_view / std::string / const char* 构造时只引用外部的字节，不复制（与 std::string_view 一样，
+// 调用方要保证数据在使用期间有效），用于查找：store.get(std::string_view(buf, len)) 不会构造 std::string。
+// 复制、移动和赋值得到的键总是持有自己的数据，跳表节点、过期索引、WriteBatch 保存的都是副本
+
+#define STRING_KEY_INLINE 24 // 内联存储的最大长度（字节）
+
+class StringKey {
+public:
+    StringKey() : _prefix(0), _size(0), _mode(INLINE) {}
+
+    // 引用外部数据，不复制
+    StringKey(std::string_view s) { borrow(s.data(), s.size()); }
+    StringKey(const std::string& s) { borrow(s.data(), s.size()); }
+    StringKey(const char* s) { borrow(s, strlen(s)); }
+
+    StringKey(const StringKey& other) { assign(other.data(), other._size); }
+
+    StringKey(StringKey&& other) noexcept { take(other); }
+
+    StringKey& operator=(const StringKey& other) {
+        if (this != &other) {
+            release();
+            assign(other.data(), other._size);
+        }
+        return *this;
+    }
+
+    StringKey& operator=(StringKey&& other) noexcept {
+        if (this != &other) {
+            release();
+            take(other);
+        }
+        return *this;
+    }
+
+    ~StringKey() { release(); }
+
+    const char* data() const { return _mode == INLINE ? _inline : _ptr; }
+    size_t size() const { return _size; }
+    std::string_view view() const { return std::string_view(data(), _size); }
+    std::string str() const { return std::string(data(), _size); }
+
+    size_t heap_size() const { return _mode == HEAP ? _size : 0; } // 在堆上占用的字节数
+
+    // 小于 0、等于 0、大于 0 分别表示 a < b、a == b、a > b
+    static int compare(const StringKey& a, const StringKey& b) {
+        if (a._prefix != b._prefix) {
+            return a._prefix < b._prefix ? -1 : 1;
+        }
+        // 前缀相同说明前 min(8, 较短的长度) 个字节相同，较长的键在这之后到第 8 字节都是 0
+        size_t n = std::min(a._size, b._size);
+        if (n > 8) {
+            int result = memcmp(a.data() + 8, b.data() + 8, n - 8);
+            if (result != 0) {
+                return result;
+            }
+        }
+        return a._size < b._size ? -1 : a._size > b._size ? 1 : 0;
+    }
+
+    friend bool operator==(const StringKey& a, const StringKey& b) {
+        return a._prefix == b._prefix && a._size == b._size &&
+               (a._size <= 8 || memcmp(a.data() + 8, b.data() + 8, a._size - 8) == 0);
+    }
+    friend bool operator!=(const StringKey& a, const StringKey& b) { return !(a == b); }
+    friend bool operator<(const StringKey& a, const StringKey& b) { return compare(a, b) < 0; }
+    friend bool operator>(const StringKey& a, const StringKey& b) { return compare(a, b) > 0; }
+    friend bool operator<=(const StringKey& a, const StringKey& b) { return compare(a, b) <= 0; }
+    friend bool operator>=(const StringKey& a, const StringKey& b) { return compare(a, b) >= 0; }
+
+private:
+    enum Mode : uint32_t { INLINE = 0, HEAP, BORROWED };
+
+    // 前 8 字节（不足时补 0）按大端序组成的整数，整数的大小顺序就是字节的字典序
+    static uint64_t load_prefix(const char* s, size_t size) {
+        unsigned char bytes[8] = {0};
+        memcpy(bytes, s, size < 8 ? size : 8);
+        uint64_t prefix;
+        memcpy(&prefix, bytes, 8);
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+        prefix = __builtin_bswap64(prefix);
+#endif
+        return prefix;
+    }
+
+    void borrow(const char* s, size_t size) {
+        _prefix = load_prefix(s, size);
+        _size = static_cast<uint32_t>(size);
+        _mode = BORROWED;
+        _ptr = s;
+    }
+
+    void assign(const char* s, size_t size) {
+        _prefix = load_prefix(s, size);
+        _size = static_cast<uint32_t>(size);
+        if (size <= STRING_KEY_INLINE) {
+            _mode = INLINE;
+            memcpy(_inline, s, size);
+        } else {
+            _mode = HEAP;
+            char* copy = new char[size];
+            memcpy(copy, s, size);
+            _ptr = copy;
+        }
+    }
+
+    // 堆上的数据直接接管，内联或引用的数据复制一份
+    void take(StringKey& other) {
+        if (other._mode != HEAP) {
+            assign(other.data(), other._size);
+            return;
+        }
+        _prefix = other._prefix;
+        _size = other._size;
+        _mode = HEAP;
+        _ptr = other._ptr;
+        other._prefix = 0;
+        other._size = 0;
+        other._mode = INLINE;
+    }
+
+    void release() {
+        if (_mode == HEAP) {
+            delete[] _ptr;
+        }
+    }
+
+    uint64_t _prefix;
+    uint32_t _size;
+    Mode _mode;
+    union {
+        char _inline[STRING_KEY_INLINE];
+        const char* _ptr; // HEAP 时为自己分配的数据，BORROWED 时为外部数据
+    };
+};
+
+inline std::ostream& operator<<(std::ostream& out, const StringKey& key) {
+    return out << key.view();
+}
+
+inline std::istream& operator>>(std::istream& in, StringKey& key) {
+    std::string s;
+    in >> s;
+    key = StringKey(s);
+    return in;
+}
+
+inline size_t heap_bytes(const StringKey& key) {
+    return key.heap_size();
+}
+
+namespace std {
+template<>
+struct hash<StringKey> {
+    size_t operator()(const StringKey& key) const {
+        return std::hash<std::string_view>()(key.view());
+    }
+};
+}
+
+// 快照和 WAL 中按原始字节保存，与 std::string 键的编码相同
+template<>
+struct SnapshotCodec<StringKey> {
+    static void encode(const StringKey& value, std::string& out) {
+        out.append(value.data(), value.size());
+    }
+    static bool decode(const char* data, size_t len, StringKey& value) {
+        value = StringKey(std::string_view(data, len));
+        return true;
+    }
+};
+
+template<>
+inline bool snapshot_parse_text<StringKey>(const std::string& text, StringKey& value) {
+    value = StringKey(text);
+    return true;
+}
+
+#endif
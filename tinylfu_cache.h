@@ -0,0 +1,290 @@
+#ifndef TINYLFU_CACHE_H
+#define TINYLFU_CACHE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <algorithm>
+#include <functional>
+#include <vector>
+#include "memory_usage.h"
+
+// W-TinyLFU 缓存策略，作为 SkipList 的第三个模板参数使用：SkipList<K, V, TinyLFUCache>（默认为 LRUCache，另见 clock_cache.h）。
+//
+//   window     容量的 1%，新加入缓存的节点先进入这里，按 LRU 顺序移出
+//   probation  主区（其余 99%）中的试用段，从 window 移出并被接纳的节点进入这里
+//   protected  主区中的保护段，最多占主区的 80%；probation 中的节点再次命中时升级到这里，
+//              保护段超出容量时最久未使用的节点降回 probation
+//
+// 主区满时，从 window 移出的候选节点与主区中最久未使用的节点（probation 尾部）比较访问频率，频率更高的留下。
+// 一次性访问的键（全表扫描、均匀随机读）只会冲刷 window，挤不掉主区里的热键。
+// 频率由 count-min sketch 估计，计数累计到容量的 TINYLFU_AGING_FACTOR 倍时全部减半（aging），使频率反映近期的访问。
+// 容量按字节计时（见 memory_usage.h）各段的容量同样按字节划分，候选节点要淘汰主区中多个节点才放得下时
+// 逐个比较频率，输给其中一个就放弃候选；sketch 的宽度按 TINYLFU_BYTES_PER_ENTRY 估算节点数。
+//
+// 接口与 LRUCache 相同：链表指针在跳表节点中（Node::lru_prev/lru_next，所在的段记在 Node::lru_segment），
+// 移出缓存只是把节点摘出链表，节点仍在跳表中；节点从跳表删除前必须先 remove。不加锁，由跳表持锁调用
+
+#define TINYLFU_WINDOW_PERCENT 1 // window 占总容量的百分比
+#define TINYLFU_PROTECTED_PERCENT 80 // protected 占主区的百分比
+#define TINYLFU_AGING_FACTOR 10 // sketch 的计数达到容量的这个倍数时减半
+#define TINYLFU_MAX_COUNT 15 // sketch 计数的上限
+#define TINYLFU_BYTES_PER_ENTRY 256 // 容量按字节计时，估算节点数用的平均节点大小
+
+template<typename K, typename V>
+class Node;
+
+// count-min sketch：4 行计数器，每行宽度为不小于容量的 2 的幂，键的频率取 4 行中的最小值
+template<typename K>
+class FrequencySketch {
+public:
+    explicit FrequencySketch(size_t capacity);
+
+    void increment(const K& key); // 记录一次访问
+
+    int frequency(const K& key) const; // 估计的访问次数，不超过 TINYLFU_MAX_COUNT
+
+    size_t memory_bytes() const { return _table.capacity(); } // 计数器占用的内存
+
+private:
+    static const int kRows = 4;
+
+    static uint64_t mix(const K& key); // 对 std::hash 的结果再做一次混合，整数键的哈希是它本身
+    size_t index(uint64_t hash, int row) const { return row * _width + ((hash * kSeeds[row]) >> 32 & (_width - 1)); }
+    void age(); // 所有计数减半
+
+    static constexpr uint64_t kSeeds[kRows] = {
+        0xc3a5c85c97cb3127ULL, 0xb492b66fbe98f273ULL, 0x9ae16a3b2f90404fULL, 0xcbf29ce484222325ULL
+    };
+
+    size_t _width; // 每行的计数器个数
+    std::vector<uint8_t> _table; // kRows * _width 个计数器
+    size_t _additions; // 上次减半以来的访问次数
+    size_t _sample_size; // _additions 达到这个数时减半
+};
+
+template<typename K>
+constexpr uint64_t FrequencySketch<K>::kSeeds[FrequencySketch<K>::kRows];
+
+template<typename K>
+FrequencySketch<K>::FrequencySketch(size_t capacity) : _width(16), _additions(0) {
+    while (_width < capacity) {
+        _width <<= 1;
+    }
+    _table.assign(kRows * _width, 0);
+    _sample_size = (capacity == 0 ? 1 : capacity) * TINYLFU_AGING_FACTOR;
+}
+
+template<typename K>
+uint64_t FrequencySketch<K>::mix(const K& key) {
+    uint64_t h = std::hash<K>()(key);
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    return h;
+}
+
+template<typename K>
+void FrequencySketch<K>::increment(const K& key) {
+    uint64_t hash = mix(key);
+    for (int row = 0; row < kRows; row++) {
+        uint8_t& count = _table[index(hash, row)];
+        if (count < TINYLFU_MAX_COUNT) {
+            count++;
+        }
+    }
+    if (++_additions >= _sample_size) {
+        age();
+    }
+}
+
+template<typename K>
+int FrequencySketch<K>::frequency(const K& key) const {
+    uint64_t hash = mix(key);
+    int result = TINYLFU_MAX_COUNT;
+    for (int row = 0; row < kRows; row++) {
+        int count = _table[index(hash, row)];
+        if (count < result) {
+            result = count;
+        }
+    }
+    return result;
+}
+
+template<typename K>
+void FrequencySketch<K>::age() {
+    for (uint8_t& count : _table) {
+        count >>= 1;
+    }
+    _additions /= 2;
+}
+
+template<typename K, typename V>
+class TinyLFUCache {
+public:
+    static const bool concurrent = false; // get 会移动链表，只能在跳表的写锁下调用
+
+    explicit TinyLFUCache(CacheCapacity capacity);
+
+    bool get(Node<K, V>* node); // 节点在缓存中时记录一次访问、按所在的段调整位置并返回 true（命中）
+
+    void put(Node<K, V>* node); // 记录一次访问，把节点加入 window（已在缓存中时同 get），必要时按频率淘汰
+
+    void remove(Node<K, V>* node, bool expired = false); // 把节点移出缓存，expired 表示节点因过期被删除
+
+    bool cached(const Node<K, V>* node) const { return node->lru_next != nullptr; } // 节点是否在缓存中
+    size_t size() const { return _window.count + _probation.count + _protected.count; } // 缓存中的节点数
+    size_t used() const { return _window.used + _probation.used + _protected.used; } // 已用的容量，单位与容量相同
+    size_t overhead_bytes() const { return sizeof(*this) + _sketch.memory_bytes(); } // 缓存自身占用的内存
+    size_t eviction_count() const { return _evictions; } // 因容量不足被移出缓存（包括没被接纳）的次数
+    size_t expired_count() const { return _expired; } // 在缓存中时因过期被删除的次数
+
+private:
+    enum Segment { NONE = 0, WINDOW, PROBATION, PROTECTED };
+
+    // 以哨兵节点开头的环形链表，head.lru_next 为最近使用的节点，head.lru_prev 为最久未使用的节点
+    struct List {
+        Node<K, V> head;
+        size_t count = 0;
+        size_t used = 0; // 段内节点占用的容量之和
+    };
+
+    List& list_of(Segment segment);
+    void link_front(Segment segment, Node<K, V>* node); // 插入到该段链表头部
+    void unlink(Node<K, V>* node); // 从所在的段摘除
+    void touch(Node<K, V>* node); // 已在缓存中的节点被访问
+    void admit(Node<K, V>* candidate); // 从 window 移出的节点：主区有空位或频率高于主区的淘汰对象时进入 probation
+    size_t charge(const Node<K, V>* node) const { return _in_bytes ? node->memory_bytes() : 1; } // 节点占用的容量
+
+    bool _in_bytes; // 容量是否按字节计
+    size_t _window_capacity;
+    size_t _main_capacity; // probation + protected
+    size_t _protected_capacity;
+    List _window;
+    List _probation;
+    List _protected;
+    FrequencySketch<K> _sketch;
+    size_t _evictions;
+    size_t _expired;
+};
+
+template<typename K, typename V>
+TinyLFUCache<K, V>::TinyLFUCache(CacheCapacity capacity)
+    : _in_bytes(capacity.in_bytes),
+      _sketch(capacity.in_bytes ? capacity.amount / TINYLFU_BYTES_PER_ENTRY : capacity.amount),
+      _evictions(0), _expired(0) {
+    size_t total = capacity.amount;
+    _window_capacity = total == 0 ? 0 : std::max<size_t>(1, total * TINYLFU_WINDOW_PERCENT / 100);
+    _main_capacity = total - _window_capacity;
+    _protected_capacity = _main_capacity * TINYLFU_PROTECTED_PERCENT / 100;
+    for (List* list : {&_window, &_probation, &_protected}) {
+        list->head.lru_prev = &list->head;
+        list->head.lru_next = &list->head;
+    }
+}
+
+template<typename K, typename V>
+typename TinyLFUCache<K, V>::List& TinyLFUCache<K, V>::list_of(Segment segment) {
+    return segment == WINDOW ? _window : segment == PROBATION ? _probation : _protected;
+}
+
+template<typename K, typename V>
+void TinyLFUCache<K, V>::link_front(Segment segment, Node<K, V>* node) {
+    List& list = list_of(segment);
+    node->lru_prev = &list.head;
+    node->lru_next = list.head.lru_next;
+    list.head.lru_next->lru_prev = node;
+    list.head.lru_next = node;
+    node->lru_segment = segment;
+    list.count++;
+    list.used += charge(node);
+}
+
+template<typename K, typename V>
+void TinyLFUCache<K, V>::unlink(Node<K, V>* node) {
+    List& list = list_of(static_cast<Segment>(node->lru_segment));
+    list.count--;
+    list.used -= charge(node);
+    node->lru_prev->lru_next = node->lru_next;
+    node->lru_next->lru_prev = node->lru_prev;
+    node->lru_prev = nullptr;
+    node->lru_next = nullptr;
+    node->lru_segment = NONE;
+}
+
+template<typename K, typename V>
+void TinyLFUCache<K, V>::touch(Node<K, V>* node) {
+    Segment segment = static_cast<Segment>(node->lru_segment);
+    unlink(node);
+    if (segment == WINDOW) {
+        link_front(WINDOW, node);
+        return;
+    }
+    // probation 中再次命中的节点升级到 protected，protected 超出容量时把最久未使用的节点降回 probation
+    link_front(PROTECTED, node);
+    while (_protected.used > _protected_capacity) {
+        Node<K, V>* demoted = _protected.head.lru_prev;
+        unlink(demoted);
+        link_front(PROBATION, demoted);
+    }
+}
+
+template<typename K, typename V>
+void TinyLFUCache<K, V>::admit(Node<K, V>* candidate) {
+    size_t size = charge(candidate);
+    if (size > _main_capacity) {
+        _evictions++;
+        return;
+    }
+    // 主区放不下时与主区最久未使用的节点比较频率，候选更高就淘汰对方，直到放得下
+    int frequency = _sketch.frequency(candidate->get_key());
+    while (_probation.used + _protected.used + size > _main_capacity) {
+        Node<K, V>* victim = _probation.count > 0 ? _probation.head.lru_prev : _protected.head.lru_prev;
+        _evictions++;
+        if (frequency <= _sketch.frequency(victim->get_key())) {
+            return;
+        }
+        unlink(victim);
+    }
+    link_front(PROBATION, candidate);
+}
+
+template<typename K, typename V>
+bool TinyLFUCache<K, V>::get(Node<K, V>* node) {
+    if (node->lru_next == nullptr) {
+        return false; // 不在缓存中，由调用方 put 时记录这次访问
+    }
+    _sketch.increment(node->get_key());
+    touch(node);
+    return true;
+}
+
+template<typename K, typename V>
+void TinyLFUCache<K, V>::put(Node<K, V>* node) {
+    _sketch.increment(node->get_key());
+    if (node->lru_next != nullptr) {
+        touch(node);
+        return;
+    }
+    if (_window_capacity == 0 || charge(node) > _window_capacity + _main_capacity) {
+        return;
+    }
+    link_front(WINDOW, node);
+    while (_window.used > _window_capacity) {
+        Node<K, V>* candidate = _window.head.lru_prev;
+        unlink(candidate);
+        admit(candidate);
+    }
+}
+
+template<typename K, typename V>
+void TinyLFUCache<K, V>::remove(Node<K, V>* node, bool expired) {
+    if (node->lru_next == nullptr) {
+        return;
+    }
+    unlink(node);
+    if (expired) {
+        _expired++;
+    }
+}
+
+#endif
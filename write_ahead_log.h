@@ -0,0 +1,631 @@
+#ifndef WRITE_AHEAD_LOG_H
+#define WRITE_AHEAD_LOG_H
+
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <chrono>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include "async_io.h"
+#include "snapshot_format.h"
+#include "write_batch.h"
+
+// 预写日志：每次修改在返回前追加一条记录到日志文件，崩溃后用"快照 + 日志"恢复，不需要频繁全量 dump。
+//
+// 写入分两步：调用方持有跳表锁时 append 把记录放进内存缓冲区并拿到序号（日志顺序与修改顺序一致），
+// 释放跳表锁后 commit 等待自己的序号落盘。多个线程同时 commit 时，第一个线程成为 leader，
+// 把缓冲区里所有线程的记录一次 write（按策略再 fdatasync），其余线程等它完成，即 group commit。
+// 指定 io_uring 后端时（set_io_options，见 async_io.h），write 和 fdatasync 作为两个链接的请求一次提交，每次 commit 只有一次系统调用。
+//
+// fsync 策略：
+//   WAL_SYNC_ALWAYS   每次 commit 都 fdatasync，返回即持久化
+//   WAL_SYNC_INTERVAL commit 只 write 到内核，后台线程每 interval_ms 毫秒 fdatasync 一次（进程崩溃不丢，断电最多丢一个周期）
+//   WAL_SYNC_NEVER    只 write，刷盘交给操作系统
+//
+// 记录格式：payload_len u32 | crc32c u32（校验 payload）| payload
+//   payload：type u8，PUT_MS 后接 key_len u32 | value_len u32 | expire_time i64 | key | value，
+//            DELETE 后接 key_len u32 | key，BATCH 后接 count u32 和 count 个 PUT_MS/DELETE 条目
+//   expire_time 为过期时间的 Unix 毫秒（0 表示永不过期）。旧版本写的 PUT 条目格式相同但以秒为单位，
+//   重放时换算成毫秒，与快照 version 1 的处理一样，升级前留下的日志仍按原来的过期时间恢复
+// 日志末尾写了一半的记录（长度或校验不对）在重放时丢弃并截掉。快照保存成功后日志清空。
+//
+// 后台快照（fork 出的子进程写快照，父进程继续处理请求）开始时调用 rotate：当前日志并入 path.old，
+// 之后的记录写入新的空日志；子进程成功后 drop_rotated 删除 path.old，失败时保留，下次 rotate 继续追加到它后面。
+// 恢复时先重放 path.old 再重放 path。
+
+#ifndef WAL_FILE
+#define WAL_FILE "store/wal" // 默认日志文件
+#endif
+
+enum WalSyncPolicy {
+    WAL_SYNC_ALWAYS,
+    WAL_SYNC_INTERVAL,
+    WAL_SYNC_NEVER
+};
+
+enum WalRecordType {
+    WAL_PUT = 1, // 过期时间以秒为单位，只在重放旧日志时出现
+    WAL_DELETE = 2,
+    WAL_BATCH = 3,
+    WAL_PUT_MS = 4 // 过期时间以毫秒为单位
+};
+
+static const size_t WAL_RECORD_HEADER_SIZE = 8;
+
+// 编码单条修改（不含记录头）
+template<typename K, typename V>
+inline void wal_encode_put_entry(std::string& out, const K& key, const V& value, int64_t expire_time) {
+    out.push_back(static_cast<char>(WAL_PUT_MS));
+    size_t lengths = out.size();
+    out.append(16, '\0');
+    SnapshotCodec<K>::encode(key, out);
+    size_t value_start = out.size();
+    SnapshotCodec<V>::encode(value, out);
+    uint32_t key_len = static_cast<uint32_t>(value_start - lengths - 16);
+    uint32_t value_len = static_cast<uint32_t>(out.size() - value_start);
+    memcpy(&out[lengths], &key_len, 4);
+    memcpy(&out[lengths + 4], &value_len, 4);
+    memcpy(&out[lengths + 8], &expire_time, 8);
+}
+
+template<typename K>
+inline void wal_encode_delete_entry(std::string& out, const K& key) {
+    out.push_back(static_cast<char>(WAL_DELETE));
+    size_t length = out.size();
+    out.append(4, '\0');
+    SnapshotCodec<K>::encode(key, out);
+    uint32_t key_len = static_cast<uint32_t>(out.size() - length - 4);
+    memcpy(&out[length], &key_len, 4);
+}
+
+// 给 out 中从 start 开始的 payload 补上记录头
+inline void wal_seal_record(std::string& out, size_t start) {
+    uint32_t len = static_cast<uint32_t>(out.size() - start - WAL_RECORD_HEADER_SIZE);
+    uint32_t crc = snapshot_crc32c(out.data() + start + WAL_RECORD_HEADER_SIZE, len);
+    memcpy(&out[start], &len, 4);
+    memcpy(&out[start + 4], &crc, 4);
+}
+
+template<typename K, typename V>
+inline void wal_encode_put(std::string& out, const K& key, const V& value, int64_t expire_time = 0) {
+    size_t start = out.size();
+    out.append(WAL_RECORD_HEADER_SIZE, '\0');
+    wal_encode_put_entry(out, key, value, expire_time);
+    wal_seal_record(out, start);
+}
+
+template<typename K>
+inline void wal_encode_delete(std::string& out, const K& key) {
+    size_t start = out.size();
+    out.append(WAL_RECORD_HEADER_SIZE, '\0');
+    wal_encode_delete_entry(out, key);
+    wal_seal_record(out, start);
+}
+
+// 整批写成一条记录，重放时要么全部生效要么整条丢弃
+template<typename K, typename V>
+inline void wal_encode_batch(std::string& out, const WriteBatch<K, V>& batch) {
+    size_t start = out.size();
+    out.append(WAL_RECORD_HEADER_SIZE, '\0');
+    out.push_back(static_cast<char>(WAL_BATCH));
+    snapshot_put<uint32_t>(out, static_cast<uint32_t>(batch.size()));
+    for (const typename WriteBatch<K, V>::Op& op : batch.ops()) {
+        if (op.is_delete) {
+            wal_encode_delete_entry(out, op.key);
+        } else {
+            wal_encode_put_entry(out, op.key, op.value, op.expire_time);
+        }
+    }
+    wal_seal_record(out, start);
+}
+
+// 解码一个 PUT/DELETE 条目，成功时 p 前进到条目之后
+template<typename K, typename V>
+inline bool wal_decode_entry(const char*& p, const char* end, typename WriteBatch<K, V>::Op& op) {
+    if (p == end) {
+        return false;
+    }
+    int type = static_cast<unsigned char>(*p++);
+    if (type == WAL_PUT_MS || type == WAL_PUT) {
+        if (end - p < 16) {
+            return false;
+        }
+        uint32_t key_len = snapshot_get<uint32_t>(p);
+        uint32_t value_len = snapshot_get<uint32_t>(p + 4);
+        op.expire_time = snapshot_get<int64_t>(p + 8);
+        if (type == WAL_PUT && op.expire_time > 0) {
+            op.expire_time *= 1000;
+        }
+        p += 16;
+        if ((uint64_t)(end - p) < (uint64_t)key_len + value_len ||
+            !SnapshotCodec<K>::decode(p, key_len, op.key) ||
+            !SnapshotCodec<V>::decode(p + key_len, value_len, op.value)) {
+            return false;
+        }
+        op.is_delete = false;
+        p += key_len + value_len;
+        return true;
+    }
+    if (type == WAL_DELETE) {
+        if (end - p < 4) {
+            return false;
+        }
+        uint32_t key_len = snapshot_get<uint32_t>(p);
+        p += 4;
+        if ((uint64_t)(end - p) < key_len || !SnapshotCodec<K>::decode(p, key_len, op.key)) {
+            return false;
+        }
+        op.is_delete = true;
+        op.expire_time = 0;
+        p += key_len;
+        return true;
+    }
+    return false;
+}
+
+// 读出 path 中所有完整的记录，按日志顺序把每条修改加入 out（写入批量保持原有顺序）。
+// 末尾不完整或校验失败的部分被截掉，之后的追加接在最后一条完整记录后面。
+// 文件不存在时返回 true；返回完整记录的条数写入 records
+template<typename K, typename V>
+inline bool wal_replay(const std::string& path, WriteBatch<K, V>& out, size_t* records, std::string* error) {
+    *records = 0;
+    int fd = ::open(path.c_str(), O_RDWR);
+    if (fd < 0) {
+        if (errno == ENOENT) {
+            return true;
+        }
+        *error = "open " + path + ": " + strerror(errno);
+        return false;
+    }
+    std::string data;
+    char buf[1 << 16];
+    ssize_t n;
+    while ((n = ::read(fd, buf, sizeof(buf))) != 0) {
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            *error = "read " + path + ": " + strerror(errno);
+            ::close(fd);
+            return false;
+        }
+        data.append(buf, n);
+    }
+
+    const char* begin = data.data();
+    const char* end = begin + data.size();
+    const char* p = begin;
+    std::vector<typename WriteBatch<K, V>::Op> entries;
+    while ((size_t)(end - p) >= WAL_RECORD_HEADER_SIZE) {
+        uint32_t len = snapshot_get<uint32_t>(p);
+        uint32_t crc = snapshot_get<uint32_t>(p + 4);
+        const char* payload = p + WAL_RECORD_HEADER_SIZE;
+        if ((size_t)(end - payload) < len || snapshot_crc32c(payload, len) != crc) {
+            break;
+        }
+        const char* q = payload;
+        const char* payload_end = payload + len;
+        entries.clear();
+        bool ok = true;
+        if (len > 0 && static_cast<unsigned char>(*q) == WAL_BATCH) {
+            q++;
+            uint32_t count = payload_end - q >= 4 ? snapshot_get<uint32_t>(q) : 0;
+            q += 4;
+            entries.resize(count);
+            for (uint32_t i = 0; ok && i < count; i++) {
+                ok = wal_decode_entry<K, V>(q, payload_end, entries[i]);
+            }
+        } else {
+            entries.resize(1);
+            ok = wal_decode_entry<K, V>(q, payload_end, entries[0]);
+        }
+        if (!ok || q != payload_end) {
+            break;
+        }
+        for (size_t i = 0; i < entries.size(); i++) {
+            if (entries[i].is_delete) {
+                out.remove(entries[i].key);
+            } else {
+                out.put(entries[i].key, entries[i].value, entries[i].expire_time);
+            }
+        }
+        (*records)++;
+        p = payload_end;
+    }
+
+    if (p != end && ftruncate(fd, p - begin) != 0) {
+        *error = "truncate " + path + ": " + strerror(errno);
+        ::close(fd);
+        return false;
+    }
+    ::close(fd);
+    return true;
+}
+
+class WriteAheadLog {
+public:
+    WriteAheadLog();
+
+    ~WriteAheadLog();
+
+    void set_io_options(const IoOptions& options) { _io = options; } // 在 open 之前调用，只使用其中的 backend
+
+    bool open(const std::string& path, WalSyncPolicy policy, int interval_ms); // 以追加方式打开，按策略启动刷盘线程
+
+    void close(); // 写出缓冲区中剩余的记录，fdatasync 后关闭
+
+    bool is_open() const { return _fd >= 0; }
+
+    // 把一条已编码的记录放入缓冲区，返回它的序号；调用方持有跳表锁，保证日志顺序与修改顺序一致
+    uint64_t append(const std::string& record);
+
+    // 等待序号 seq 之前的记录全部写出（ALWAYS 时还要 fdatasync），不能持有跳表锁调用。失败时返回 false
+    bool commit(uint64_t seq);
+
+    // 快照已包含所有修改后清空日志（连同 path.old），调用方持有跳表锁
+    bool reset();
+
+    // 后台快照开始时调用，调用方持有跳表锁：已有的记录都移到 path.old，之后的记录写入新的空日志
+    bool rotate();
+
+    // 后台快照成功后删除 path.old
+    void drop_rotated();
+
+    static std::string rotated_path(const std::string& path) { return path + ".old"; }
+
+    const std::string& error() const { return _error; }
+
+    // group commit 的效果：记录数 / write 次数即平均每次写入合并的记录数
+    uint64_t record_count() const { return _records; }
+    uint64_t write_count() const { return _writes; }
+    uint64_t sync_count() const { return _syncs; }
+
+    IoBackend backend() const; // 实际使用的 I/O 后端
+
+private:
+    bool write_all(const std::string& data, bool sync = false); // 写出 data，sync 时再 fdatasync
+
+    void wait_idle(std::unique_lock<std::mutex>& lock); // 等待 leader 和刷盘线程都不在使用 _fd
+
+    void sync_loop(); // WAL_SYNC_INTERVAL 时的后台刷盘线程
+
+    std::mutex _mtx;
+    std::condition_variable _cv; // 等待 leader 写完
+    std::condition_variable _sync_cv; // 唤醒刷盘线程退出
+    int _fd;
+    std::string _path;
+    WalSyncPolicy _policy;
+    int _interval_ms;
+    std::string _pending; // 还没写出的记录
+    std::string _writing; // leader 正在写的记录，和 _pending 交换使用，避免反复分配
+    uint64_t _last_seq; // 最后一条已放入缓冲区的记录序号
+    uint64_t _written_seq; // 已写出的最大序号
+    bool _leader_active; // 是否有线程正在写
+    bool _syncing; // 刷盘线程是否正在 fdatasync
+    bool _dirty; // 上次 fdatasync 之后是否写过
+    bool _failed;
+    bool _stop;
+    std::thread _sync_thread;
+    uint64_t _records;
+    uint64_t _writes;
+    uint64_t _syncs;
+    std::string _error;
+    IoOptions _io;
+#if SKIPLIST_HAVE_IO_URING
+    IoRing _ring; // 只有 leader（或 wait_idle 之后的 close/rotate）使用
+#endif
+};
+
+inline WriteAheadLog::WriteAheadLog()
+    : _fd(-1), _policy(WAL_SYNC_INTERVAL), _interval_ms(1000), _last_seq(0), _written_seq(0),
+      _leader_active(false), _syncing(false), _dirty(false), _failed(false), _stop(false), _records(0), _writes(0), _syncs(0) {}
+
+inline WriteAheadLog::~WriteAheadLog() {
+    close();
+}
+
+inline bool WriteAheadLog::open(const std::string& path, WalSyncPolicy policy, int interval_ms) {
+    close();
+    _fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_APPEND, 0644);
+    if (_fd < 0) {
+        _error = "open " + path + ": " + strerror(errno);
+        return false;
+    }
+    _path = path;
+#if SKIPLIST_HAVE_IO_URING
+    std::string error;
+    if (io_resolve_backend(_io.backend, false) == IO_BACKEND_URING && !_ring.init(4, &error)) {
+        _ring.close(); // 创建失败时用 write/fdatasync
+    }
+#endif
+    _policy = policy;
+    _interval_ms = interval_ms > 0 ? interval_ms : 1;
+    _failed = false;
+    _stop = false;
+    if (_policy == WAL_SYNC_INTERVAL) {
+        _sync_thread = std::thread(&WriteAheadLog::sync_loop, this);
+    }
+    return true;
+}
+
+inline void WriteAheadLog::close() {
+    if (_fd < 0) {
+        return;
+    }
+    {
+        std::unique_lock<std::mutex> lock(_mtx);
+        _stop = true;
+        wait_idle(lock);
+        if (!_pending.empty() && write_all(_pending)) {
+            _pending.clear();
+            _written_seq = _last_seq;
+        }
+        _cv.notify_all();
+    }
+    _sync_cv.notify_all();
+    if (_sync_thread.joinable()) {
+        _sync_thread.join();
+    }
+    if (_policy != WAL_SYNC_NEVER) {
+        fdatasync(_fd);
+    }
+    ::close(_fd);
+    _fd = -1;
+#if SKIPLIST_HAVE_IO_URING
+    _ring.close();
+#endif
+}
+
+inline IoBackend WriteAheadLog::backend() const {
+#if SKIPLIST_HAVE_IO_URING
+    if (_ring.is_open()) {
+        return IO_BACKEND_URING;
+    }
+#endif
+    return IO_BACKEND_PWRITE;
+}
+
+inline uint64_t WriteAheadLog::append(const std::string& record) {
+    std::lock_guard<std::mutex> lock(_mtx);
+    _pending.append(record);
+    _records++;
+    return ++_last_seq;
+}
+
+inline bool WriteAheadLog::commit(uint64_t seq) {
+    std::unique_lock<std::mutex> lock(_mtx);
+    while (_written_seq < seq) {
+        if (_leader_active) {
+            _cv.wait(lock);
+            continue;
+        }
+        // 成为 leader：把缓冲区里所有人的记录一起写出
+        _leader_active = true;
+        _writing.swap(_pending);
+        uint64_t upto = _last_seq;
+        lock.unlock();
+
+        bool ok = write_all(_writing, _policy == WAL_SYNC_ALWAYS);
+        _writing.clear();
+
+        lock.lock();
+        _writes++;
+        if (_policy == WAL_SYNC_ALWAYS) {
+            _syncs++;
+        }
+        _dirty = true;
+        _failed = _failed || !ok;
+        _written_seq = upto;
+        _leader_active = false;
+        _cv.notify_all();
+    }
+    return !_failed;
+}
+
+inline bool WriteAheadLog::reset() {
+    std::unique_lock<std::mutex> lock(_mtx);
+    wait_idle(lock);
+    // 缓冲区里的修改都已在快照中，不必再写
+    _pending.clear();
+    _written_seq = _last_seq;
+    _cv.notify_all();
+    if (ftruncate(_fd, 0) != 0) {
+        _error = "truncate " + _path + ": " + strerror(errno);
+        return false;
+    }
+    ::unlink(rotated_path(_path).c_str());
+    return true;
+}
+
+inline bool WriteAheadLog::rotate() {
+    std::unique_lock<std::mutex> lock(_mtx);
+    wait_idle(lock);
+    // 缓冲区里的记录属于旧日志，子进程失败时还要靠它们恢复
+    bool ok = write_all(_pending);
+    _pending.clear();
+    _written_seq = _last_seq;
+    _failed = _failed || !ok;
+    _cv.notify_all();
+    if (ok && _policy != WAL_SYNC_NEVER && fdatasync(_fd) != 0) {
+        _error = "fdatasync " + _path + ": " + strerror(errno);
+        ok = false;
+    }
+    if (!ok) {
+        return false;
+    }
+
+    std::string old_path = rotated_path(_path);
+    if (::access(old_path.c_str(), F_OK) != 0) {
+        // 通常情况：直接改名，再新建一个空日志
+        if (::rename(_path.c_str(), old_path.c_str()) != 0) {
+            _error = "rename " + _path + ": " + strerror(errno);
+            return false;
+        }
+        int fd = ::open(_path.c_str(), O_WRONLY | O_CREAT | O_APPEND, 0644);
+        if (fd < 0) {
+            _error = "open " + _path + ": " + strerror(errno);
+            return false;
+        }
+        ::close(_fd);
+        _fd = fd;
+        return true;
+    }
+
+    // 上一次后台快照失败，path.old 还在：把当前日志接到它后面再清空
+    int in = ::open(_path.c_str(), O_RDONLY);
+    int out = ::open(old_path.c_str(), O_WRONLY | O_APPEND);
+    ok = in >= 0 && out >= 0;
+    char buf[1 << 16];
+    ssize_t n;
+    while (ok && (n = ::read(in, buf, sizeof(buf))) != 0) {
+        if (n < 0) {
+            ok = errno == EINTR;
+            continue;
+        }
+        for (ssize_t done = 0; ok && done < n; ) {
+            ssize_t w = ::write(out, buf + done, n - done);
+            ok = w >= 0 || errno == EINTR;
+            done += w > 0 ? w : 0;
+        }
+    }
+    if (ok && _policy != WAL_SYNC_NEVER) {
+        ok = fdatasync(out) == 0;
+    }
+    if (!ok) {
+        _error = "append to " + old_path + ": " + strerror(errno);
+    }
+    if (in >= 0) {
+        ::close(in);
+    }
+    if (out >= 0) {
+        ::close(out);
+    }
+    if (ok && ftruncate(_fd, 0) != 0) {
+        _error = "truncate " + _path + ": " + strerror(errno);
+        ok = false;
+    }
+    return ok;
+}
+
+inline void WriteAheadLog::drop_rotated() {
+    std::lock_guard<std::mutex> lock(_mtx);
+    ::unlink(rotated_path(_path).c_str());
+}
+
+inline void WriteAheadLog::wait_idle(std::unique_lock<std::mutex>& lock) {
+    while (_leader_active || _syncing) {
+        _cv.wait(lock);
+    }
+}
+
+inline bool WriteAheadLog::write_all(const std::string& data, bool sync) {
+    const char* p = data.data();
+    size_t len = data.size();
+#if SKIPLIST_HAVE_IO_URING
+    if (_ring.is_open()) {
+        // fdatasync 链接在 write 之后（IOSQE_IO_LINK），write 成功才执行；短写会取消 fdatasync，补写剩余部分后重新提交
+        while (len > 0 || sync) {
+            unsigned count = 0;
+            if (len > 0) {
+                io_uring_sqe* sqe = _ring.next_sqe();
+                sqe->opcode = IORING_OP_WRITE;
+                sqe->fd = _fd;
+                sqe->addr = reinterpret_cast<uint64_t>(p);
+                sqe->len = static_cast<uint32_t>(len < (1u << 30) ? len : (1u << 30));
+                sqe->off = static_cast<uint64_t>(-1); // 当前位置，文件以 O_APPEND 打开
+                sqe->flags = sync ? IOSQE_IO_LINK : 0;
+                sqe->user_data = 0;
+                count++;
+            }
+            if (sync) {
+                io_uring_sqe* sqe = _ring.next_sqe();
+                sqe->opcode = IORING_OP_FSYNC;
+                sqe->fd = _fd;
+                sqe->fsync_flags = IORING_FSYNC_DATASYNC;
+                sqe->user_data = 1;
+                count++;
+            }
+            int result = _ring.enter(count);
+            if (result < 0) {
+                _error = "io_uring_enter " + _path + ": " + strerror(-result);
+                return false;
+            }
+            // 本次提交的完成事件全部取完再返回，否则留在完成队列里的会被下一次调用当成自己的结果
+            bool ok = true;
+            for (unsigned i = 0; i < count; i++) {
+                uint64_t user_data;
+                int32_t n;
+                while (!_ring.reap(user_data, n)) {
+                    result = _ring.enter(1);
+                    if (result < 0) {
+                        // 剩下的完成事件取不回来，关闭队列，之后改用 write/fdatasync
+                        _error = "io_uring_enter " + _path + ": " + strerror(-result);
+                        _ring.close();
+                        return false;
+                    }
+                }
+                if (user_data == 0 && n < 0) {
+                    _error = "write " + _path + ": " + strerror(-n);
+                    ok = false;
+                } else if (user_data == 0) {
+                    p += n;
+                    len -= n;
+                } else if (n == 0) {
+                    sync = false;
+                } else if (n != -ECANCELED) {
+                    _error = "fdatasync " + _path + ": " + strerror(-n);
+                    ok = false;
+                }
+            }
+            if (!ok) {
+                return false;
+            }
+        }
+        return true;
+    }
+#endif
+    while (len > 0) {
+        ssize_t n = ::write(_fd, p, len);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            _error = "write " + _path + ": " + strerror(errno);
+            return false;
+        }
+        p += n;
+        len -= n;
+    }
+    if (sync && fdatasync(_fd) != 0) {
+        _error = "fdatasync " + _path + ": " + strerror(errno);
+        return false;
+    }
+    return true;
+}
+
+inline void WriteAheadLog::sync_loop() {
+    std::unique_lock<std::mutex> lock(_mtx);
+    while (!_stop) {
+        _sync_cv.wait_for(lock, std::chrono::milliseconds(_interval_ms));
+        if (!_dirty) {
+            continue;
+        }
+        _dirty = false;
+        _syncing = true;
+        lock.unlock();
+        fdatasync(_fd);
+        lock.lock();
+        _syncing = false;
+        _syncs++;
+        _cv.notify_all();
+    }
+}
+
+#endif
@@ -0,0 +1,54 @@
+#ifndef WRITE_BATCH_H
+#define WRITE_BATCH_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <algorithm>
+
+// 一批写操作（插入/覆盖和删除），由 SkipList::write 在一次加锁内按键序整体应用，
+// 其他线程要么看到整批结果，要么一条都看不到。
+// 与 insert_element 不同，批量里的 put 会覆盖已存在键的值；同一个键出现多次时按加入顺序生效，最后一次为准。
+template<typename K, typename V>
+class WriteBatch {
+public:
+    struct Op {
+        K key;
+        V value;
+        int64_t expire_time; // 过期时间（Unix 毫秒），0 表示永不过期；没有过期功能的跳表忽略该字段
+        bool is_delete;
+    };
+
+    void put(const K& key, const V& value, int64_t expire_time = 0) {
+        _ops.push_back(Op{key, value, expire_time, false});
+    }
+
+    void remove(const K& key) {
+        _ops.push_back(Op{key, V(), 0, true});
+    }
+
+    void clear() { _ops.clear(); }
+
+    size_t size() const { return _ops.size(); }
+
+    bool empty() const { return _ops.empty(); }
+
+    const std::vector<Op>& ops() const { return _ops; }
+
+    // 按键排序后的下标，键相同的操作保持加入顺序
+    std::vector<size_t> sorted_order() const {
+        std::vector<size_t> order(_ops.size());
+        for (size_t i = 0; i < order.size(); i++) {
+            order[i] = i;
+        }
+        std::stable_sort(order.begin(), order.end(), [this](size_t a, size_t b) {
+            return _ops[a].key < _ops[b].key;
+        });
+        return order;
+    }
+
+private:
+    std::vector<Op> _ops;
+};
+
+#endif
@@ -0,0 +1,3 @@
+make ycsb_bench
+# 三个引擎依次运行同一组参数，例如 sh ycsb_start.sh --threads=4 --records=1000000 > ycsb.csv
+./bin/ycsb_skiplist "$@" && ./bin/ycsb_lru --no-header "$@" && ./bin/ycsb_timer --no-header "$@"